@@ -0,0 +1,282 @@
+#include "block_cache.h"
+#include <unordered_map>
+#include <vector>
+#include "config.h"
+#include "littlefs_manager.h"
+#include "script_manifest.h"
+
+#define BLOCK_INDEX_BITS 20  // Block key: file slot << 20 | block index
+
+struct CacheFileEntry {
+  String path;
+  uint32_t size;
+  uint32_t generation;  // Bumped when the entry is dropped or reused
+  uint32_t lastUsed;
+  bool pinned;
+  bool used;
+};
+
+struct CacheBlock {
+  int16_t file;  // Slot in files[], -1 = free
+  uint16_t length;
+  uint32_t index;
+  uint32_t lastUsed;
+};
+
+static uint8_t* pool = nullptr;
+static std::vector<CacheBlock> blocks;
+static std::unordered_map<uint32_t, uint16_t> blockMap;
+static CacheFileEntry files[BLOCK_CACHE_FILES];
+static SemaphoreHandle_t cacheLock = nullptr;
+static uint32_t useClock = 0;
+static BlockCacheStats stats = { 0, 0, 0, 0, 0, 0, 0 };
+
+static bool lockCache() {
+  return pool && xSemaphoreTake(cacheLock, portMAX_DELAY) == pdTRUE;
+}
+
+static void unlockCache() {
+  xSemaphoreGive(cacheLock);
+}
+
+static bool pinnedPath(const String& path) {
+  return path.startsWith("/www/") || path == "/logo.bmp";
+}
+
+// Files only ever changed through uploads, deletes and the script
+// manifest, all of which invalidate
+static bool cacheablePath(const String& path) {
+  if (path.startsWith("/www/")) return true;
+  if (path.startsWith(SCRIPTS_DIR "/")) {
+    return path != SCRIPT_MANIFEST_FILE && !path.endsWith(".tmp");
+  }
+  static const char* assets[] = { ".html", ".css", ".js", ".png", ".jpg", ".ico", ".bmp", ".svg", ".gz" };
+  for (const char* ext : assets) {
+    if (path.endsWith(ext)) return true;
+  }
+  return false;
+}
+
+static uint32_t blockKey(int slot, uint32_t index) {
+  return ((uint32_t)slot << BLOCK_INDEX_BITS) | index;
+}
+
+static void freeBlock(size_t b) {
+  CacheBlock& block = blocks[b];
+  blockMap.erase(blockKey(block.file, block.index));
+  stats.cachedBytes -= block.length;
+  block.file = -1;
+  block.length = 0;
+}
+
+static void dropFile(int slot) {
+  for (size_t b = 0; b < blocks.size(); b++) {
+    if (blocks[b].file == slot) freeBlock(b);
+  }
+  if (files[slot].pinned) stats.pinnedBytes -= files[slot].size;
+  files[slot].used = false;
+  files[slot].path = "";
+  files[slot].generation++;
+  stats.files--;
+}
+
+static int findFile(const String& path) {
+  for (int i = 0; i < BLOCK_CACHE_FILES; i++) {
+    if (files[i].used && files[i].path == path) return i;
+  }
+  return -1;
+}
+
+// Free slot, or the least recently used unpinned one; -1 if all are pinned
+static int addFile(const String& path, size_t size) {
+  int slot = -1;
+  for (int i = 0; i < BLOCK_CACHE_FILES; i++) {
+    if (!files[i].used) {
+      slot = i;
+      break;
+    }
+    if (!files[i].pinned && (slot < 0 || files[i].lastUsed < files[slot].lastUsed)) slot = i;
+  }
+  if (slot < 0) return -1;
+  if (files[slot].used) dropFile(slot);
+
+  CacheFileEntry& entry = files[slot];
+  entry.path = path;
+  entry.size = size;
+  entry.lastUsed = ++useClock;
+  entry.pinned = pinnedPath(path) && stats.pinnedBytes + size <= BLOCK_CACHE_PIN_MAX_BYTES;
+  entry.used = true;
+  entry.generation++;
+  if (entry.pinned) stats.pinnedBytes += size;
+  stats.files++;
+  return slot;
+}
+
+// Free block, or the least recently used one of an unpinned file
+static int allocBlock() {
+  int victim = -1;
+  for (size_t b = 0; b < blocks.size(); b++) {
+    if (blocks[b].file < 0) return b;
+    if (files[blocks[b].file].pinned) continue;
+    if (victim < 0 || blocks[b].lastUsed < blocks[victim].lastUsed) victim = b;
+  }
+  if (victim >= 0) {
+    freeBlock(victim);
+    stats.evictions++;
+  }
+  return victim;
+}
+
+void setupBlockCache() {
+  if (BLOCK_CACHE_BYTES == 0 || !psramFound()) {
+    Serial.println("Block cache: disabled (no PSRAM)");
+    return;
+  }
+
+  size_t count = BLOCK_CACHE_BYTES / BLOCK_CACHE_BLOCK_SIZE;
+  cacheLock = xSemaphoreCreateMutex();
+  pool = (uint8_t*)ps_malloc(count * BLOCK_CACHE_BLOCK_SIZE);
+  if (!pool || !cacheLock) {
+    free(pool);
+    pool = nullptr;
+    Serial.println("Block cache: out of memory");
+    return;
+  }
+
+  blocks.assign(count, { -1, 0, 0, 0 });
+  blockMap.reserve(count);
+  stats.capacity = count * BLOCK_CACHE_BLOCK_SIZE;
+  Serial.println("Block cache: " + String(stats.capacity / 1024) + " KB in PSRAM");
+}
+
+void invalidateBlockCache(const String& path) {
+  if (!lockCache()) return;
+  String dirPrefix = path.endsWith("/") ? path : path + "/";
+  for (int i = 0; i < BLOCK_CACHE_FILES; i++) {
+    if (files[i].used && (files[i].path == path || files[i].path.startsWith(dirPrefix))) dropFile(i);
+  }
+  unlockCache();
+}
+
+BlockCacheStats getBlockCacheStats() {
+  if (!lockCache()) return stats;
+  BlockCacheStats copy = stats;
+  unlockCache();
+  return copy;
+}
+
+CachedFile::CachedFile(const String& path)
+  : _path(path), _slot(-1), _generation(0), _size(0), _pos(0), _found(false) {
+  if (!storageAvailable || !storageFS) return;
+
+  bool cacheable = cacheablePath(path);
+  if (cacheable && lockCache()) {
+    int slot = findFile(path);
+    if (slot >= 0) {
+      files[slot].lastUsed = ++useClock;
+      _slot = slot;
+      _generation = files[slot].generation;
+      _size = files[slot].size;
+      _found = true;
+    }
+    unlockCache();
+    if (_found) return;
+  }
+
+  if (!openFile()) return;
+  _size = _file.size();
+  _found = true;
+
+  if (cacheable && lockCache()) {
+    _slot = addFile(path, _size);
+    if (_slot >= 0) _generation = files[_slot].generation;
+    unlockCache();
+  }
+}
+
+CachedFile::~CachedFile() {
+  if (_file) _file.close();
+}
+
+bool CachedFile::openFile() {
+  if (_file) return true;
+  if (!storageFS->exists(_path)) return false;
+  _file = storageFS->open(_path, "r");
+  if (_file && _file.isDirectory()) _file.close();
+  return _file;
+}
+
+bool CachedFile::seek(size_t pos) {
+  if (pos > _size) return false;
+  _pos = pos;
+  return true;
+}
+
+int CachedFile::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t CachedFile::read(uint8_t* dst, size_t len) {
+  size_t total = 0;
+  while (total < len && _pos < _size) {
+    uint32_t index = _pos / BLOCK_CACHE_BLOCK_SIZE;
+    size_t offset = _pos % BLOCK_CACHE_BLOCK_SIZE;
+    size_t want = min(len - total, min((size_t)BLOCK_CACHE_BLOCK_SIZE - offset, _size - _pos));
+    size_t n = readBlock(index, offset, dst + total, want);
+    if (n == 0) break;
+    total += n;
+    _pos += n;
+  }
+  return total;
+}
+
+// Copies part of one block, loading the block into the cache on a miss.
+// The storage read happens under the lock so an invalidation can't land
+// between reading a block and publishing it.
+size_t CachedFile::readBlock(uint32_t index, size_t offset, uint8_t* dst, size_t len) {
+  if (_slot >= 0 && index < (1u << BLOCK_INDEX_BITS) && lockCache()) {
+    CacheFileEntry& entry = files[_slot];
+    if (!entry.used || entry.generation != _generation) {
+      // Invalidated while open; finish reading from storage
+      _slot = -1;
+      unlockCache();
+    } else {
+      entry.lastUsed = ++useClock;
+      auto it = blockMap.find(blockKey(_slot, index));
+      int b = -1;
+      if (it != blockMap.end()) {
+        b = it->second;
+        stats.hits++;
+      } else {
+        stats.misses++;
+        b = allocBlock();
+        size_t got = 0;
+        if (b >= 0 && openFile() && _file.seek(index * BLOCK_CACHE_BLOCK_SIZE)) {
+          got = _file.read(pool + b * BLOCK_CACHE_BLOCK_SIZE, BLOCK_CACHE_BLOCK_SIZE);
+        }
+        if (got > 0) {
+          blocks[b] = { (int16_t)_slot, (uint16_t)got, index, 0 };
+          blockMap[blockKey(_slot, index)] = b;
+          stats.cachedBytes += got;
+        } else {
+          b = -1;
+        }
+      }
+
+      size_t n = 0;
+      if (b >= 0) {
+        blocks[b].lastUsed = useClock;
+        if (offset < blocks[b].length) {
+          n = min(len, (size_t)blocks[b].length - offset);
+          memcpy(dst, pool + b * BLOCK_CACHE_BLOCK_SIZE + offset, n);
+        }
+      }
+      unlockCache();
+      if (b >= 0) return n;
+    }
+  }
+
+  if (!openFile() || !_file.seek(index * BLOCK_CACHE_BLOCK_SIZE + offset)) return 0;
+  return _file.read(dst, len);
+}
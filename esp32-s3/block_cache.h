@@ -0,0 +1,68 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// LRU cache of file blocks in PSRAM, in front of storageFS. The web UI,
+// the logo and saved scripts are read through CachedFile, so once a file
+// has been read its size and contents come from PSRAM and the card is not
+// touched again. Writes go to storage as before (write-through); writers
+// call invalidateBlockCache() so no stale block is ever served.
+//
+// Only files the firmware itself never rewrites behind the cache's back
+// are cached: /www/*, saved scripts and static assets (.html, .css, .js,
+// images). Config files and everything else pass straight through.
+// Files in /www/ and the logo are pinned and never evicted, up to
+// BLOCK_CACHE_PIN_MAX_BYTES.
+
+struct BlockCacheStats {
+  size_t capacity;     // Bytes of PSRAM held, 0 = cache disabled
+  size_t cachedBytes;
+  size_t pinnedBytes;
+  size_t files;
+  uint32_t hits;       // Block reads served from PSRAM
+  uint32_t misses;     // Block reads that went to storage
+  uint32_t evictions;
+};
+
+// Allocates the cache; does nothing without PSRAM
+void setupBlockCache();
+
+// Drops everything cached for path, and for files below it if it is a
+// directory. Call after a file is written, replaced or removed.
+void invalidateBlockCache(const String& path);
+
+BlockCacheStats getBlockCacheStats();
+
+// Read-only file served from the cache. Opens the real file only for
+// blocks (or the size) the cache doesn't have yet.
+class CachedFile {
+public:
+  explicit CachedFile(const String& path);
+  ~CachedFile();
+
+  operator bool() const { return _found; }
+  size_t size() const { return _size; }
+  size_t position() const { return _pos; }
+  bool available() const { return _pos < _size; }
+  bool seek(size_t pos);
+
+  // Next byte, or -1 at end of file
+  int read();
+  size_t read(uint8_t* dst, size_t len);
+
+private:
+  bool openFile();
+  size_t readBlock(uint32_t index, size_t offset, uint8_t* dst, size_t len);
+
+  String _path;
+  fs::File _file;  // Opened on a cache miss only
+  int _slot;       // File entry in the cache, -1 = not cached
+  uint32_t _generation;
+  size_t _size;
+  size_t _pos;
+  bool _found;
+};
+
+#endif //BLOCK_CACHE_H
@@ -0,0 +1,346 @@
+#include "chunked_upload.h"
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include "config.h"
+#include "littlefs_manager.h"
+#include "upload_writer.h"
+#include "utils.h"
+
+#define MAP_MAGIC 0x31505543  // "CUP1"
+
+static ChunkedUpload uploads[MAX_CHUNKED_UPLOADS];
+
+// Chunk currently being received
+static ChunkedUpload* chunkSession = nullptr;
+static uint32_t chunkIndex = 0;
+static size_t chunkExpected = 0;
+static size_t chunkReceived = 0;
+static uint32_t chunkCrc = 0;
+static uint32_t chunkExpectedCrc = 0;
+static bool chunkFailed = false;
+static UploadWriter chunkWriter;
+
+static String partPath(const ChunkedUpload* session) {
+  return session->path + ".part";
+}
+
+static String mapPath(const ChunkedUpload* session) {
+  return session->path + ".part.map";
+}
+
+static size_t bitmapBytes(uint32_t chunks) {
+  return (chunks + 7) / 8;
+}
+
+static bool hasChunk(const ChunkedUpload* session, uint32_t index) {
+  return session->bitmap[index / 8] & (1 << (index % 8));
+}
+
+static void freeSession(ChunkedUpload* session) {
+  free(session->bitmap);
+  session->bitmap = nullptr;
+  session->active = false;
+  session->id = "";
+  session->path = "";
+}
+
+static bool saveMap(const ChunkedUpload* session) {
+  File map = storageFS->open(mapPath(session), "w");
+  if (!map) return false;
+  uint32_t header[3] = { MAP_MAGIC, (uint32_t)session->size, (uint32_t)session->chunkSize };
+  map.write((const uint8_t*)header, sizeof(header));
+  size_t len = bitmapBytes(session->chunks);
+  bool ok = map.write(session->bitmap, len) == len;
+  map.close();
+  return ok;
+}
+
+// Restores the bitmap left by an earlier (possibly pre-reboot) attempt
+static bool loadMap(ChunkedUpload* session) {
+  if (!storageFS->exists(mapPath(session)) || !storageFS->exists(partPath(session))) return false;
+
+  File map = storageFS->open(mapPath(session), "r");
+  if (!map) return false;
+  uint32_t header[3];
+  size_t len = bitmapBytes(session->chunks);
+  bool ok = map.read((uint8_t*)header, sizeof(header)) == sizeof(header) &&
+            header[0] == MAP_MAGIC && header[1] == session->size && header[2] == session->chunkSize &&
+            map.read(session->bitmap, len) == len;
+  map.close();
+  if (!ok) return false;
+
+  session->received = 0;
+  for (uint32_t i = 0; i < session->chunks; i++) {
+    if (hasChunk(session, i)) session->received++;
+  }
+  return true;
+}
+
+static String newSessionId() {
+  char id[17];
+  snprintf(id, sizeof(id), "%08lx%08lx", (unsigned long)esp_random(), (unsigned long)esp_random());
+  return String(id);
+}
+
+ChunkedUpload* openChunkedUpload(const String& path, size_t size, size_t chunkSize, String& error) {
+  if (!storageAvailable || !storageFS) {
+    error = "Storage not available";
+    return nullptr;
+  }
+  if (size == 0 || chunkSize < CHUNKED_MIN_CHUNK || chunkSize > CHUNKED_MAX_CHUNK) {
+    error = "Invalid size or chunk size";
+    return nullptr;
+  }
+
+  // Same file again: hand back the running session
+  for (int i = 0; i < MAX_CHUNKED_UPLOADS; i++) {
+    if (uploads[i].active && uploads[i].path == path) {
+      if (uploads[i].size == size && uploads[i].chunkSize == chunkSize) return &uploads[i];
+      cancelChunkedUpload(&uploads[i]);
+    }
+  }
+
+  ChunkedUpload* session = nullptr;
+  for (int i = 0; i < MAX_CHUNKED_UPLOADS; i++) {
+    if (!uploads[i].active) {
+      session = &uploads[i];
+      break;
+    }
+  }
+  if (!session) {
+    error = "Too many uploads in progress";
+    return nullptr;
+  }
+
+  session->path = path;
+  session->size = size;
+  session->chunkSize = chunkSize;
+  session->chunks = (size + chunkSize - 1) / chunkSize;
+  session->received = 0;
+  session->bitmap = (uint8_t*)calloc(bitmapBytes(session->chunks), 1);
+  if (!session->bitmap) {
+    error = "Out of memory";
+    return nullptr;
+  }
+
+  if (!loadMap(session)) {
+    memset(session->bitmap, 0, bitmapBytes(session->chunks));
+    if (!hasAvailableSpace(size)) {
+      free(session->bitmap);
+      session->bitmap = nullptr;
+      error = "Insufficient space";
+      return nullptr;
+    }
+    File part = storageFS->open(partPath(session), "w");
+    if (!part) {
+      free(session->bitmap);
+      session->bitmap = nullptr;
+      error = "Failed to create temp file";
+      return nullptr;
+    }
+    part.close();
+    saveMap(session);
+  } else {
+    Serial.println("Resuming upload: " + path + " (" + String(session->received) + "/" + String(session->chunks) + " chunks)");
+  }
+
+  session->id = newSessionId();
+  session->active = true;
+  return session;
+}
+
+ChunkedUpload* findChunkedUpload(const String& id) {
+  for (int i = 0; i < MAX_CHUNKED_UPLOADS; i++) {
+    if (uploads[i].active && uploads[i].id == id) return &uploads[i];
+  }
+  return nullptr;
+}
+
+bool beginChunk(ChunkedUpload* session, size_t offset, uint32_t crc, String& error) {
+  if (offset % session->chunkSize != 0 || offset >= session->size) {
+    error = "Offset must be a chunk boundary inside the file";
+    return false;
+  }
+
+  // "r+" keeps the existing contents and allows writing at any offset
+  File part = storageFS->open(partPath(session), "r+");
+  if (!part) {
+    error = "Temp file missing";
+    return false;
+  }
+  part.seek(offset);
+  if (!chunkWriter.begin(part)) {
+    part.close();
+    error = "Out of memory";
+    return false;
+  }
+
+  // A resent chunk is written over the accepted one. Until its CRC checks
+  // out the old data may be gone, so it counts as missing from here on.
+  chunkIndex = offset / session->chunkSize;
+  if (hasChunk(session, chunkIndex)) {
+    session->bitmap[chunkIndex / 8] &= ~(1 << (chunkIndex % 8));
+    session->received--;
+    saveMap(session);
+  }
+
+  chunkSession = session;
+  chunkExpected = min(session->chunkSize, session->size - offset);
+  chunkReceived = 0;
+  chunkCrc = 0;
+  chunkExpectedCrc = crc;
+  chunkFailed = false;
+  return true;
+}
+
+bool writeChunk(const uint8_t* data, size_t len) {
+  if (!chunkSession || chunkFailed) return false;
+
+  // Never write past the chunk; the next chunk may already be on disk
+  chunkReceived += len;
+  if (chunkReceived > chunkExpected) {
+    chunkFailed = true;
+    chunkWriter.abort();
+    return false;
+  }
+
+  chunkCrc = esp_rom_crc32_le(chunkCrc, data, len);
+  if (!chunkWriter.write(data, len)) {
+    chunkFailed = true;
+    chunkWriter.abort();
+    return false;
+  }
+  return true;
+}
+
+bool endChunk(String& error) {
+  if (!chunkSession) {
+    error = "No chunk in progress";
+    return false;
+  }
+
+  ChunkedUpload* session = chunkSession;
+  chunkSession = nullptr;
+
+  if (chunkFailed) {
+    error = chunkReceived > chunkExpected ? "Chunk too large" : "Write failed";
+    return false;
+  }
+  if (!chunkWriter.finish()) {
+    error = "Write failed";
+    return false;
+  }
+  if (chunkReceived != chunkExpected) {
+    error = "Chunk length mismatch";
+    return false;
+  }
+  // A bad chunk stays unmarked, so the client simply sends it again
+  if (chunkCrc != chunkExpectedCrc) {
+    error = "CRC mismatch";
+    return false;
+  }
+
+  if (!hasChunk(session, chunkIndex)) {
+    session->bitmap[chunkIndex / 8] |= 1 << (chunkIndex % 8);
+    session->received++;
+    saveMap(session);
+  }
+  return true;
+}
+
+void abortChunk() {
+  if (!chunkSession) return;
+  chunkWriter.abort();
+  chunkSession = nullptr;
+}
+
+String chunkedUploadStatusJson(ChunkedUpload* session) {
+  String json = "{";
+  json += "\"id\":\"" + session->id + "\",";
+  json += "\"path\":\"" + escapeJson(session->path) + "\",";
+  json += "\"size\":" + String(session->size) + ",";
+  json += "\"chunk_size\":" + String(session->chunkSize) + ",";
+  json += "\"chunks\":" + String(session->chunks) + ",";
+  json += "\"received\":" + String(session->received) + ",";
+
+  // Missing data as [start, end) byte ranges, adjacent chunks merged
+  json += "\"missing\":[";
+  bool first = true;
+  uint32_t i = 0;
+  while (i < session->chunks) {
+    if (hasChunk(session, i)) {
+      i++;
+      continue;
+    }
+    uint32_t start = i;
+    while (i < session->chunks && !hasChunk(session, i)) i++;
+    if (!first) json += ",";
+    first = false;
+    size_t end = min((size_t)i * session->chunkSize, session->size);
+    json += "[" + String(start * session->chunkSize) + "," + String(end) + "]";
+  }
+  json += "]}";
+  return json;
+}
+
+bool finalizeChunkedUpload(ChunkedUpload* session, uint32_t crc, String& error) {
+  if (session->received != session->chunks) {
+    error = "Missing chunks";
+    return false;
+  }
+
+  File part = storageFS->open(partPath(session), "r");
+  if (!part) {
+    error = "Temp file missing";
+    return false;
+  }
+
+  size_t blockSize = usingSD ? DOWNLOAD_CHUNK_SD : DOWNLOAD_CHUNK_LITTLEFS;
+  uint8_t* buffer = (uint8_t*)malloc(blockSize);
+  if (!buffer) {
+    part.close();
+    error = "Out of memory";
+    return false;
+  }
+
+  uint32_t fileCrc = 0;
+  size_t total = 0;
+  size_t n;
+  while (total < session->size && (n = part.read(buffer, min(blockSize, session->size - total))) > 0) {
+    fileCrc = esp_rom_crc32_le(fileCrc, buffer, n);
+    total += n;
+  }
+  free(buffer);
+  part.close();
+
+  if (total != session->size || fileCrc != crc) {
+    // Every chunk passed its own check, so the client's data is inconsistent;
+    // start over rather than keep a file we know is wrong
+    error = total != session->size ? "Temp file size mismatch" : "File CRC mismatch";
+    cancelChunkedUpload(session);
+    return false;
+  }
+
+  if (storageFS->exists(session->path)) {
+    accountFileChange(storedFileSize(session->path), 0);
+    storageFS->remove(session->path);
+  }
+  if (!storageFS->rename(partPath(session), session->path)) {
+    error = "Failed to move file into place";
+    return false;
+  }
+  storageFS->remove(mapPath(session));
+  // Chunks aren't counted as they arrive; the whole file is counted here
+  accountFileChange(0, session->size);
+
+  Serial.println("Chunked upload complete: " + session->path + " (" + String(session->size) + " bytes)");
+  freeSession(session);
+  return true;
+}
+
+void cancelChunkedUpload(ChunkedUpload* session) {
+  if (chunkSession == session) abortChunk();
+  storageFS->remove(partPath(session));
+  storageFS->remove(mapPath(session));
+  freeSession(session);
+}
@@ -0,0 +1,41 @@
+#ifndef CHUNKED_UPLOAD_H
+#define CHUNKED_UPLOAD_H
+
+#include <Arduino.h>
+
+// Resumable uploads: the file is sent as fixed-size chunks at known offsets,
+// each with its own CRC32. Data goes to "<path>.part" and a "<path>.part.map"
+// bitmap records which chunks arrived, so an interrupted upload (or a reboot)
+// only needs the missing chunks resent. finalize checks the whole-file CRC32
+// before the temp file is renamed into place.
+
+struct ChunkedUpload {
+  bool active;
+  String id;
+  String path;        // Final destination
+  size_t size;
+  size_t chunkSize;
+  uint32_t chunks;
+  uint32_t received;  // Number of chunks marked in the bitmap
+  uint8_t* bitmap;
+};
+
+// Opens a new session or resumes one for the same path and size
+ChunkedUpload* openChunkedUpload(const String& path, size_t size, size_t chunkSize, String& error);
+ChunkedUpload* findChunkedUpload(const String& id);
+
+// One chunk, fed from the multipart upload callback
+bool beginChunk(ChunkedUpload* session, size_t offset, uint32_t crc, String& error);
+bool writeChunk(const uint8_t* data, size_t len);
+bool endChunk(String& error);
+void abortChunk();
+
+// {"id","path","size","chunk_size","chunks","received","missing":[[start,end],...]}
+String chunkedUploadStatusJson(ChunkedUpload* session);
+
+// Verifies all chunks and the whole-file CRC32, then moves the file into place
+bool finalizeChunkedUpload(ChunkedUpload* session, uint32_t crc, String& error);
+// Drops the session and deletes its temp files
+void cancelChunkedUpload(ChunkedUpload* session);
+
+#endif //CHUNKED_UPLOAD_H
@@ -0,0 +1,278 @@
+#include "compressed_file.h"
+#include <esp_rom_crc.h>
+#include "config.h"
+#include "littlefs_manager.h"
+
+#define LZSS_MAGIC "LZS2"
+#define LZSS_HEADER_SIZE 16
+#define LZSS_MAGIC_V1 "LZS1"
+#define LZSS_HEADER_SIZE_V1 8
+#define LZSS_HASH_SIZE 1024
+#define LZSS_MAX_CHAIN 32
+
+bool compressionEnabled() {
+  return STORAGE_COMPRESSION && !usingSD;
+}
+
+static void put32(uint8_t* p, uint32_t value) {
+  for (int i = 0; i < 4; i++) p[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t hash3(const uint8_t* p) {
+  return ((p[0] << 6) ^ (p[1] << 3) ^ p[2]) & (LZSS_HASH_SIZE - 1);
+}
+
+void lzssCompress(const uint8_t* data, size_t len, std::vector<uint8_t>& out) {
+  // The packed size and checksum are filled in at the end
+  size_t headerIndex = out.size();
+  out.resize(headerIndex + LZSS_HEADER_SIZE);
+
+  // Hash chains over the window: head[h] is the latest position with that
+  // 3-byte hash, prev[] links back to older ones
+  std::vector<int32_t> head(LZSS_HASH_SIZE, -1);
+  std::vector<int32_t> prev(LZSS_WINDOW, -1);
+
+  size_t flagIndex = 0;
+  int flagBits = 8;
+  size_t pos = 0;
+
+  auto insert = [&](size_t p) {
+    if (p + LZSS_MIN_MATCH > len) return;
+    uint16_t h = hash3(data + p);
+    prev[p % LZSS_WINDOW] = head[h];
+    head[h] = p;
+  };
+
+  while (pos < len) {
+    if (flagBits == 8) {
+      flagIndex = out.size();
+      out.push_back(0);
+      flagBits = 0;
+    }
+
+    size_t bestLen = 0;
+    size_t bestDistance = 0;
+    if (pos + LZSS_MIN_MATCH <= len) {
+      size_t maxLen = min((size_t)LZSS_MAX_MATCH, len - pos);
+      int32_t candidate = head[hash3(data + pos)];
+      for (int chain = 0; candidate >= 0 && chain < LZSS_MAX_CHAIN; chain++) {
+        size_t distance = pos - candidate;
+        if (distance == 0 || distance > LZSS_WINDOW) break;
+        size_t n = 0;
+        while (n < maxLen && data[candidate + n] == data[pos + n]) n++;
+        if (n > bestLen) {
+          bestLen = n;
+          bestDistance = distance;
+          if (n == maxLen) break;
+        }
+        int32_t older = prev[candidate % LZSS_WINDOW];
+        if (older >= candidate) break;  // Slot was reused by a newer position
+        candidate = older;
+      }
+    }
+
+    if (bestLen >= LZSS_MIN_MATCH) {
+      uint16_t distance = bestDistance - 1;
+      out.push_back(distance & 0xFF);
+      out.push_back((distance >> 8) | ((bestLen - LZSS_MIN_MATCH) << 2));
+      for (size_t i = 0; i < bestLen; i++) insert(pos + i);
+      pos += bestLen;
+    } else {
+      out[flagIndex] |= 1 << flagBits;
+      out.push_back(data[pos]);
+      insert(pos);
+      pos++;
+    }
+    flagBits++;
+  }
+
+  uint8_t* header = out.data() + headerIndex;
+  memcpy(header, LZSS_MAGIC, 4);
+  put32(header + 4, len);
+  put32(header + 8, out.size() - headerIndex - LZSS_HEADER_SIZE);
+  put32(header + 12, esp_rom_crc32_le(0, header, 12));
+}
+
+LzssDecoder::LzssDecoder()
+  : _windowPos(0), _flags(0), _flagBits(0), _matchDistance(0), _matchLeft(0) {
+  _window = (uint8_t*)malloc(LZSS_WINDOW);
+}
+
+LzssDecoder::~LzssDecoder() {
+  free(_window);
+}
+
+int LzssDecoder::next(int (*readByte)(void*), void* ctx) {
+  if (!_window) return -1;
+
+  if (_matchLeft == 0) {
+    if (_flagBits == 0) {
+      int flags = readByte(ctx);
+      if (flags < 0) return -1;
+      _flags = flags;
+      _flagBits = 8;
+    }
+    bool literal = _flags & 1;
+    _flags >>= 1;
+    _flagBits--;
+
+    if (literal) {
+      int c = readByte(ctx);
+      if (c < 0) return -1;
+      _window[_windowPos] = c;
+      _windowPos = (_windowPos + 1) % LZSS_WINDOW;
+      return c;
+    }
+
+    int lo = readByte(ctx);
+    int hi = readByte(ctx);
+    if (lo < 0 || hi < 0) return -1;
+    _matchDistance = (lo | ((hi & 0x03) << 8)) + 1;
+    _matchLeft = (hi >> 2) + LZSS_MIN_MATCH;
+  }
+
+  uint8_t c = _window[(_windowPos + LZSS_WINDOW - _matchDistance) % LZSS_WINDOW];
+  _window[_windowPos] = c;
+  _windowPos = (_windowPos + 1) % LZSS_WINDOW;
+  _matchLeft--;
+  return c;
+}
+
+CompressedFileReader::CompressedFileReader(fs::File& file)
+  : _in(file), _compressed(false), _size(0), _produced(0) {
+  readHeader();
+}
+
+CompressedFileReader::CompressedFileReader(CachedFile& file)
+  : _in(file), _compressed(false), _size(0), _produced(0) {
+  readHeader();
+}
+
+// A plain file can start with the magic as well, so the header also has
+// to agree with the number of bytes that follow it. Returns the header
+// size, 0 if this isn't an LZSS stream.
+static size_t parseHeader(const uint8_t* header, size_t len, size_t fileBytes, size_t& size) {
+  if (len >= LZSS_HEADER_SIZE && memcmp(header, LZSS_MAGIC, 4) == 0) {
+    size = get32(header + 4);
+    bool valid = get32(header + 12) == esp_rom_crc32_le(0, header, 12) &&
+                 get32(header + 8) == fileBytes - LZSS_HEADER_SIZE;
+    return valid ? LZSS_HEADER_SIZE : 0;
+  }
+  if (len >= LZSS_HEADER_SIZE_V1 && memcmp(header, LZSS_MAGIC_V1, 4) == 0) {
+    // Only the original size to go by: every item costs at least one byte
+    // and yields at most LZSS_MAX_MATCH, and literals cost 9/8 of a byte
+    size = get32(header + 4);
+    size_t packed = fileBytes - LZSS_HEADER_SIZE_V1;
+    bool valid = packed >= (size + LZSS_MAX_MATCH - 1) / LZSS_MAX_MATCH && packed <= size + (size + 7) / 8;
+    return valid ? LZSS_HEADER_SIZE_V1 : 0;
+  }
+  return 0;
+}
+
+void CompressedFileReader::readHeader() {
+  size_t start = _in.position();
+  size_t fileBytes = _in.size() > start ? _in.size() - start : 0;
+  uint8_t header[LZSS_HEADER_SIZE];
+  size_t len = _in.readBytes(header, sizeof(header));
+  size_t headerSize = parseHeader(header, len, fileBytes, _size);
+  _compressed = headerSize > 0;
+  if (!_compressed) _size = 0;
+  _in.seek(start + headerSize);
+}
+
+bool isCompressedStream(fs::File& file) {
+  uint8_t header[LZSS_HEADER_SIZE];
+  file.seek(0);
+  size_t len = file.read(header, sizeof(header));
+  file.seek(0);
+  size_t size;
+  return parseHeader(header, len, file.size(), size) > 0;
+}
+
+int CompressedFileReader::readInput(void* ctx) {
+  return static_cast<BufferedFileReader*>(ctx)->read();
+}
+
+size_t CompressedFileReader::remaining() const {
+  if (_compressed) return _size - _produced;
+  return _in.size() > _in.position() ? _in.size() - _in.position() : 0;
+}
+
+int CompressedFileReader::read() {
+  if (!_compressed) return _in.read();
+  if (_produced >= _size) return -1;
+  int c = _decoder.next(readInput, &_in);
+  if (c >= 0) _produced++;
+  return c;
+}
+
+size_t CompressedFileReader::readBytes(uint8_t* dst, size_t len) {
+  if (!_compressed) return _in.readBytes(dst, len);
+  size_t n = 0;
+  while (n < len) {
+    int c = read();
+    if (c < 0) break;
+    dst[n++] = c;
+  }
+  return n;
+}
+
+bool CompressedFileReader::readLine(String& line) {
+  if (!_compressed) return _in.readLine(line);
+
+  line = "";
+  int c = read();
+  if (c < 0) return false;
+  char chunk[64];
+  size_t used = 0;
+  while (c >= 0 && c != '\n') {
+    chunk[used++] = c;
+    if (used == sizeof(chunk)) {
+      line.concat(chunk, used);
+      used = 0;
+    }
+    c = read();
+  }
+  line.concat(chunk, used);
+  if (line.endsWith("\r")) line.remove(line.length() - 1);
+  return true;
+}
+
+String CompressedFileReader::readAll() {
+  if (!_compressed) return _in.readAll();
+
+  String content;
+  if (!content.reserve(remaining())) return content;
+  char chunk[128];
+  size_t n;
+  while ((n = readBytes((uint8_t*)chunk, sizeof(chunk))) > 0) {
+    content.concat(chunk, n);
+  }
+  return content;
+}
+
+size_t writeStoredFile(const String& path, const uint8_t* data, size_t len, bool compress) {
+  if (!storageAvailable || !storageFS) return 0;
+
+  File file = storageFS->open(path, "w");
+  if (!file) {
+    Serial.println("Failed to open file for writing: " + path);
+    return 0;
+  }
+
+  // Data that doesn't shrink (already packed, random) is stored as is;
+  // readers tell the two apart by the header
+  std::vector<uint8_t> packed;
+  if (compress) lzssCompress(data, len, packed);
+  if (packed.size() > 0 && packed.size() < len) {
+    data = packed.data();
+    len = packed.size();
+  }
+  size_t written = file.write(data, len) == len ? len : 0;
+  file.close();
+  return written;
+}
@@ -0,0 +1,88 @@
+#ifndef COMPRESSED_FILE_H
+#define COMPRESSED_FILE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include "buffered_file.h"
+#include "block_cache.h"
+
+// LZSS compression for scripts and config snapshots on LittleFS.
+//
+// Stream: "LZS2" | uint32 original size | uint32 packed size | uint32
+// CRC32 of the 12 bytes before it | groups of one flag byte and up to 8
+// items. Flag bit set = literal byte, clear = 2-byte match (10-bit
+// distance, 6-bit length - 3). The stream runs to the end of the file, so
+// the packed size and checksum keep a plain file that merely starts with
+// the magic from being decoded. "LZS1" streams (original size only) are
+// still read if their size fits the data. The 1 KB window is all the
+// decoder keeps, so files are read back a byte or a line at a time
+// without inflating them whole.
+
+#define LZSS_WINDOW 1024
+#define LZSS_MIN_MATCH 3
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + 63)
+
+// True when new files should be written compressed (LittleFS only; SD
+// cards have room to spare and their files stay plain)
+bool compressionEnabled();
+
+// Appends the framed, compressed form of data to out; the stream must end
+// its file
+void lzssCompress(const uint8_t* data, size_t len, std::vector<uint8_t>& out);
+
+// Incremental decoder; pulls input through readByte(ctx), -1 = end
+class LzssDecoder {
+public:
+  LzssDecoder();
+  ~LzssDecoder();
+  bool ok() const { return _window != nullptr; }
+  // Next output byte, or -1 at the end of the stream
+  int next(int (*readByte)(void*), void* ctx);
+
+private:
+  uint8_t* _window;
+  uint16_t _windowPos;
+  uint8_t _flags;
+  uint8_t _flagBits;  // Items left in the current flag group
+  uint16_t _matchDistance;
+  uint8_t _matchLeft;
+};
+
+// Reads a file that may or may not be compressed; plain files pass
+// through unchanged, so callers don't care which one they got
+class CompressedFileReader {
+public:
+  explicit CompressedFileReader(fs::File& file);
+  explicit CompressedFileReader(CachedFile& file);
+
+  bool compressed() const { return _compressed; }
+  // False when the decoder couldn't get its window
+  bool ok() const { return !_compressed || _decoder.ok(); }
+  // Uncompressed size of the rest of the file
+  size_t remaining() const;
+
+  int read();
+  size_t readBytes(uint8_t* dst, size_t len);
+  bool readLine(String& line);
+  String readAll();
+
+private:
+  void readHeader();
+  static int readInput(void* ctx);
+
+  BufferedFileReader _in;
+  LzssDecoder _decoder;
+  bool _compressed;
+  size_t _size;
+  size_t _produced;
+};
+
+// True when the file holds an LZSS stream; leaves it at the start
+bool isCompressedStream(fs::File& file);
+
+// Writes data to path, LZSS-framed if compress is set. Returns the number
+// of bytes that ended up on disk, 0 on failure.
+size_t writeStoredFile(const String& path, const uint8_t* data, size_t len, bool compress);
+
+#endif //COMPRESSED_FILE_H
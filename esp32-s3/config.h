@@ -10,6 +10,22 @@
 // LittleFS settings for script storage
 #define MAX_SCRIPT_NAME_LEN 32
 
+// Block size of BufferedFileReader/Writer (multiple of the 512-byte SD sector)
+#define FILE_BLOCK_SIZE 4096
+
+// Quick action / quick script profiles kept parsed in RAM
+#define CONFIG_CACHE_MAX_OS 16
+
+// Binary record store for quick actions / quick scripts (one file per OS)
+#define RECORD_STORE_MAX 64          // Entries per OS
+
+// Append-only journal of config edits, folded into snapshots once it grows
+#define CONFIG_JOURNAL_FILE "/config.journal"
+#define CONFIG_JOURNAL_COMPACT_BYTES 8192
+#define CONFIG_COMPACT_RETRY_MS 5000       // First retry after a failed compaction, doubles
+#define CONFIG_COMPACT_RETRY_MAX_MS 300000
+#define CONFIG_FIELD_MAX 16000             // Longest OS name / quick action or script field
+
 // WiFi AP settings 
 #define AP_SSID "USB-HID-Setup"
 #define AP_PASS "HID_M4ster"
@@ -18,20 +34,50 @@
 #define WEB_AUTH_USER "admin"
 #define WEB_AUTH_PASS "WiFi_HID!826"
 
+// Session cookies issued by /api/login, checked before Basic auth
+#define SESSION_COOKIE "hid_session"
+#define SESSION_SLOTS 8
+#define SESSION_TTL_SECONDS 43200  // 12 hours
+
 // HTTPS Settings
 // WARNING: HTTPS uses significant memory
 // Only enable if you have sufficient free memory
 // Set to 1 to enable HTTPS on port 443, 0 to disable (HTTP only on port 80)
 #define ENABLE_HTTPS 0
 
+// Maximum number of commands accepted by one /api/commands batch
+#define MAX_BATCH_COMMANDS 32
+#define MAX_BATCH_DELAY_MS 5000  // Pauses one batch may add up to; the server is blocked meanwhile
+
+// Server-Sent Events (/api/events)
+#define MAX_EVENT_STREAMS 4       // Concurrent browser tabs
+#define EVENT_RING_SIZE 32        // Events kept for Last-Event-ID resume
+#define EVENT_HEARTBEAT_MS 15000  // Keep-alive comment interval
+
 // WiFi connection timeout
 #define WIFI_TIMEOUT 10000
+#define WIFI_POLL_MS 20  // Connection status poll interval (WiFi events poll sooner)
+#define WIFI_RETRY_MS 30000  // Pause before scanning again when no saved network could be joined
+
+// Boot joins the access point, channel and address a saved network was last
+// seen on before falling back to a scan. Reusing the address skips the wait
+// for DHCP, but the router may have given it to another device while this one
+// was off, so DHCP is restarted right after the join: the lease is renewed,
+// or replaced and the cache updated. Until the router answers, a second or
+// so, the address can clash. Turn WIFI_REUSE_LEASE off if that is a concern.
+#define WIFI_FAST_CONNECT 1
+#define WIFI_FAST_TIMEOUT 3000  // Give up on the cached access point after this long
+#define WIFI_REUSE_LEASE 1
 
 // ST7735 LCD Display settings (0.96" IPS LCD - typically 80x160 pixels)
 // This board uses ST7735 controller, NOT SSD1306 OLED
 #define SCREEN_WIDTH 80
 #define SCREEN_HEIGHT 160
 #define DISPLAY_ROTATION 1  // 0=0°, 1=90°, 2=180°, 3=270° (adjust for your orientation)
+#define DISPLAY_SPRITE 1    // Compose the status screen in a PSRAM sprite and push it with DMA
+#define DISPLAY_MAX_FPS 10  // Status screen redraws per second at most; requests in between are merged
+#define DISPLAY_ACTION_MS 3000  // How long the last action stays on the status screen
+#define BMP_RGB565_CACHE 1  // Keep decoded BMPs (the boot logo) as raw RGB565 in "<file>.565"
 
 // ST7735 Color definitions (RGB565 format)
 #define ST77XX_BLACK      0x0000
@@ -75,6 +121,55 @@
 #define SD_MMC_CLK  12
 #define SD_MMC_CMD  16
 
+// File download read sizes per storage backend. SD_MMC reads are cheapest in
+// large multi-sector blocks; LittleFS works in 4 KB flash pages.
+#define DOWNLOAD_CHUNK_SD 16384
+#define DOWNLOAD_CHUNK_LITTLEFS 4096
+
+// Upload coalescing buffer sizes. Multipart chunks (~1.4 KB) are gathered
+// in PSRAM and written in one go once the buffer is full.
+#define UPLOAD_BUFFER_SD (256 * 1024)
+#define UPLOAD_BUFFER_LITTLEFS (32 * 1024)
+#define UPLOAD_BUFFER_FALLBACK 8192  // Internal RAM, used when PSRAM is missing
+
+// Resumable chunked uploads (/api/files/chunked/*)
+#define MAX_CHUNKED_UPLOADS 2
+#define CHUNKED_DEFAULT_CHUNK (64 * 1024)
+#define CHUNKED_MAX_CHUNK (1024 * 1024)
+#define CHUNKED_MIN_CHUNK 4096
+
+// Storage usage accounting. Sizes are rounded up to the allocation unit
+// (a typical FAT32 cluster / a LittleFS block); a background rescan
+// corrects any drift.
+#define STORAGE_ALLOC_UNIT_SD 32768
+#define STORAGE_ALLOC_UNIT_LITTLEFS 4096
+#define STORAGE_USAGE_RECONCILE_MS 600000  // 10 minutes
+
+// Saved scripts and quick action/script snapshots are LZSS-compressed on
+// LittleFS (see compressed_file.h). Set to 0 to write plain files; files
+// already compressed stay readable either way.
+#define STORAGE_COMPRESSION 1
+
+// Directory listings (/api/files). Set DIR_CACHE_TTL_MS to 0 to disable
+// the cache and read the directory on every request.
+#define DIR_CACHE_SLOTS 4                 // Directories kept
+#define DIR_CACHE_MAX_BYTES (256 * 1024)  // Total size of kept listings
+#define DIR_CACHE_TTL_MS 30000
+#define DIR_PAGE_DEFAULT 200              // Entries per page without ?limit=
+#define DIR_PAGE_MAX 1000
+
+// PSRAM block cache in front of storageFS (block_cache.h). Set
+// BLOCK_CACHE_BYTES to 0 to read straight from storage.
+#define BLOCK_CACHE_BYTES (2 * 1024 * 1024)
+#define BLOCK_CACHE_BLOCK_SIZE 4096
+#define BLOCK_CACHE_FILES 64                     // Files tracked at once
+#define BLOCK_CACHE_PIN_MAX_BYTES (1024 * 1024)  // Cap for /www/* and the logo
+
+// Configuration backup/restore (/api/backup, /api/restore)
+#define BACKUP_BUFFER_SIZE 4096        // Bytes per chunk sent to the client
+#define BACKUP_GZIP_PROBES 128         // Deflate match search effort (1-4095)
+#define RESTORE_TEXT_MAX (64 * 1024)   // Largest config member accepted
+
 // USB HID settings for ESP32-S3
 #define USB_HID_ENABLED 1  // ESP32-S3 has full USB HID support
 #define SERIAL_BAUD 115200 // USB Serial baud rate
@@ -0,0 +1,679 @@
+#include "config_backup.h"
+#include <esp_rom_crc.h>
+#include <esp32s3/rom/miniz.h>
+#include <stddef.h>
+#include <vector>
+#include "config.h"
+#include "littlefs_manager.h"
+#include "wifi_manager.h"
+#include "config_cache.h"
+#include "script_manifest.h"
+#include "compressed_file.h"
+
+#define TAR_BLOCK 512
+#define RESTORE_TEMP_FILE "/scripts/restore.tmp"
+
+// POSIX ustar header
+struct TarHeader {
+  char name[100];
+  char mode[8];
+  char uid[8];
+  char gid[8];
+  char size[12];
+  char mtime[12];
+  char checksum[8];
+  char type;
+  char linkname[100];
+  char magic[6];
+  char version[2];
+  char uname[32];
+  char gname[32];
+  char devmajor[8];
+  char devminor[8];
+  char prefix[155];
+  char padding[12];
+};
+static_assert(sizeof(TarHeader) == TAR_BLOCK, "ustar header must be one block");
+
+// Sum of all header bytes with the checksum field counted as spaces
+static uint32_t headerChecksum(const TarHeader& header) {
+  const uint8_t* bytes = (const uint8_t*)&header;
+  size_t start = offsetof(TarHeader, checksum);
+  uint32_t sum = 0;
+  for (size_t i = 0; i < TAR_BLOCK; i++) {
+    sum += (i >= start && i < start + sizeof(header.checksum)) ? ' ' : bytes[i];
+  }
+  return sum;
+}
+
+static uint32_t parseOctal(const char* field, size_t len) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < len && field[i] >= '0' && field[i] <= '7'; i++) {
+    value = (value << 3) | (field[i] - '0');
+  }
+  return value;
+}
+
+// OS names are free text; member names only get the safe characters
+static String safeName(const String& name) {
+  String out;
+  for (size_t i = 0; i < name.length(); i++) {
+    char c = name[i];
+    out += (isalnum(c) || c == '-' || c == '.') ? c : '_';
+  }
+  return out;
+}
+
+static String scriptMember(const ScriptInfo& script) {
+  String base = script.file.substring(script.file.lastIndexOf('/') + 1);
+  int dot = base.lastIndexOf('.');
+  if (dot > 0) base = base.substring(0, dot);
+  return "scripts/" + base + ".txt";
+}
+
+template <typename Fn>
+static void forEachLine(const String& text, Fn fn) {
+  int start = 0;
+  while (start < (int)text.length()) {
+    int end = text.indexOf('\n', start);
+    if (end < 0) end = text.length();
+    String line = text.substring(start, end);
+    if (line.endsWith("\r")) line.remove(line.length() - 1);
+    if (line.length() > 0) fn(line);
+    start = end + 1;
+  }
+}
+
+// Backup
+
+class BackupWriter {
+public:
+  BackupWriter(BackupSink sink, void* ctx);
+  ~BackupWriter();
+
+  bool begin(bool gzip);
+  bool addText(const String& name, const String& text);
+  bool addFile(const String& name, const String& path);
+  bool finish();
+
+private:
+  bool header(const String& name, size_t size);
+  bool pad(size_t size);
+  bool put(const uint8_t* data, size_t len);
+  bool emit(const uint8_t* data, size_t len);
+  bool flush();
+  static mz_bool deflated(const void* data, int len, void* user);
+
+  BackupSink _sink;
+  void* _ctx;
+  uint8_t* _buffer;
+  size_t _used;
+  tdefl_compressor* _deflate;
+  uint32_t _crc;
+  uint32_t _size;
+  bool _failed;
+};
+
+BackupWriter::BackupWriter(BackupSink sink, void* ctx)
+  : _sink(sink), _ctx(ctx), _buffer(nullptr), _used(0), _deflate(nullptr), _crc(0), _size(0), _failed(false) {}
+
+BackupWriter::~BackupWriter() {
+  free(_buffer);
+  free(_deflate);
+}
+
+bool BackupWriter::begin(bool gzip) {
+  _buffer = (uint8_t*)malloc(BACKUP_BUFFER_SIZE);
+  if (!_buffer) return false;
+  if (!gzip) return true;
+
+  // Several hundred KB of match state; only PSRAM has room for it
+  _deflate = (tdefl_compressor*)ps_malloc(sizeof(tdefl_compressor));
+  if (!_deflate || tdefl_init(_deflate, deflated, this, BACKUP_GZIP_PROBES) != TDEFL_STATUS_OKAY) return false;
+
+  // gzip member header: deflate, no name, no timestamp, OS unknown
+  const uint8_t gzipHeader[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+  return emit(gzipHeader, sizeof(gzipHeader));
+}
+
+bool BackupWriter::header(const String& name, size_t size) {
+  TarHeader header;
+  memset(&header, 0, sizeof(header));
+  if (name.length() >= sizeof(header.name)) return false;
+  memcpy(header.name, name.c_str(), name.length());
+  snprintf(header.mode, sizeof(header.mode), "%07o", 0644);
+  snprintf(header.uid, sizeof(header.uid), "%07o", 0);
+  snprintf(header.gid, sizeof(header.gid), "%07o", 0);
+  snprintf(header.size, sizeof(header.size), "%011lo", (unsigned long)size);
+  snprintf(header.mtime, sizeof(header.mtime), "%011lo", (unsigned long)time(nullptr));
+  header.type = '0';
+  memcpy(header.magic, "ustar", 6);
+  memcpy(header.version, "00", 2);
+  snprintf(header.checksum, sizeof(header.checksum), "%06lo", (unsigned long)headerChecksum(header));
+  header.checksum[7] = ' ';
+  return put((const uint8_t*)&header, sizeof(header));
+}
+
+bool BackupWriter::pad(size_t size) {
+  static const uint8_t zeros[TAR_BLOCK] = { 0 };
+  size_t rest = (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+  return rest == 0 || put(zeros, rest);
+}
+
+bool BackupWriter::addText(const String& name, const String& text) {
+  return header(name, text.length()) && put((const uint8_t*)text.c_str(), text.length()) && pad(text.length());
+}
+
+bool BackupWriter::addFile(const String& name, const String& path) {
+  File file = storageFS->open(path, "r");
+  if (!file) return true;  // Gone since the manifest was read; leave it out
+
+  bool ok;
+  {
+    CompressedFileReader reader(file);
+    size_t size = reader.remaining();
+    ok = header(name, size);
+
+    uint8_t chunk[512];
+    size_t sent = 0;
+    while (ok && sent < size) {
+      size_t n = reader.readBytes(chunk, min(sizeof(chunk), size - sent));
+      if (n == 0) {
+        // Short file: keep the archive well-formed
+        n = min(sizeof(chunk), size - sent);
+        memset(chunk, 0, n);
+      }
+      ok = put(chunk, n);
+      sent += n;
+    }
+    ok = ok && pad(size);
+  }
+  file.close();
+  return ok;
+}
+
+bool BackupWriter::finish() {
+  static const uint8_t zeros[TAR_BLOCK] = { 0 };
+  if (!put(zeros, TAR_BLOCK) || !put(zeros, TAR_BLOCK)) return false;
+
+  if (_deflate) {
+    if (tdefl_compress_buffer(_deflate, nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE) return false;
+    uint8_t trailer[8];
+    for (int i = 0; i < 4; i++) {
+      trailer[i] = _crc >> (8 * i);
+      trailer[4 + i] = _size >> (8 * i);
+    }
+    if (!emit(trailer, sizeof(trailer))) return false;
+  }
+  return flush();
+}
+
+// Archive bytes, before compression
+bool BackupWriter::put(const uint8_t* data, size_t len) {
+  if (!_deflate) return emit(data, len);
+  _crc = esp_rom_crc32_le(_crc, data, len);
+  _size += len;
+  return tdefl_compress_buffer(_deflate, data, len, TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY && !_failed;
+}
+
+mz_bool BackupWriter::deflated(const void* data, int len, void* user) {
+  BackupWriter* writer = static_cast<BackupWriter*>(user);
+  return writer->emit((const uint8_t*)data, len);
+}
+
+// Output bytes, gathered into BACKUP_BUFFER_SIZE pieces for the sink
+bool BackupWriter::emit(const uint8_t* data, size_t len) {
+  while (len > 0 && !_failed) {
+    size_t n = min(len, (size_t)BACKUP_BUFFER_SIZE - _used);
+    memcpy(_buffer + _used, data, n);
+    _used += n;
+    data += n;
+    len -= n;
+    if (_used == BACKUP_BUFFER_SIZE) flush();
+  }
+  return !_failed;
+}
+
+bool BackupWriter::flush() {
+  if (_used > 0 && !_failed && !_sink(_buffer, _used, _ctx)) _failed = true;
+  _used = 0;
+  return !_failed;
+}
+
+bool backupGzipSupported() {
+  return psramFound();
+}
+
+bool writeBackup(bool gzip, BackupSink sink, void* ctx) {
+  if (!storageAvailable || !storageFS) return false;
+
+  BackupWriter writer(sink, ctx);
+  if (!writer.begin(gzip)) return false;
+
+  String wifi;
+  for (const auto& net : knownNetworks) {
+    wifi += net.ssid + "\t" + net.password + "\n";
+  }
+  bool ok = writer.addText("wifi.txt", wifi);
+
+  // Custom OS names first, so a restore knows them before their lists
+  String customOS;
+  for (const auto& name : getCustomOSList()) {
+    customOS += name + "\n";
+  }
+  ok = ok && writer.addText("customos.txt", customOS);
+
+  for (const auto& os : getOSNames()) {
+    ok = ok && writer.addText("quickactions/" + safeName(os) + ".txt", exportQuickActionsText(os));
+    ok = ok && writer.addText("quickscripts/" + safeName(os) + ".txt", exportQuickScriptsText(os));
+  }
+
+  String index;
+  for (const auto& script : getScriptList()) {
+    index += scriptMember(script) + "\t" + script.name + "\n";
+  }
+  ok = ok && writer.addText("scripts/index.txt", index);
+  for (const auto& script : getScriptList()) {
+    if (!ok) break;
+    ok = writer.addFile(scriptMember(script), script.file);
+  }
+
+  return ok && writer.finish();
+}
+
+// Restore
+
+enum GzipStage : uint8_t {
+  GZ_FIXED,  // 10-byte member header
+  GZ_EXTRA_LEN,
+  GZ_EXTRA,
+  GZ_NAME,
+  GZ_COMMENT,
+  GZ_HCRC,
+  GZ_BODY,
+  GZ_TRAILER,
+  GZ_DONE
+};
+
+enum TarStage : uint8_t { TAR_HEADER, TAR_DATA, TAR_PADDING, TAR_END };
+
+enum MemberKind : uint8_t { MEMBER_SKIP, MEMBER_TEXT, MEMBER_SCRIPT };
+
+struct RestoreState {
+  bool active;
+  bool detected;
+  bool gzip;
+
+  GzipStage gzStage;
+  uint8_t gzFlags;
+  uint8_t gzBuf[10];
+  size_t gzCount;
+  size_t gzNeed;
+  tinfl_decompressor* inflator;
+  uint8_t* dict;  // TINFL_LZ_DICT_SIZE ring the inflater writes into
+  size_t dictPos;
+  bool inflatePending;
+  uint32_t crc;
+  uint32_t inflated;
+
+  TarStage tarStage;
+  TarHeader header;
+  size_t headerFill;
+  size_t size;       // Of the current member
+  size_t remaining;
+  size_t padding;
+  MemberKind kind;
+  String member;
+  String text;
+  File file;
+  size_t fileBytes;
+  std::vector<std::pair<String, String>> scriptNames;  // Member, script name
+
+  RestoreResult result;
+};
+
+static RestoreState restore;
+
+static bool restoreFailed(const String& error) {
+  if (restore.result.error.length() == 0) restore.result.error = error;
+  Serial.println("Restore error: " + error);
+  return false;
+}
+
+static void resetRestore() {
+  free(restore.inflator);
+  free(restore.dict);
+  restore.inflator = nullptr;
+  restore.dict = nullptr;
+  if (restore.file) restore.file.close();
+  if (storageAvailable && storageFS && storageFS->exists(RESTORE_TEMP_FILE)) storageFS->remove(RESTORE_TEMP_FILE);
+  restore.text = "";
+  restore.member = "";
+  restore.scriptNames.clear();
+  restore.active = false;
+}
+
+static String resolveOS(const String& safe) {
+  for (const auto& os : getOSNames()) {
+    if (safeName(os) == safe) return os;
+  }
+  return safe;
+}
+
+static void applyText() {
+  const String& name = restore.member;
+  RestoreResult& result = restore.result;
+
+  if (name == "wifi.txt") {
+    forEachLine(restore.text, [&](const String& line) {
+      int tab = line.indexOf('\t');
+      String ssid = tab >= 0 ? line.substring(0, tab) : line;
+      String password = tab >= 0 ? line.substring(tab + 1) : String();
+      if (ssid.length() > 0 && addWifiNetwork(ssid, password)) result.wifi++;
+    });
+  } else if (name == "customos.txt") {
+    forEachLine(restore.text, [&](const String& line) {
+      bool known = false;
+      for (const auto& os : getOSNames()) known = known || os == line;
+      if (!known && addCustomOS(line)) result.customOS++;
+    });
+  } else if (name == "scripts/index.txt") {
+    forEachLine(restore.text, [&](const String& line) {
+      int tab = line.indexOf('\t');
+      if (tab > 0) restore.scriptNames.push_back({ line.substring(0, tab), line.substring(tab + 1) });
+    });
+  } else {
+    bool actions = name.startsWith("quickactions/");
+    String os = resolveOS(name.substring(13, name.length() - 4));
+    int count = actions ? importQuickActionsText(os, restore.text) : importQuickScriptsText(os, restore.text);
+    if (count >= 0) {
+      result.quickLists++;
+    } else {
+      result.skipped++;
+    }
+  }
+  restore.text = "";
+}
+
+static void applyScript() {
+  restore.file.close();
+  if (restore.fileBytes != restore.size) {
+    storageFS->remove(RESTORE_TEMP_FILE);
+    restore.result.skipped++;
+    return;
+  }
+
+  // Named by the index; a member the index doesn't list keeps its file name
+  String name = restore.member.substring(8, restore.member.length() - 4);
+  for (const auto& entry : restore.scriptNames) {
+    if (entry.first == restore.member) name = entry.second;
+  }
+  if (adoptScriptFile(name, RESTORE_TEMP_FILE)) {
+    restore.result.scripts++;
+  } else {
+    storageFS->remove(RESTORE_TEMP_FILE);
+    restore.result.skipped++;
+  }
+}
+
+static bool startMember() {
+  const TarHeader& header = restore.header;
+
+  // Two zero blocks end the archive; one is enough to stop
+  bool empty = true;
+  for (size_t i = 0; i < TAR_BLOCK && empty; i++) empty = ((const uint8_t*)&header)[i] == 0;
+  if (empty) {
+    restore.tarStage = TAR_END;
+    return true;
+  }
+
+  if (parseOctal(header.checksum, sizeof(header.checksum)) != headerChecksum(header)) {
+    return restoreFailed("Not a tar archive");
+  }
+
+  String name;
+  if (header.prefix[0]) {
+    name.concat(header.prefix, strnlen(header.prefix, sizeof(header.prefix)));
+    name += "/";
+  }
+  name.concat(header.name, strnlen(header.name, sizeof(header.name)));
+  if (name.startsWith("./")) name = name.substring(2);
+
+  restore.member = name;
+  restore.size = parseOctal(header.size, sizeof(header.size));
+  restore.remaining = restore.size;
+  restore.padding = (TAR_BLOCK - restore.remaining % TAR_BLOCK) % TAR_BLOCK;
+  restore.kind = MEMBER_SKIP;
+
+  bool regular = header.type == '0' || header.type == '\0';
+  bool text = name == "wifi.txt" || name == "customos.txt" || name == "scripts/index.txt" ||
+              ((name.startsWith("quickactions/") || name.startsWith("quickscripts/")) && name.endsWith(".txt"));
+  bool script = !text && name.startsWith("scripts/") && name.endsWith(".txt") && name.indexOf('/', 8) < 0;
+
+  if (regular && text && restore.remaining <= RESTORE_TEXT_MAX && restore.text.reserve(restore.remaining)) {
+    restore.kind = MEMBER_TEXT;
+  } else if (regular && script && hasAvailableSpace(restore.remaining)) {
+    if (!storageFS->exists(SCRIPTS_DIR)) storageFS->mkdir(SCRIPTS_DIR);
+    restore.file = storageFS->open(RESTORE_TEMP_FILE, "w");
+    restore.fileBytes = 0;
+    if (restore.file) restore.kind = MEMBER_SCRIPT;
+  }
+  if (restore.kind == MEMBER_SKIP && regular) restore.result.skipped++;
+
+  restore.tarStage = TAR_DATA;
+  return true;
+}
+
+static void memberData(const uint8_t* data, size_t len) {
+  if (restore.kind == MEMBER_TEXT) {
+    restore.text.concat((const char*)data, len);
+  } else if (restore.kind == MEMBER_SCRIPT) {
+    restore.fileBytes += restore.file.write(data, len);
+  }
+}
+
+static void finishMember() {
+  if (restore.kind == MEMBER_TEXT) applyText();
+  if (restore.kind == MEMBER_SCRIPT) applyScript();
+  restore.kind = MEMBER_SKIP;
+  restore.tarStage = restore.padding > 0 ? TAR_PADDING : TAR_HEADER;
+}
+
+// Unpacks archive bytes as they arrive
+static bool tarWrite(const uint8_t* data, size_t len) {
+  while (len > 0) {
+    size_t n = 0;
+    switch (restore.tarStage) {
+      case TAR_HEADER:
+        n = min(len, TAR_BLOCK - restore.headerFill);
+        memcpy((uint8_t*)&restore.header + restore.headerFill, data, n);
+        restore.headerFill += n;
+        if (restore.headerFill == TAR_BLOCK) {
+          restore.headerFill = 0;
+          if (!startMember()) return false;
+          if (restore.tarStage == TAR_DATA && restore.remaining == 0) finishMember();
+        }
+        break;
+      case TAR_DATA:
+        n = min(len, restore.remaining);
+        memberData(data, n);
+        restore.remaining -= n;
+        if (restore.remaining == 0) finishMember();
+        break;
+      case TAR_PADDING:
+        n = min(len, restore.padding);
+        restore.padding -= n;
+        if (restore.padding == 0) restore.tarStage = TAR_HEADER;
+        break;
+      case TAR_END:
+        return true;  // Trailing zero blocks
+    }
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+static void nextGzipStage() {
+  restore.gzCount = 0;
+  if (restore.gzFlags & 0x04) {
+    restore.gzFlags &= ~0x04;
+    restore.gzStage = GZ_EXTRA_LEN;
+  } else if (restore.gzFlags & 0x08) {
+    restore.gzFlags &= ~0x08;
+    restore.gzStage = GZ_NAME;
+  } else if (restore.gzFlags & 0x10) {
+    restore.gzFlags &= ~0x10;
+    restore.gzStage = GZ_COMMENT;
+  } else if (restore.gzFlags & 0x02) {
+    restore.gzFlags &= ~0x02;
+    restore.gzStage = GZ_HCRC;
+  } else {
+    restore.gzStage = GZ_BODY;
+  }
+}
+
+static bool gzipHeaderByte(uint8_t c) {
+  switch (restore.gzStage) {
+    case GZ_FIXED:
+      restore.gzBuf[restore.gzCount++] = c;
+      if (restore.gzCount < 10) return true;
+      if (restore.gzBuf[0] != 0x1f || restore.gzBuf[1] != 0x8b || restore.gzBuf[2] != 8) {
+        return restoreFailed("Not a gzip archive");
+      }
+      restore.gzFlags = restore.gzBuf[3];
+      nextGzipStage();
+      return true;
+    case GZ_EXTRA_LEN:
+      restore.gzBuf[restore.gzCount++] = c;
+      if (restore.gzCount == 2) {
+        restore.gzNeed = restore.gzBuf[0] | (restore.gzBuf[1] << 8);
+        restore.gzStage = GZ_EXTRA;
+        if (restore.gzNeed == 0) nextGzipStage();
+      }
+      return true;
+    case GZ_EXTRA:
+      if (--restore.gzNeed == 0) nextGzipStage();
+      return true;
+    case GZ_NAME:
+    case GZ_COMMENT:
+      if (c == 0) nextGzipStage();
+      return true;
+    case GZ_HCRC:
+      if (++restore.gzCount == 2) nextGzipStage();
+      return true;
+    case GZ_TRAILER: {
+      restore.gzBuf[restore.gzCount++] = c;
+      if (restore.gzCount < 8) return true;
+      uint32_t crc = 0, size = 0;
+      for (int i = 0; i < 4; i++) {
+        crc |= (uint32_t)restore.gzBuf[i] << (8 * i);
+        size |= (uint32_t)restore.gzBuf[4 + i] << (8 * i);
+      }
+      if (crc != restore.crc || size != restore.inflated) return restoreFailed("gzip checksum mismatch");
+      restore.gzStage = GZ_DONE;
+      return true;
+    }
+    default:
+      return true;
+  }
+}
+
+// Runs the inflater over the input from pos; output goes to the tar parser
+static bool inflateSome(const uint8_t* data, size_t len, size_t& pos) {
+  size_t inBytes = len - pos;
+  size_t outBytes = TINFL_LZ_DICT_SIZE - restore.dictPos;
+  tinfl_status status = tinfl_decompress(restore.inflator, data + pos, &inBytes, restore.dict,
+                                         restore.dict + restore.dictPos, &outBytes, TINFL_FLAG_HAS_MORE_INPUT);
+  pos += inBytes;
+
+  if (outBytes > 0) {
+    const uint8_t* out = restore.dict + restore.dictPos;
+    restore.crc = esp_rom_crc32_le(restore.crc, out, outBytes);
+    restore.inflated += outBytes;
+    restore.dictPos = (restore.dictPos + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+    if (!tarWrite(out, outBytes)) return false;
+  }
+
+  if (status < TINFL_STATUS_DONE) return restoreFailed("Corrupt gzip data");
+  restore.inflatePending = status == TINFL_STATUS_HAS_MORE_OUTPUT;
+  if (status == TINFL_STATUS_DONE) {
+    restore.gzStage = GZ_TRAILER;
+    restore.gzCount = 0;
+  }
+  return true;
+}
+
+void beginRestore() {
+  resetRestore();
+  restore.result = { 0, 0, 0, 0, 0, "" };
+  restore.active = true;
+  restore.detected = false;
+  restore.gzip = false;
+  restore.gzStage = GZ_FIXED;
+  restore.gzCount = 0;
+  restore.dictPos = 0;
+  restore.inflatePending = false;
+  restore.crc = 0;
+  restore.inflated = 0;
+  restore.tarStage = TAR_HEADER;
+  restore.headerFill = 0;
+  restore.kind = MEMBER_SKIP;
+  if (!storageAvailable || !storageFS) restoreFailed("Storage not available");
+}
+
+bool writeRestore(const uint8_t* data, size_t len) {
+  if (!restore.active || restore.result.error.length() > 0) return false;
+  if (len == 0) return true;
+
+  if (!restore.detected) {
+    restore.detected = true;
+    restore.gzip = data[0] == 0x1f;
+    if (restore.gzip) {
+      // Inflate state plus the 32 KB window it needs
+      restore.inflator = (tinfl_decompressor*)(psramFound() ? ps_malloc(sizeof(tinfl_decompressor)) : malloc(sizeof(tinfl_decompressor)));
+      restore.dict = (uint8_t*)(psramFound() ? ps_malloc(TINFL_LZ_DICT_SIZE) : malloc(TINFL_LZ_DICT_SIZE));
+      if (!restore.inflator || !restore.dict) return restoreFailed("Out of memory");
+      tinfl_init(restore.inflator);
+    }
+  }
+  if (!restore.gzip) return tarWrite(data, len);
+
+  size_t pos = 0;
+  while (pos < len || (restore.gzStage == GZ_BODY && restore.inflatePending)) {
+    if (restore.gzStage == GZ_BODY) {
+      if (!inflateSome(data, len, pos)) return false;
+    } else if (restore.gzStage == GZ_DONE) {
+      break;  // Anything after the first gzip member is ignored
+    } else if (!gzipHeaderByte(data[pos++])) {
+      return false;
+    }
+  }
+  return restore.result.error.length() == 0;
+}
+
+bool endRestore() {
+  if (!restore.active) return false;
+
+  bool complete = restore.gzip ? restore.gzStage == GZ_DONE
+                               : restore.tarStage == TAR_END || (restore.tarStage == TAR_HEADER && restore.headerFill == 0);
+  if (restore.result.error.length() == 0 && (!restore.detected || !complete)) {
+    restoreFailed("Archive is incomplete");
+  }
+  resetRestore();
+
+  Serial.println("Restore: " + String(restore.result.wifi) + " networks, " + String(restore.result.customOS) +
+                 " custom OS, " + String(restore.result.quickLists) + " quick lists, " +
+                 String(restore.result.scripts) + " scripts, " + String(restore.result.skipped) + " skipped");
+  return restore.result.error.length() == 0;
+}
+
+void abortRestore() {
+  if (!restore.active) return;
+  restoreFailed("Upload aborted");
+  resetRestore();
+}
+
+const RestoreResult& getRestoreResult() {
+  return restore.result;
+}
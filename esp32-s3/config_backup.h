@@ -0,0 +1,44 @@
+#ifndef CONFIG_BACKUP_H
+#define CONFIG_BACKUP_H
+
+#include <Arduino.h>
+
+// Whole-device configuration as one tar archive, optionally gzip'd:
+//   wifi.txt               "ssid<TAB>password" per line
+//   customos.txt           one custom OS name per line
+//   quickactions/<os>.txt  same format as /api/quickactions/export
+//   quickscripts/<os>.txt  same format as /api/quickscripts/export
+//   scripts/index.txt      "<member><TAB><script name>" per line
+//   scripts/<name>.txt     saved scripts as plain text
+// The backup is generated member by member as it is sent and the restore
+// unpacks the upload as it arrives, so memory use doesn't grow with the
+// archive.
+
+// Receives backup output; returning false aborts the backup
+typedef bool (*BackupSink)(const uint8_t* data, size_t len, void* ctx);
+
+// gzip output needs PSRAM for the deflate state
+bool backupGzipSupported();
+bool writeBackup(bool gzip, BackupSink sink, void* ctx);
+
+struct RestoreResult {
+  int wifi;        // Networks added or updated
+  int customOS;    // Custom OS names added
+  int quickLists;  // Quick action/script lists replaced
+  int scripts;     // Saved scripts written
+  int skipped;     // Unknown or oversized members
+  String error;    // "" on success
+};
+
+// Restore, fed with the upload one piece at a time. Plain and gzip'd tar
+// are told apart by the first byte. Settings are merged: networks, custom
+// OS names and scripts in the archive are added or replaced, quick lists
+// in the archive replace that OS's list, anything else is kept.
+void beginRestore();
+bool writeRestore(const uint8_t* data, size_t len);
+// False if the archive was cut short or corrupt
+bool endRestore();
+void abortRestore();
+const RestoreResult& getRestoreResult();
+
+#endif //CONFIG_BACKUP_H
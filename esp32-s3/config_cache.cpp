@@ -0,0 +1,902 @@
+#include "config_cache.h"
+#include "littlefs_manager.h"
+#include "utils.h"
+#include "config.h"
+#include "buffered_file.h"
+#include "record_store.h"
+#include "config_journal.h"
+
+struct OSConfig {
+  String os;
+  std::vector<QuickAction> actions;
+  std::vector<QuickScript> scripts;
+  String actionsJson;
+  String scriptsJson;
+  bool actionsJsonValid;
+  bool scriptsJsonValid;
+  bool actionsDirty;  // Changed since the last snapshot
+  bool scriptsDirty;
+};
+
+static std::vector<OSConfig> osConfigs;  // Reserved to the cap; never reallocates
+static OSConfig uncachedOS;
+static std::vector<String> customOS;
+static String customOSJson;
+static bool customOSJsonValid = false;
+static bool customOSDirty = false;
+static uint32_t configVersion = 1;
+static uint32_t compactRetryAt = 0;
+static uint32_t compactBackoffMs = 0;  // 0 = last compaction succeeded
+
+// Calls fn(line) for every non-empty line of a text file
+template <typename Fn>
+static void forEachFileLine(const String& path, Fn fn) {
+  if (!storageAvailable || !storageFS || !storageFS->exists(path)) return;
+
+  File file = storageFS->open(path, "r");
+  if (!file) {
+    Serial.println("Failed to open file for reading: " + path);
+    return;
+  }
+  {
+    BufferedFileReader reader(file);
+    String line;
+    while (reader.readLine(line)) {
+      if (line.length() > 0) fn(line);
+    }
+  }
+  file.close();
+}
+
+// Streams lines produced by fn(writer) into <path>.tmp, then moves it
+// over path so the file is never seen half written
+template <typename Fn>
+static bool writeFileLines(const String& path, Fn fn, size_t* written = nullptr) {
+  String tempPath = path + ".tmp";
+  File file = storageFS->open(tempPath, "w");
+  if (!file) {
+    Serial.println("Failed to open file for writing: " + tempPath);
+    return false;
+  }
+  bool ok;
+  {
+    BufferedFileWriter writer(file);
+    fn(writer);
+    ok = writer.flush();
+  }
+  if (written) *written = file.size();
+  file.close();
+
+  if (!ok) {
+    storageFS->remove(tempPath);
+    return false;
+  }
+  if (storageFS->exists(path)) storageFS->remove(path);
+  return storageFS->rename(tempPath, path);
+}
+
+// Finishes a writeFileLines() cut short between removing the old file and
+// renaming the new one; an unfinished temp file is dropped
+static void recoverFileLines(const String& path) {
+  String tempPath = path + ".tmp";
+  if (!storageFS->exists(tempPath)) return;
+  if (storageFS->exists(path)) {
+    storageFS->remove(tempPath);
+  } else {
+    storageFS->rename(tempPath, path);
+  }
+}
+
+// Splits "a|b|c|d" into four fields; the last field keeps any extra pipes
+static bool splitFields(const String& line, String fields[4]) {
+  int pipe1 = line.indexOf('|');
+  int pipe2 = line.indexOf('|', pipe1 + 1);
+  int pipe3 = line.indexOf('|', pipe2 + 1);
+  if (pipe1 <= 0 || pipe2 <= pipe1 || pipe3 <= pipe2) return false;
+  fields[0] = line.substring(0, pipe1);
+  fields[1] = line.substring(pipe1 + 1, pipe2);
+  fields[2] = line.substring(pipe2 + 1, pipe3);
+  fields[3] = line.substring(pipe3 + 1);
+  return true;
+}
+
+// Quick actions and scripts are kept in a binary record store next to
+// where the old text file lived ("quickactions_Windows.dat")
+static String storePath(const String& textPath) {
+  return textPath.substring(0, textPath.lastIndexOf('.')) + ".dat";
+}
+
+static StoredRecord fromAction(const QuickAction& action) {
+  return { { action.cmd, action.label, action.desc, action.btnClass } };
+}
+
+static StoredRecord fromScript(const QuickScript& script) {
+  return { { script.id, script.label, script.script, script.btnClass } };
+}
+
+static QuickAction toAction(const StoredRecord& record) {
+  return { record.fields[0], record.fields[1], record.fields[2], record.fields[3] };
+}
+
+static QuickScript toScript(const StoredRecord& record) {
+  return { record.fields[0], record.fields[1], record.fields[2], record.fields[3] };
+}
+
+// Journal entries and snapshots store field lengths in 16 bits
+static bool fieldsFit(const StoredRecord& record) {
+  for (const auto& field : record.fields) {
+    if (field.length() > CONFIG_FIELD_MAX) return false;
+  }
+  return true;
+}
+
+// Parses the pipe-delimited text format; scripts have their newlines escaped
+static void parseTextRecords(const String& text, bool escaped, std::vector<StoredRecord>& out) {
+  StoredRecord record;
+  int start = 0;
+  while (start < (int)text.length() && out.size() < RECORD_STORE_MAX) {
+    int end = text.indexOf('\n', start);
+    if (end == -1) end = text.length();
+    String line = text.substring(start, end);
+    if (line.endsWith("\r")) line.remove(line.length() - 1);
+    start = end + 1;
+    if (!splitFields(line, record.fields)) continue;
+    if (escaped) record.fields[2].replace("\\n", "\n");
+    if (!fieldsFit(record)) continue;
+    out.push_back(record);
+  }
+}
+
+static String formatTextRecords(const std::vector<StoredRecord>& records, bool escaped) {
+  String text;
+  for (const auto& record : records) {
+    String third = record.fields[2];
+    if (escaped) third.replace("\n", "\\n");
+    text += record.fields[0] + "|" + record.fields[1] + "|" + third + "|" + record.fields[3] + "\n";
+  }
+  return text;
+}
+
+// Loads from the record store, converting a text file left by older firmware
+static void loadRecords(const String& textPath, bool escaped, std::vector<StoredRecord>& out) {
+  out.clear();
+  if (!storageAvailable || !storageFS) return;
+
+  RecordStore store(storePath(textPath));
+  if (store.exists()) {
+    store.loadAll(out);
+    return;
+  }
+  if (!storageFS->exists(textPath)) return;
+
+  StoredRecord record;
+  forEachFileLine(textPath, [&](const String& line) {
+    if (out.size() >= RECORD_STORE_MAX || !splitFields(line, record.fields)) return;
+    if (escaped) record.fields[2].replace("\\n", "\n");
+    out.push_back(record);
+  });
+  if (store.rewrite(out)) {
+    storageFS->remove(textPath);
+    Serial.println("Converted " + textPath + " to record store (" + String(out.size()) + " entries)");
+  }
+}
+
+static bool isKnownOS(const String& os) {
+  if (os == "Windows" || os == "MacOS" || os == "Linux") return true;
+  for (const auto& name : customOS) {
+    if (name == os) return true;
+  }
+  return false;
+}
+
+// Parses an OS's snapshots into a fresh profile
+static void loadOS(OSConfig& config, const String& os) {
+  config = OSConfig();
+  config.os = os;
+  config.actionsJsonValid = false;
+  config.scriptsJsonValid = false;
+  config.actionsDirty = false;
+  config.scriptsDirty = false;
+
+  std::vector<StoredRecord> records;
+  loadRecords(getQuickActionsFilename(os), false, records);
+  for (const auto& record : records) config.actions.push_back(toAction(record));
+  loadRecords(getQuickScriptsFilename(os), true, records);
+  for (const auto& record : records) config.scripts.push_back(toScript(record));
+}
+
+// Index of the cached profile for os, -1 if it isn't cached
+static int findOS(const String& os) {
+  for (size_t i = 0; i < osConfigs.size(); i++) {
+    if (osConfigs[i].os == os) return i;
+  }
+  return -1;
+}
+
+// Profile to edit, loaded on first use. Only edits add profiles, so
+// requests naming arbitrary OSes can't push real ones out. -1 when the
+// cache is full of profiles that must stay.
+static int openOS(const String& os) {
+  int index = findOS(os);
+  if (index >= 0) return index;
+
+  // Entries with edits not yet in a snapshot must stay
+  if (osConfigs.size() >= CONFIG_CACHE_MAX_OS) {
+    for (size_t i = 0; i < osConfigs.size(); i++) {
+      if (!isKnownOS(osConfigs[i].os) && !osConfigs[i].actionsDirty && !osConfigs[i].scriptsDirty) {
+        osConfigs.erase(osConfigs.begin() + i);
+        break;
+      }
+    }
+    if (osConfigs.size() >= CONFIG_CACHE_MAX_OS) {
+      Serial.println("Config cache full, can't edit " + os);
+      return -1;
+    }
+  }
+
+  // The read-only copy may be older than what gets edited from now on
+  if (uncachedOS.os == os) uncachedOS.os = "";
+
+  osConfigs.emplace_back();
+  loadOS(osConfigs.back(), os);
+  return osConfigs.size() - 1;
+}
+
+// Profile to read. An OS that isn't cached is loaded into a single spare
+// slot instead, which the next uncached read reuses.
+static OSConfig& readOS(const String& os) {
+  int index = findOS(os);
+  if (index >= 0) return osConfigs[index];
+  if (uncachedOS.os != os || os.length() == 0) loadOS(uncachedOS, os);
+  return uncachedOS;
+}
+
+static void actionsChanged(OSConfig& config) {
+  config.actionsJsonValid = false;
+  config.actionsDirty = true;
+  configVersion++;
+}
+
+static void scriptsChanged(OSConfig& config) {
+  config.scriptsJsonValid = false;
+  config.scriptsDirty = true;
+  configVersion++;
+}
+
+static void customOSChanged() {
+  customOSJsonValid = false;
+  customOSDirty = true;
+  configVersion++;
+}
+
+// In-memory edits, shared by the public functions and journal replay
+
+static bool applyPutAction(OSConfig& config, const QuickAction& action) {
+  // Saving an existing cmd updates it where it is
+  for (auto& existing : config.actions) {
+    if (existing.cmd == action.cmd) {
+      existing = action;
+      actionsChanged(config);
+      return true;
+    }
+  }
+  if (config.actions.size() >= RECORD_STORE_MAX) return false;
+  config.actions.push_back(action);
+  actionsChanged(config);
+  return true;
+}
+
+static bool applyDeleteAction(OSConfig& config, const String& cmd) {
+  for (size_t i = 0; i < config.actions.size(); i++) {
+    if (config.actions[i].cmd == cmd) {
+      config.actions.erase(config.actions.begin() + i);
+      actionsChanged(config);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Buckets of the cmd index built for a reorder (power of two, >= 2x the
+// most actions an OS can have)
+#define ORDER_BUCKETS 128
+static_assert(ORDER_BUCKETS >= 2 * RECORD_STORE_MAX, "ORDER_BUCKETS too small for RECORD_STORE_MAX");
+
+// FNV-1a, as the route index uses
+static uint32_t hashCmd(const String& cmd) {
+  uint32_t h = 2166136261u;
+  for (const char* s = cmd.c_str(); *s; s++) {
+    h = (h ^ (uint8_t)*s) * 16777619u;
+  }
+  return h;
+}
+
+// One pass to index the actions by cmd, one to look up the order: O(n+m)
+// instead of a scan of every action per entry
+static void applyOrderActions(OSConfig& config, const std::vector<String>& order) {
+  uint8_t buckets[ORDER_BUCKETS] = {};  // Action index + 1, 0 = empty
+  size_t count = min(config.actions.size(), (size_t)ORDER_BUCKETS - 1);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t slot = hashCmd(config.actions[i].cmd) & (ORDER_BUCKETS - 1);
+    bool taken = false;  // A repeated cmd keeps its first action
+    while (buckets[slot] != 0 && !taken) {
+      taken = config.actions[buckets[slot] - 1].cmd == config.actions[i].cmd;
+      slot = (slot + 1) & (ORDER_BUCKETS - 1);
+    }
+    if (!taken) buckets[slot] = i + 1;
+  }
+
+  std::vector<QuickAction> reordered;
+  reordered.reserve(order.size());
+  for (const auto& cmd : order) {
+    uint32_t slot = hashCmd(cmd) & (ORDER_BUCKETS - 1);
+    while (buckets[slot] != 0) {
+      const QuickAction& action = config.actions[buckets[slot] - 1];
+      if (action.cmd == cmd) {
+        reordered.push_back(action);
+        break;
+      }
+      slot = (slot + 1) & (ORDER_BUCKETS - 1);
+    }
+  }
+  config.actions.swap(reordered);
+  actionsChanged(config);
+}
+
+static bool applyPutScript(OSConfig& config, const QuickScript& script) {
+  for (auto& existing : config.scripts) {
+    if (existing.id == script.id) {
+      existing = script;
+      scriptsChanged(config);
+      return true;
+    }
+  }
+  if (config.scripts.size() >= RECORD_STORE_MAX) return false;
+  config.scripts.push_back(script);
+  scriptsChanged(config);
+  return true;
+}
+
+static bool applyDeleteScript(OSConfig& config, const String& id) {
+  for (size_t i = 0; i < config.scripts.size(); i++) {
+    if (config.scripts[i].id == id) {
+      config.scripts.erase(config.scripts.begin() + i);
+      scriptsChanged(config);
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool applyAddOS(const String& name) {
+  for (const auto& existing : customOS) {
+    if (existing == name) return false;
+  }
+  customOS.push_back(name);
+  customOSChanged();
+  return true;
+}
+
+static bool applyDeleteOS(const String& name) {
+  for (size_t i = 0; i < customOS.size(); i++) {
+    if (customOS[i] == name) {
+      customOS.erase(customOS.begin() + i);
+      customOSChanged();
+      return true;
+    }
+  }
+  return false;
+}
+
+static void replayEntry(uint8_t op, const std::vector<String>& args) {
+  if (args.empty()) return;
+
+  // Entries for an OS that can't be cached are skipped
+  int index = -1;
+  if (op != JOURNAL_ADD_OS && op != JOURNAL_DELETE_OS) {
+    index = openOS(args[0]);
+    if (index < 0) return;
+  }
+
+  switch (op) {
+    case JOURNAL_PUT_ACTION:
+      if (args.size() == 5) applyPutAction(osConfigs[index], { args[1], args[2], args[3], args[4] });
+      break;
+    case JOURNAL_DELETE_ACTION:
+      if (args.size() == 2) applyDeleteAction(osConfigs[index], args[1]);
+      break;
+    case JOURNAL_CLEAR_ACTIONS:
+      osConfigs[index].actions.clear();
+      actionsChanged(osConfigs[index]);
+      break;
+    case JOURNAL_ORDER_ACTIONS:
+      applyOrderActions(osConfigs[index], std::vector<String>(args.begin() + 1, args.end()));
+      break;
+    case JOURNAL_PUT_SCRIPT:
+      if (args.size() == 5) applyPutScript(osConfigs[index], { args[1], args[2], args[3], args[4] });
+      break;
+    case JOURNAL_DELETE_SCRIPT:
+      if (args.size() == 2) applyDeleteScript(osConfigs[index], args[1]);
+      break;
+    case JOURNAL_CLEAR_SCRIPTS:
+      osConfigs[index].scripts.clear();
+      scriptsChanged(osConfigs[index]);
+      break;
+    case JOURNAL_ADD_OS:
+      applyAddOS(args[0]);
+      break;
+    case JOURNAL_DELETE_OS:
+      applyDeleteOS(args[0]);
+      break;
+  }
+}
+
+// Writes every list changed since the last snapshot, then drops the
+// journal. Each snapshot replaces its file atomically, and replaying the
+// journal over newer snapshots ends in the same state, so a power loss
+// at any point here loses nothing.
+static bool compactConfig() {
+  size_t total = 0;
+  size_t written = 0;
+  bool ok = true;
+
+  for (auto& config : osConfigs) {
+    if (config.actionsDirty) {
+      RecordStore store(storePath(getQuickActionsFilename(config.os)));
+      if (config.actions.empty()) {
+        store.erase();
+        config.actionsDirty = false;
+      } else {
+        std::vector<StoredRecord> records;
+        for (const auto& action : config.actions) records.push_back(fromAction(action));
+        if (store.rewrite(records, &written)) {
+          config.actionsDirty = false;
+          total += written;
+        } else {
+          ok = false;
+        }
+      }
+    }
+    if (config.scriptsDirty) {
+      RecordStore store(storePath(getQuickScriptsFilename(config.os)));
+      if (config.scripts.empty()) {
+        store.erase();
+        config.scriptsDirty = false;
+      } else {
+        std::vector<StoredRecord> records;
+        for (const auto& script : config.scripts) records.push_back(fromScript(script));
+        if (store.rewrite(records, &written)) {
+          config.scriptsDirty = false;
+          total += written;
+        } else {
+          ok = false;
+        }
+      }
+    }
+  }
+
+  if (customOSDirty) {
+    bool saved = writeFileLines(CUSTOM_OS_FILE, [](BufferedFileWriter& writer) {
+      for (const auto& name : customOS) {
+        writer.print(name + "\n");
+      }
+    }, &written);
+    if (saved) {
+      customOSDirty = false;
+      total += written;
+    } else {
+      ok = false;
+    }
+  }
+
+  // A failed snapshot keeps the journal so nothing is lost; retried later
+  if (!ok) {
+    Serial.println("Config compaction failed");
+    return false;
+  }
+  resetJournal(total);
+  Serial.println("Config compacted: " + String(total) + " bytes of snapshots");
+  return true;
+}
+
+// Appends one edit; the in-memory change has already been made
+static bool journal(uint8_t op, const std::vector<String>& args) {
+  if (appendJournal(op, args)) return true;
+  // Can't append (e.g. a torn tail we couldn't clear): fall back to snapshots
+  return compactConfig();
+}
+
+// Put a list back as it was before an edit that couldn't be saved, so
+// nothing reported as failed is shown or persisted later. The list stays
+// dirty: a compaction that failed part way may have written the edit.
+static void undoActions(OSConfig& config, std::vector<QuickAction>& before) {
+  config.actions.swap(before);
+  actionsChanged(config);
+  Serial.println("Quick action edit for " + config.os + " not saved, undone");
+}
+
+static void undoScripts(OSConfig& config, std::vector<QuickScript>& before) {
+  config.scripts.swap(before);
+  scriptsChanged(config);
+  Serial.println("Quick script edit for " + config.os + " not saved, undone");
+}
+
+static void undoCustomOS(std::vector<String>& before) {
+  customOS.swap(before);
+  customOSChanged();
+  Serial.println("Custom OS edit not saved, undone");
+}
+
+void setupConfigCache() {
+  osConfigs.clear();
+  osConfigs.reserve(CONFIG_CACHE_MAX_OS);
+  uncachedOS = OSConfig();
+  customOS.clear();
+  customOSJsonValid = false;
+  customOSDirty = false;
+
+  if (!storageAvailable || !storageFS) return;
+
+  recoverFileLines(CUSTOM_OS_FILE);
+  forEachFileLine(CUSTOM_OS_FILE, [](const String& line) {
+    customOS.push_back(line);
+  });
+
+  const char* builtIn[] = { "Windows", "MacOS", "Linux" };
+  for (const char* os : builtIn) {
+    openOS(os);
+  }
+  for (const auto& os : customOS) {
+    openOS(os);
+  }
+
+  // Edits made after the last snapshot. A torn tail entry can't be appended
+  // after, so fold everything into fresh snapshots right away.
+  if (!replayJournal(replayEntry)) {
+    compactConfig();
+  }
+
+  Serial.println("Config cache loaded: " + String(osConfigs.size()) + " OS profiles");
+}
+
+void handleConfigCache() {
+  if (getJournalSize() < CONFIG_JOURNAL_COMPACT_BYTES) return;
+  // A full or failing card would otherwise be rewritten on every loop
+  if (compactBackoffMs && (int32_t)(millis() - compactRetryAt) < 0) return;
+
+  if (compactConfig()) {
+    compactBackoffMs = 0;
+  } else {
+    compactBackoffMs = compactBackoffMs ? min(compactBackoffMs * 2, (uint32_t)CONFIG_COMPACT_RETRY_MAX_MS)
+                                        : CONFIG_COMPACT_RETRY_MS;
+    compactRetryAt = millis() + compactBackoffMs;
+    Serial.println("Config compaction retry in " + String(compactBackoffMs / 1000) + "s");
+  }
+}
+
+uint32_t getConfigVersion() {
+  return configVersion;
+}
+
+const std::vector<QuickAction>& getQuickActions(const String& os) {
+  return readOS(os).actions;
+}
+
+const std::vector<QuickScript>& getQuickScripts(const String& os) {
+  return readOS(os).scripts;
+}
+
+const String& getQuickActionsJson(const String& os) {
+  OSConfig& config = readOS(os);
+  if (!config.actionsJsonValid) {
+    String json = "[";
+    for (size_t i = 0; i < config.actions.size(); i++) {
+      const QuickAction& action = config.actions[i];
+      if (i > 0) json += ",";
+      json += "{";
+      json += "\"cmd\":\"" + escapeJson(action.cmd) + "\",";
+      json += "\"label\":\"" + escapeJson(action.label) + "\",";
+      json += "\"desc\":\"" + escapeJson(action.desc) + "\",";
+      json += "\"class\":\"" + escapeJson(action.btnClass) + "\"";
+      json += "}";
+    }
+    json += "]";
+    config.actionsJson = json;
+    config.actionsJsonValid = true;
+  }
+  return config.actionsJson;
+}
+
+const String& getQuickScriptsJson(const String& os) {
+  OSConfig& config = readOS(os);
+  if (!config.scriptsJsonValid) {
+    String json = "[";
+    for (size_t i = 0; i < config.scripts.size(); i++) {
+      const QuickScript& script = config.scripts[i];
+      if (i > 0) json += ",";
+      json += "{";
+      json += "\"id\":\"" + escapeJson(script.id) + "\",";
+      json += "\"label\":\"" + escapeJson(script.label) + "\",";
+      json += "\"script\":\"" + escapeJson(script.script) + "\",";
+      json += "\"class\":\"" + escapeJson(script.btnClass) + "\"";
+      json += "}";
+    }
+    json += "]";
+    config.scriptsJson = json;
+    config.scriptsJsonValid = true;
+  }
+  return config.scriptsJson;
+}
+
+const String& getCustomOSJson() {
+  if (!customOSJsonValid) {
+    String json = "[";
+    for (size_t i = 0; i < customOS.size(); i++) {
+      if (i > 0) json += ",";
+      json += "\"" + escapeJson(customOS[i]) + "\"";
+    }
+    json += "]";
+    customOSJson = json;
+    customOSJsonValid = true;
+  }
+  return customOSJson;
+}
+
+// Quick Actions Management Functions
+
+bool saveQuickAction(String os, String cmd, String label, String desc, String btnClass) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for saving quick action");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickAction> before = config.actions;
+  if (!applyPutAction(config, { cmd, label, desc, btnClass })) {
+    Serial.println("Too many quick actions for " + os);
+    return false;
+  }
+  if (!journal(JOURNAL_PUT_ACTION, { os, cmd, label, desc, btnClass })) {
+    undoActions(config, before);
+    return false;
+  }
+
+  Serial.println("Quick action saved for " + os + ": " + cmd);
+  return true;
+}
+
+bool deleteQuickAction(String os, String cmd) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for deleting quick action");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickAction> before = config.actions;
+  if (!applyDeleteAction(config, cmd)) return false;
+  if (!journal(JOURNAL_DELETE_ACTION, { os, cmd })) {
+    undoActions(config, before);
+    return false;
+  }
+
+  Serial.println("Quick action deleted from " + os + ": " + cmd);
+  return true;
+}
+
+bool deleteAllQuickActions(String os) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0 || osConfigs[index].actions.empty()) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickAction> before;
+  before.swap(config.actions);
+  actionsChanged(config);
+  if (!journal(JOURNAL_CLEAR_ACTIONS, { os })) {
+    undoActions(config, before);
+    return false;
+  }
+
+  Serial.println("All quick actions deleted for: " + os);
+  return true;
+}
+
+bool reorderQuickActions(String os, const std::vector<String>& order) {
+  int index = openOS(os);
+  if (index < 0 || osConfigs[index].actions.empty()) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickAction> before = config.actions;
+
+  applyOrderActions(config, order);
+
+  std::vector<String> args;
+  args.push_back(os);
+  args.insert(args.end(), order.begin(), order.end());
+  if (!journal(JOURNAL_ORDER_ACTIONS, args)) {
+    undoActions(config, before);
+    return false;
+  }
+  return true;
+}
+
+// Custom OS Management Functions
+
+const std::vector<String>& getCustomOSList() {
+  return customOS;
+}
+
+std::vector<String> getOSNames() {
+  std::vector<String> names = { "Windows", "MacOS", "Linux" };
+  names.insert(names.end(), customOS.begin(), customOS.end());
+  return names;
+}
+
+bool addCustomOS(String osName) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for saving custom OS");
+    return false;
+  }
+
+  std::vector<String> before = customOS;
+  if (!applyAddOS(osName)) return true;  // Already exists
+  if (!journal(JOURNAL_ADD_OS, { osName })) {
+    undoCustomOS(before);
+    return false;
+  }
+
+  Serial.println("Custom OS added: " + osName);
+  return true;
+}
+
+bool deleteCustomOS(String osName) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for deleting custom OS");
+    return false;
+  }
+
+  std::vector<String> before = customOS;
+  if (!applyDeleteOS(osName)) return false;
+  if (!journal(JOURNAL_DELETE_OS, { osName })) {
+    undoCustomOS(before);
+    return false;
+  }
+
+  // Also delete all quick actions for this OS
+  deleteAllQuickActions(osName);
+
+  Serial.println("Custom OS deleted: " + osName);
+  return true;
+}
+
+// Quick Scripts Management Functions
+
+bool saveQuickScript(String os, String id, String label, String script, String btnClass) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for saving quick script");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickScript> before = config.scripts;
+  if (!applyPutScript(config, { id, label, script, btnClass })) {
+    Serial.println("Too many quick scripts for " + os);
+    return false;
+  }
+  if (!journal(JOURNAL_PUT_SCRIPT, { os, id, label, script, btnClass })) {
+    undoScripts(config, before);
+    return false;
+  }
+
+  Serial.println("Quick script saved for " + os + ": " + id);
+  return true;
+}
+
+bool deleteQuickScript(String os, String id) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for deleting quick script");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickScript> before = config.scripts;
+  if (!applyDeleteScript(config, id)) return false;
+  if (!journal(JOURNAL_DELETE_SCRIPT, { os, id })) {
+    undoScripts(config, before);
+    return false;
+  }
+
+  Serial.println("Quick script deleted from " + os + ": " + id);
+  return true;
+}
+
+bool deleteAllQuickScripts(String os) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available");
+    return false;
+  }
+
+  int index = openOS(os);
+  if (index < 0 || osConfigs[index].scripts.empty()) return false;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickScript> before;
+  before.swap(config.scripts);
+  scriptsChanged(config);
+  if (!journal(JOURNAL_CLEAR_SCRIPTS, { os })) {
+    undoScripts(config, before);
+    return false;
+  }
+
+  Serial.println("All quick scripts deleted for: " + os);
+  return true;
+}
+
+// Text import/export in the old pipe-delimited format
+
+String exportQuickActionsText(String os) {
+  std::vector<StoredRecord> records;
+  for (const auto& action : readOS(os).actions) records.push_back(fromAction(action));
+  return formatTextRecords(records, false);
+}
+
+String exportQuickScriptsText(String os) {
+  std::vector<StoredRecord> records;
+  for (const auto& script : readOS(os).scripts) records.push_back(fromScript(script));
+  return formatTextRecords(records, true);
+}
+
+// Imports replace a whole list, so they go straight to a snapshot
+
+int importQuickActionsText(String os, const String& text) {
+  if (!storageAvailable || !storageFS) return -1;
+
+  std::vector<StoredRecord> records;
+  parseTextRecords(text, false, records);
+
+  int index = openOS(os);
+  if (index < 0) return -1;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickAction> before;
+  before.swap(config.actions);
+  for (const auto& record : records) config.actions.push_back(toAction(record));
+  actionsChanged(config);
+  if (!compactConfig()) {
+    undoActions(config, before);
+    return -1;
+  }
+
+  Serial.println("Imported " + String(records.size()) + " quick actions for " + os);
+  return records.size();
+}
+
+int importQuickScriptsText(String os, const String& text) {
+  if (!storageAvailable || !storageFS) return -1;
+
+  std::vector<StoredRecord> records;
+  parseTextRecords(text, true, records);
+
+  int index = openOS(os);
+  if (index < 0) return -1;
+  OSConfig& config = osConfigs[index];
+  std::vector<QuickScript> before;
+  before.swap(config.scripts);
+  for (const auto& record : records) config.scripts.push_back(toScript(record));
+  scriptsChanged(config);
+  if (!compactConfig()) {
+    undoScripts(config, before);
+    return -1;
+  }
+
+  Serial.println("Imported " + String(records.size()) + " quick scripts for " + os);
+  return records.size();
+}
@@ -0,0 +1,72 @@
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Parsed quick actions, quick scripts and custom OS names, kept in RAM.
+// Reads never touch storage. Each change is appended to the config journal;
+// the lists are written out as snapshots (a RecordStore per OS and list,
+// a text file for custom OS names) only when the journal is compacted.
+
+struct QuickAction {
+  String cmd;
+  String label;
+  String desc;
+  String btnClass;
+};
+
+struct QuickScript {
+  String id;
+  String label;
+  String script;
+  String btnClass;
+};
+
+// Loads the custom OS list and the actions/scripts of every known OS,
+// then replays the journal on top
+void setupConfigCache();
+// Compacts the journal once it has grown; call from loop()
+void handleConfigCache();
+
+// Bumped on every change; used as the ETag of the list endpoints
+uint32_t getConfigVersion();
+
+// JSON arrays as served by the list endpoints, rebuilt only after a change
+const String& getQuickActionsJson(const String& os);
+const String& getQuickScriptsJson(const String& os);
+const String& getCustomOSJson();
+
+// Reading an OS never adds it to the cache; only edits do. Returned
+// references stay valid until the next edit.
+const std::vector<QuickAction>& getQuickActions(const String& os);
+const std::vector<QuickScript>& getQuickScripts(const String& os);
+
+// Quick actions management
+bool saveQuickAction(String os, String cmd, String label, String desc, String btnClass);
+bool deleteQuickAction(String os, String cmd);
+bool deleteAllQuickActions(String os);
+// Reorders by cmd; actions missing from the list are dropped, as before
+bool reorderQuickActions(String os, const std::vector<String>& order);
+
+// Custom OS management
+const std::vector<String>& getCustomOSList();
+// Built-in OS names followed by the custom ones
+std::vector<String> getOSNames();
+bool addCustomOS(String osName);
+bool deleteCustomOS(String osName);
+
+// Quick scripts management
+bool saveQuickScript(String os, String id, String label, String script, String btnClass);
+bool deleteQuickScript(String os, String id);
+bool deleteAllQuickScripts(String os);
+
+// Import/export in the "key|label|text|class" line format of older
+// firmware. Import replaces the OS's entries and returns how many were
+// read, or -1 on a storage error.
+String exportQuickActionsText(String os);
+String exportQuickScriptsText(String os);
+int importQuickActionsText(String os, const String& text);
+int importQuickScriptsText(String os, const String& text);
+
+#endif //CONFIG_CACHE_H
@@ -0,0 +1,135 @@
+#include "config_journal.h"
+#include <esp_rom_crc.h>
+#include "config.h"
+#include "littlefs_manager.h"
+#include "buffered_file.h"
+
+#define JOURNAL_MAGIC 0x4A43  // "CJ"
+#define JOURNAL_MAX_ENTRY 0x20000
+
+struct JournalEntryHeader {
+  uint16_t magic;
+  uint8_t op;
+  uint8_t argc;
+  uint32_t length;  // Payload bytes
+  uint32_t crc;     // CRC32 of op, argc and payload
+};
+
+static size_t journalSize = 0;
+static JournalStats stats = { 0, 0, 0, 0, 0 };
+
+static uint32_t entryCrc(uint8_t op, uint8_t argc, const uint8_t* payload, size_t len) {
+  uint8_t head[2] = { op, argc };
+  uint32_t crc = esp_rom_crc32_le(0, head, sizeof(head));
+  return esp_rom_crc32_le(crc, payload, len);
+}
+
+bool appendJournal(uint8_t op, const std::vector<String>& args) {
+  if (!storageAvailable || !storageFS || args.size() > 255) return false;
+
+  // Header and payload go out in a single write
+  std::vector<uint8_t> entry(sizeof(JournalEntryHeader));
+  size_t logical = 0;
+  for (const auto& arg : args) {
+    // Lengths are 16 bit; a longer field would be replayed cut short
+    size_t len = arg.length();
+    if (len > 0xFFFF) {
+      Serial.println("Config journal field too long: " + String(len) + " bytes");
+      return false;
+    }
+    entry.push_back(len & 0xFF);
+    entry.push_back(len >> 8);
+    entry.insert(entry.end(), arg.c_str(), arg.c_str() + len);
+    logical += len;
+  }
+
+  JournalEntryHeader header;
+  header.magic = JOURNAL_MAGIC;
+  header.op = op;
+  header.argc = args.size();
+  header.length = entry.size() - sizeof(header);
+  if (header.length > JOURNAL_MAX_ENTRY) return false;
+  header.crc = entryCrc(op, header.argc, entry.data() + sizeof(header), header.length);
+  memcpy(entry.data(), &header, sizeof(header));
+
+  File file = storageFS->open(CONFIG_JOURNAL_FILE, "a");
+  if (!file) {
+    Serial.println("Failed to open config journal");
+    return false;
+  }
+  bool ok = file.write(entry.data(), entry.size()) == entry.size();
+  file.close();
+  if (!ok) return false;
+
+  journalSize += entry.size();
+  stats.edits++;
+  stats.logicalBytes += logical;
+  stats.journalBytes += entry.size();
+  return true;
+}
+
+bool replayJournal(JournalReplayFn fn) {
+  journalSize = 0;
+  if (!storageAvailable || !storageFS || !storageFS->exists(CONFIG_JOURNAL_FILE)) return true;
+
+  File file = storageFS->open(CONFIG_JOURNAL_FILE, "r");
+  if (!file) return false;
+
+  size_t fileSize = file.size();
+  size_t entries = 0;
+  bool clean = true;
+  {
+    BufferedFileReader reader(file);
+    std::vector<uint8_t> payload;
+    std::vector<String> args;
+    while (reader.position() < fileSize) {
+      JournalEntryHeader header;
+      if (reader.readBytes((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+          header.magic != JOURNAL_MAGIC || header.length > JOURNAL_MAX_ENTRY) {
+        clean = false;
+        break;
+      }
+      payload.resize(header.length);
+      if (reader.readBytes(payload.data(), header.length) != header.length ||
+          entryCrc(header.op, header.argc, payload.data(), header.length) != header.crc) {
+        clean = false;
+        break;
+      }
+
+      args.clear();
+      size_t pos = 0;
+      for (int i = 0; i < header.argc && pos + 2 <= payload.size(); i++) {
+        size_t len = payload[pos] | (payload[pos + 1] << 8);
+        pos += 2;
+        String arg;
+        arg.concat((const char*)payload.data() + pos, min(len, payload.size() - pos));
+        args.push_back(arg);
+        pos += len;
+      }
+      if (args.size() == header.argc) fn(header.op, args);
+
+      journalSize = reader.position();
+      entries++;
+    }
+  }
+  file.close();
+
+  Serial.println("Config journal: replayed " + String(entries) + " entries" + (clean ? "" : " (torn tail dropped)"));
+  return clean;
+}
+
+bool resetJournal(size_t snapshotBytes) {
+  stats.snapshotBytes += snapshotBytes;
+  stats.compactions++;
+  journalSize = 0;
+  if (!storageAvailable || !storageFS || !storageFS->exists(CONFIG_JOURNAL_FILE)) return true;
+  return storageFS->remove(CONFIG_JOURNAL_FILE);
+}
+
+size_t getJournalSize() {
+  return journalSize;
+}
+
+const JournalStats& getJournalStats() {
+  return stats;
+}
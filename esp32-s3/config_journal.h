@@ -0,0 +1,46 @@
+#ifndef CONFIG_JOURNAL_H
+#define CONFIG_JOURNAL_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Append-only journal of config edits. Each edit appends one small
+// CRC-checked entry instead of rewriting the file it changes; the
+// entries are replayed on boot and folded into snapshots once the
+// journal reaches CONFIG_JOURNAL_COMPACT_BYTES.
+
+enum JournalOp : uint8_t {
+  JOURNAL_PUT_ACTION = 1,    // os, cmd, label, desc, class
+  JOURNAL_DELETE_ACTION,     // os, cmd
+  JOURNAL_CLEAR_ACTIONS,     // os
+  JOURNAL_ORDER_ACTIONS,     // os, cmd...
+  JOURNAL_PUT_SCRIPT,        // os, id, label, script, class
+  JOURNAL_DELETE_SCRIPT,     // os, id
+  JOURNAL_CLEAR_SCRIPTS,     // os
+  JOURNAL_ADD_OS,            // name
+  JOURNAL_DELETE_OS          // name
+};
+
+typedef void (*JournalReplayFn)(uint8_t op, const std::vector<String>& args);
+
+struct JournalStats {
+  uint32_t edits;          // Entries appended since boot
+  uint32_t logicalBytes;   // Bytes of data those edits carried
+  uint32_t journalBytes;   // Bytes appended to the journal
+  uint32_t snapshotBytes;  // Bytes written by compaction
+  uint32_t compactions;
+};
+
+bool appendJournal(uint8_t op, const std::vector<String>& args);
+
+// Calls fn for every entry in order. Stops at the first torn or corrupt
+// entry (an append cut short by a power loss) and returns false then.
+bool replayJournal(JournalReplayFn fn);
+
+// Drops the journal once its entries are safely in the snapshots
+bool resetJournal(size_t snapshotBytes);
+
+size_t getJournalSize();
+const JournalStats& getJournalStats();
+
+#endif //CONFIG_JOURNAL_H
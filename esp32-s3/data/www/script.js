@@ -14,6 +14,13 @@ let jigglerEnabled = false;
       }
     }
 
+    // log() renders HTML; text coming from the device must be escaped first
+    function escapeHtml(text) {
+      const div = document.createElement('div');
+      div.textContent = text;
+      return div.innerHTML;
+    }
+
     function sendCommand(cmd) {
       fetch('/api/command', {
         method: 'POST',
@@ -29,6 +36,40 @@ let jigglerEnabled = false;
       });
     }
 
+    // Runs several commands in one request, in order, through /api/commands
+    function sendCommands(cmds, stepDelay) {
+      if (cmds.length === 0) return;
+      if (cmds.length === 1 && !stepDelay) {
+        sendCommand(cmds[0]);
+        return;
+      }
+
+      let body = 'cmds=' + encodeURIComponent(JSON.stringify(cmds));
+      if (stepDelay) {
+        body += '&delay=' + encodeURIComponent(stepDelay);
+      }
+
+      fetch('/api/commands', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },
+        body: body
+      })
+      .then(response => response.json())
+      .then(data => {
+        if (data.status !== 'ok') {
+          log('Error: ' + data.message);
+          return;
+        }
+        log('Commands sent: ' + cmds.join(', '));
+        data.steps.forEach(step => {
+          if (!step.ok) log('Command failed: ' + step.cmd);
+        });
+      })
+      .catch(error => {
+        log('Error: ' + error);
+      });
+    }
+
     function toggleJiggler() {
       jigglerEnabled = !jigglerEnabled;
       const toggle = document.getElementById('jigglerToggle');
@@ -319,20 +360,7 @@ let jigglerEnabled = false;
     function loadDeviceStatus() {
       fetch('/api/status')
         .then(response => response.json())
-        .then(data => {
-          document.getElementById('deviceIP').textContent = data.ip || 'Unknown';
-          document.getElementById('wifiMode').textContent = data.wifi_mode || 'Unknown';
-          document.getElementById('networkSSID').textContent = data.ssid || 'Unknown';
-
-          // Update status badge
-          if (data.connected) {
-            document.getElementById('statusBadge').textContent = 'Connected';
-            document.getElementById('statusBadge').style.background = '#10b981';
-          } else {
-            document.getElementById('statusBadge').textContent = 'AP Mode';
-            document.getElementById('statusBadge').style.background = '#f59e0b';
-          }
-        })
+        .then(data => applyDeviceStatus(data))
         .catch(error => {
           log('Error loading device status: ' + error);
           document.getElementById('deviceIP').textContent = 'Error';
@@ -341,6 +369,74 @@ let jigglerEnabled = false;
         });
     }
 
+    function applyDeviceStatus(data) {
+      if (!document.getElementById('deviceIP')) return;
+      document.getElementById('deviceIP').textContent = data.ip || 'Unknown';
+      document.getElementById('wifiMode').textContent = data.wifi_mode || 'Unknown';
+      document.getElementById('networkSSID').textContent = data.ssid || 'Unknown';
+
+      // Update status badge
+      if (data.connected) {
+        document.getElementById('statusBadge').textContent = 'Connected';
+        document.getElementById('statusBadge').style.background = '#10b981';
+      } else {
+        document.getElementById('statusBadge').textContent = 'AP Mode';
+        document.getElementById('statusBadge').style.background = '#f59e0b';
+      }
+
+      if (typeof data.jiggler === 'boolean') {
+        applyJigglerState(data.jiggler);
+      }
+    }
+
+    // Reflect jiggler state changed from another tab or the device itself
+    function applyJigglerState(enabled) {
+      const toggle = document.getElementById('jigglerToggle');
+      if (!toggle) return;
+      jigglerEnabled = enabled;
+      toggle.classList.toggle('active', enabled);
+      document.getElementById('jigglerStatus').textContent = enabled ? 'Enabled' : 'Disabled';
+    }
+
+    // Subscribe to device events instead of polling. EventSource reconnects on
+    // its own and resumes with Last-Event-ID, so missed events are replayed.
+    function startEventStream() {
+      if (typeof EventSource === 'undefined') return;
+      const events = new EventSource('/api/events');
+
+      events.addEventListener('status', e => applyDeviceStatus(JSON.parse(e.data)));
+      events.addEventListener('jiggler', e => applyJigglerState(JSON.parse(e.data).enabled));
+      events.addEventListener('activity', e => {
+        if (document.getElementById('activityLog')) {
+          log('Device: ' + escapeHtml(JSON.parse(e.data).message));
+        }
+      });
+      events.addEventListener('config', e => {
+        const changed = JSON.parse(e.data).changed;
+        if (!document.getElementById('osSelect')) return;
+        if (changed === 'customos') {
+          loadCustomOS();
+        } else {
+          updateQuickActions();
+          loadQuickScripts();
+        }
+      });
+      events.addEventListener('storage', e => {
+        const changed = JSON.parse(e.data).changed;
+        if (changed === 'scripts' && document.getElementById('savedScriptsList')) {
+          loadSavedScripts();
+        }
+        if (typeof loadFilesystemStatus === 'function') {
+          loadFilesystemStatus();
+        }
+      });
+      // The device dropped events we never saw; reload everything
+      events.addEventListener('reset', () => {
+        loadDeviceStatus();
+        if (document.getElementById('savedScriptsList')) loadSavedScripts();
+      });
+    }
+
     // Trackpad functionality
     function initTrackpad(prefix = '') {
       const trackpad = document.getElementById(prefix + 'trackpad');
@@ -927,7 +1023,21 @@ let jigglerEnabled = false;
 
     // Note: Event listeners for manage pages are set up in their respective inline scripts
 
+    // Exchange the browser's Basic credentials for a session cookie once per tab,
+    // so later requests are checked against the device's session table instead
+    function startSession() {
+      if (sessionStorage.getItem('hidSession')) return;
+      fetch('/api/login', { method: 'POST' })
+        .then(response => {
+          if (response.ok) sessionStorage.setItem('hidSession', '1');
+        })
+        .catch(error => {
+          console.error('Session login failed:', error);
+        });
+    }
+
     // Initial log and setup
+    startSession();
     log('Interface loaded - Ready to use');
 
     // Load custom OS, then restore selected OS
@@ -938,6 +1048,7 @@ let jigglerEnabled = false;
     // Load other content
     loadSavedScripts();
     loadDeviceStatus();
+    startEventStream();
 
     // Note: Quick actions and scripts are loaded from within loadSelectedOS() after OS is properly set
 
@@ -1217,12 +1328,12 @@ let jigglerEnabled = false;
           status.style.color = '#6b7280';
           indicator.classList.remove('active');
           log('Keyboard capture DISABLED');
-          window.releaseAllKeys();
 
-          // Release all pressed modifiers
+          // Release all keys and pressed modifiers in a single request
+          const releaseCmds = ['KEY_RELEASE_ALL'];
           for (let key in pressedModifiers) {
             if (pressedModifiers[key]) {
-              sendCommand('KEY_RELEASE:' + key);
+              releaseCmds.push('KEY_RELEASE:' + key);
               pressedModifiers[key] = false;
               const btn = document.getElementById(key.toLowerCase() + 'Btn');
               if (btn) {
@@ -1231,6 +1342,9 @@ let jigglerEnabled = false;
               }
             }
           }
+          sendCommands(releaseCmds);
+          pressedKeys.clear();
+          log('All keys released');
 
           // Hide mobile input and restore ESC hint
           mobileInput.blur();
@@ -0,0 +1,123 @@
+#include "dir_listing.h"
+#include <algorithm>
+#include "config.h"
+#include "littlefs_manager.h"
+
+static DirListing cache[DIR_CACHE_SLOTS];
+
+static String normalizeDir(String path) {
+  if (!path.startsWith("/")) path = "/" + path;
+  while (path.length() > 1 && path.endsWith("/")) path.remove(path.length() - 1);
+  return path;
+}
+
+static void clearSlot(DirListing& slot) {
+  slot.valid = false;
+  slot.path = "";
+  // swap() actually releases the memory, clear() would keep the capacity
+  std::vector<DirEntry>().swap(slot.entries);
+  std::vector<char>().swap(slot.names);
+}
+
+static bool loadListing(const String& path, DirListing& listing) {
+  File root = storageFS->open(path);
+  if (!root || !root.isDirectory()) return false;
+
+  listing.entries.clear();
+  listing.names.clear();
+
+  File file = root.openNextFile();
+  while (file) {
+    // Some filesystems return the full path, others just the name
+    String name = file.name();
+    int slash = name.lastIndexOf('/');
+    if (slash >= 0) name = name.substring(slash + 1);
+
+    DirEntry entry;
+    entry.nameOffset = listing.names.size();
+    entry.nameLen = name.length();
+    entry.isDir = file.isDirectory();
+    entry.size = entry.isDir ? 0 : file.size();
+    listing.names.insert(listing.names.end(), name.c_str(), name.c_str() + name.length() + 1);
+    listing.entries.push_back(entry);
+
+    file = root.openNextFile();
+  }
+  root.close();
+
+  const char* names = listing.names.data();
+  std::sort(listing.entries.begin(), listing.entries.end(), [names](const DirEntry& a, const DirEntry& b) {
+    if (a.isDir != b.isDir) return a.isDir;
+    return strcasecmp(names + a.nameOffset, names + b.nameOffset) < 0;
+  });
+
+  listing.path = path;
+  listing.loadedAt = millis();
+  listing.valid = true;
+  return true;
+}
+
+// Evicts least recently used listings, never keep, until the cache fits
+static void trimCache(const DirListing* keep) {
+  while (true) {
+    size_t total = 0;
+    DirListing* oldest = nullptr;
+    for (auto& slot : cache) {
+      if (!slot.valid) continue;
+      total += slot.bytes();
+      if (&slot != keep && (!oldest || slot.lastUsed < oldest->lastUsed)) oldest = &slot;
+    }
+    if (total <= DIR_CACHE_MAX_BYTES || !oldest) return;
+    clearSlot(*oldest);
+  }
+}
+
+const DirListing* getDirListing(const String& requestedPath) {
+  if (!storageAvailable || !storageFS) return nullptr;
+
+  String path = normalizeDir(requestedPath);
+  uint32_t now = millis();
+
+  // Files written outside the file endpoints (scripts, config) don't
+  // invalidate anything, so cached listings also expire
+  for (auto& slot : cache) {
+    if (slot.valid && now - slot.loadedAt >= DIR_CACHE_TTL_MS) clearSlot(slot);
+  }
+
+  for (auto& slot : cache) {
+    if (slot.valid && slot.path == path) {
+      slot.lastUsed = now;
+      return &slot;
+    }
+  }
+
+  DirListing* target = nullptr;
+  for (auto& slot : cache) {
+    if (!slot.valid) {
+      target = &slot;
+      break;
+    }
+    if (!target || slot.lastUsed < target->lastUsed) target = &slot;
+  }
+  clearSlot(*target);
+
+  if (!loadListing(path, *target)) {
+    clearSlot(*target);
+    return nullptr;
+  }
+  target->lastUsed = now;
+
+  // A directory bigger than the whole budget stays until the next listing
+  trimCache(target);
+  return target;
+}
+
+void invalidateDirListing(const String& changedPath) {
+  String path = normalizeDir(changedPath);
+  int slash = path.lastIndexOf('/');
+  String parent = slash > 0 ? path.substring(0, slash) : String("/");
+
+  for (auto& slot : cache) {
+    if (slot.valid && (slot.path == path || slot.path == parent)) clearSlot(slot);
+  }
+}
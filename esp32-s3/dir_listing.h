@@ -0,0 +1,41 @@
+#ifndef DIR_LISTING_H
+#define DIR_LISTING_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Directory listings for /api/files. A listing is read once with
+// openNextFile(), sorted by name and kept in a small cache, so paging
+// through a directory with thousands of entries walks the card only once.
+// Entries are fixed-size records with the names packed into one buffer,
+// which is far smaller than a String per entry.
+
+struct DirEntry {
+  uint32_t nameOffset;  // Into DirListing::names, NUL-terminated
+  uint32_t size;
+  uint16_t nameLen;
+  bool isDir;
+};
+
+struct DirListing {
+  String path;
+  std::vector<DirEntry> entries;  // Directories first, then by name
+  std::vector<char> names;
+  uint32_t loadedAt;
+  uint32_t lastUsed;
+  bool valid;
+
+  const char* name(const DirEntry& entry) const { return names.data() + entry.nameOffset; }
+  size_t bytes() const { return entries.size() * sizeof(DirEntry) + names.size(); }
+};
+
+// Listing of a directory, from the cache while it is fresh. nullptr if
+// path is not a directory. Valid until the next call.
+const DirListing* getDirListing(const String& path);
+
+// Drops the cached listing of the directory that contains path, and of
+// path itself if it is a directory. Call after anything is created,
+// written or removed.
+void invalidateDirListing(const String& path);
+
+#endif //DIR_LISTING_H
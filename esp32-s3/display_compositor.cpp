@@ -0,0 +1,180 @@
+#include "display_compositor.h"
+#include <TFT_eSPI.h>
+#include <esp_heap_caps.h>
+#include "config.h"
+
+#define CHAR_WIDTH 6  // Built-in font at text size 1
+#define CHAR_HEIGHT 8
+
+// Drawing shared by both compositors; a TFT_eSprite is a TFT_eSPI too,
+// only the target and what a drawing call costs differ
+class TftCompositor : public Compositor {
+public:
+  explicit TftCompositor(TFT_eSPI& target) : _target(target) {}
+
+  int16_t width() override { return _target.width(); }
+  int16_t height() override { return _target.height(); }
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    _target.fillRect(x, y, w, h, color);
+    touched(x, y, w, h);
+  }
+
+  void hLine(int16_t y, uint16_t color) override {
+    _target.drawFastHLine(0, y, width(), color);
+    touched(0, y, width(), 1);
+  }
+
+  // With a background each character goes out as one 6x8 block
+  void drawText(int16_t x, int16_t y, const String& text, uint16_t color, uint16_t background) override {
+    _target.setTextSize(1);
+    _target.setTextColor(color, background);
+    _target.setCursor(x, y);
+    _target.print(text);
+    for (size_t i = 0; i < text.length(); i++) touched(x + i * CHAR_WIDTH, y, CHAR_WIDTH, CHAR_HEIGHT);
+  }
+
+protected:
+  virtual void touched(int16_t x, int16_t y, int16_t w, int16_t h) = 0;
+
+  TFT_eSPI& _target;
+};
+
+// Draws on the panel itself; every call is a blocking SPI transfer
+class DirectCompositor : public TftCompositor {
+public:
+  explicit DirectCompositor(TFT_eSPI& tft) : TftCompositor(tft), _bytes(0) {}
+
+  uint32_t present() override {
+    uint32_t bytes = _bytes;
+    _bytes = 0;
+    return bytes;
+  }
+
+  DisplayPanel* panel() override { return nullptr; }
+  const uint16_t* shownFrame() override { return nullptr; }
+
+protected:
+  void touched(int16_t x, int16_t y, int16_t w, int16_t h) override {
+    _bytes += SPI_WINDOW_BYTES + (uint32_t)w * h * 2;
+  }
+
+private:
+  uint32_t _bytes;
+};
+
+// The TFT behind TFT_eSPI's DMA channel. The SPI transaction stays open
+// until the transfer is seen to complete.
+class TftDmaPanel : public DisplayPanel {
+public:
+  explicit TftDmaPanel(TFT_eSPI& tft) : _tft(tft), _active(false), _startUs(0), _lastUs(0) {}
+
+  void pushRows(int16_t y, int16_t h, const uint16_t* rows) override {
+    waitIdle();
+    _tft.startWrite();
+    _startUs = micros();
+    _active = true;
+    _tft.pushImageDMA(0, y, _tft.width(), h, rows);
+  }
+
+  bool busy() override {
+    if (!_active) return false;
+    if (_tft.dmaBusy()) return true;
+    _lastUs = micros() - _startUs;
+    _active = false;
+    _tft.endWrite();
+    return false;
+  }
+
+  void waitIdle() override {
+    if (!_active) return;
+    _tft.dmaWait();
+    busy();
+  }
+
+  uint32_t lastTransferUs() const override { return _lastUs; }
+
+private:
+  TFT_eSPI& _tft;
+  bool _active;
+  uint32_t _startUs;
+  uint32_t _lastUs;
+};
+
+// Composes into a sprite in PSRAM. present() copies the changed rows into
+// a DMA-capable front buffer in internal RAM and starts the push, so the
+// caller is back before the pixels reach the panel. Rows are full width,
+// which keeps any band of them contiguous in both buffers.
+class SpriteCompositor : public TftCompositor {
+public:
+  SpriteCompositor(TFT_eSprite* sprite, uint16_t* frame, uint16_t* front, DisplayPanel* panel)
+    : TftCompositor(*sprite), _sprite(sprite), _frame(frame), _front(front), _panel(panel),
+      _dirtyTop(0), _dirtyBottom(0), _presented(false) {}
+
+  uint32_t present() override {
+    if (_dirtyTop >= _dirtyBottom) return 0;
+
+    // The previous push may still be reading the front buffer
+    _panel->waitIdle();
+    int16_t rows = _dirtyBottom - _dirtyTop;
+    size_t offset = (size_t)_dirtyTop * width();
+    size_t bytes = (size_t)rows * width() * 2;
+    memcpy(_front + offset, _frame + offset, bytes);
+    _panel->pushRows(_dirtyTop, rows, _front + offset);
+
+    _dirtyTop = _dirtyBottom = 0;
+    _presented = true;
+    return SPI_WINDOW_BYTES + bytes;
+  }
+
+  DisplayPanel* panel() override { return _panel; }
+  // The front buffer holds exactly what was pushed
+  const uint16_t* shownFrame() override { return _presented ? _front : nullptr; }
+
+protected:
+  void touched(int16_t x, int16_t y, int16_t w, int16_t h) override {
+    int16_t top = max((int16_t)0, y);
+    int16_t bottom = min(height(), (int16_t)(y + h));
+    if (top >= bottom) return;
+    if (_dirtyTop >= _dirtyBottom) {
+      _dirtyTop = top;
+      _dirtyBottom = bottom;
+    } else {
+      _dirtyTop = min(_dirtyTop, top);
+      _dirtyBottom = max(_dirtyBottom, bottom);
+    }
+  }
+
+private:
+  TFT_eSprite* _sprite;
+  uint16_t* _frame;
+  uint16_t* _front;
+  DisplayPanel* _panel;
+  int16_t _dirtyTop;
+  int16_t _dirtyBottom;  // Exclusive; equal to _dirtyTop when clean
+  bool _presented;
+};
+
+Compositor* createCompositor(TFT_eSPI& tft) {
+#if DISPLAY_SPRITE
+  if (psramFound()) {
+    size_t frameBytes = (size_t)tft.width() * tft.height() * 2;
+    TFT_eSprite* sprite = new TFT_eSprite(&tft);
+    sprite->setColorDepth(16);
+    sprite->setAttribute(PSRAM_ENABLE, true);
+    uint16_t* frame = (uint16_t*)sprite->createSprite(tft.width(), tft.height());
+    uint16_t* front = (uint16_t*)heap_caps_malloc(frameBytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    if (frame && front && tft.initDMA()) {
+      Serial.println("Display: PSRAM sprite with DMA push");
+      return new SpriteCompositor(sprite, frame, front, new TftDmaPanel(tft));
+    }
+
+    heap_caps_free(front);
+    sprite->deleteSprite();
+    delete sprite;
+    Serial.println("Display: sprite unavailable, drawing directly");
+  }
+#endif
+  return new DirectCompositor(tft);
+}
@@ -0,0 +1,57 @@
+#ifndef DISPLAY_COMPOSITOR_H
+#define DISPLAY_COMPOSITOR_H
+
+#include <Arduino.h>
+
+class TFT_eSPI;
+
+// Where the status screen is drawn. The status screen only uses these
+// primitives, so it doesn't care whether pixels go straight to the panel
+// or into an off-screen frame first. Nothing here depends on TFT_eSPI,
+// which lets a host build drive the status screen into memory.
+
+// Receives finished frames from a frame-buffered compositor
+class DisplayPanel {
+public:
+  virtual ~DisplayPanel() {}
+
+  // Starts sending rows [y, y + h) of a full-width RGB565 frame, already
+  // in the panel's byte order. May return before the transfer is done;
+  // rows must stay untouched until busy() is false.
+  virtual void pushRows(int16_t y, int16_t h, const uint16_t* rows) = 0;
+  // Completes a finished transfer; true while one is still running
+  virtual bool busy() = 0;
+  virtual void waitIdle() = 0;
+  // Duration of the last completed transfer
+  virtual uint32_t lastTransferUs() const = 0;
+};
+
+class Compositor {
+public:
+  virtual ~Compositor() {}
+
+  virtual int16_t width() = 0;
+  virtual int16_t height() = 0;
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) = 0;
+  virtual void hLine(int16_t y, uint16_t color) = 0;
+  // Built-in 6x8 font, drawn with a background
+  virtual void drawText(int16_t x, int16_t y, const String& text, uint16_t color, uint16_t background) = 0;
+
+  // Sends everything drawn since the last call to the panel. Returns the
+  // SPI bytes it cost: one address window plus 2 bytes per pixel for each
+  // transfer.
+  virtual uint32_t present() = 0;
+  // Frame-buffered compositors push asynchronously; null if drawing is direct
+  virtual DisplayPanel* panel() = 0;
+  // Last frame sent to the panel, RGB565 in panel (big-endian) byte order;
+  // null if drawing is direct or nothing was sent yet
+  virtual const uint16_t* shownFrame() = 0;
+};
+
+#define SPI_WINDOW_BYTES 11  // CASET + RASET + RAMWR and their parameters
+
+// PSRAM sprite with DMA push when DISPLAY_SPRITE is on and the memory is
+// there, otherwise drawing straight to the panel
+Compositor* createCompositor(TFT_eSPI& tft);
+
+#endif //DISPLAY_COMPOSITOR_H
@@ -3,6 +3,11 @@
 #include <TFT_eSPI.h>
 #include "config.h"
 #include "littlefs_manager.h"
+#include "buffered_file.h"
+#include "block_cache.h"
+#include "display_compositor.h"
+#include "event_stream.h"
+#include "utils.h"
 
 // TFT_eSPI display instance
 TFT_eSPI display = TFT_eSPI();
@@ -11,6 +16,29 @@ bool displayAvailable = false;
 String lastAction = "";
 unsigned long lastActionTime = 0;
 
+// Status screen drawing target, set up with the display
+static Compositor* compositor = nullptr;
+static DisplayStats displayStats = { 0, 0, 0, 0, 0, 0, 0, 0, 0, false };
+
+// What the status screen shows, copied from the globals under statusLock
+// by updateDisplayStatus() and drawn by the render task
+struct StatusSnapshot {
+  bool apMode;
+  String ip;
+  String ssid;
+  String action;
+  unsigned long actionTime;
+};
+
+static StatusSnapshot pendingStatus = { false, "", "", "", 0 };
+static SemaphoreHandle_t statusLock = nullptr;
+// Held while present() copies into the front buffer, so a screenshot
+// never copies a frame that is being replaced
+static SemaphoreHandle_t frameLock = nullptr;
+static TaskHandle_t renderTaskHandle = nullptr;
+
+static void renderTask(void* arg);
+
 extern bool isAPMode;
 extern String currentSSID;
 
@@ -25,31 +53,115 @@ extern String currentSSID;
 #define COLOR_ORANGE  TFT_ORANGE
 
 // Helper to read 2 or 4 byte values from file (Little Endian)
-uint16_t read16(fs::File &f) {
-  uint16_t result;
-  f.read((uint8_t *)&result, sizeof(result));
+uint16_t read16(BufferedFileReader &f) {
+  uint16_t result = 0;
+  f.readBytes((uint8_t *)&result, sizeof(result));
   return result;
 }
 
-uint32_t read32(fs::File &f) {
-  uint32_t result;
-  f.read((uint8_t *)&result, sizeof(result));
+uint32_t read32(BufferedFileReader &f) {
+  uint32_t result = 0;
+  f.readBytes((uint8_t *)&result, sizeof(result));
   return result;
 }
 
-bool drawBmp(const char *filename, int16_t x, int16_t y) {
-  if (!storageAvailable || !storageFS) return false;
+#define BMP_CENTERED INT16_MIN  // drawBmp() x or y: center on the screen
 
-  fs::File bmpFile = storageFS->open(filename, "r");
-  if (!bmpFile) {
-    Serial.println("BMP file not found: " + String(filename));
+static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// Decoded BMPs are kept as raw RGB565 next to the source ("<path>.565"),
+// clipped to the screen. The next draw is one read and one push.
+struct Rgb565Header {
+  char magic[4];            // "R565"
+  uint32_t sourceSize;      // Source file this was decoded from
+  uint32_t sourceModified;
+  int16_t requestX;         // drawBmp() arguments it was drawn with
+  int16_t requestY;
+  int16_t x;                // Visible part, as pushed
+  int16_t y;
+  uint16_t width;
+  uint16_t height;
+};
+
+static String rgb565CachePath(const char* filename) {
+  return String(filename) + ".565";
+}
+
+static bool sourceStamp(const char* filename, uint32_t& size, uint32_t& modified) {
+  File file = storageFS->open(filename, "r");
+  if (!file) return false;
+  size = file.size();
+  modified = file.getLastWrite();
+  file.close();
+  return true;
+}
+
+static bool drawCachedRgb565(const char* filename, int16_t x, int16_t y, uint32_t size, uint32_t modified) {
+  String cachePath = rgb565CachePath(filename);
+  if (!storageFS->exists(cachePath)) return false;
+  File file = storageFS->open(cachePath, "r");
+  if (!file) return false;
+
+  Rgb565Header header;
+  size_t pixelBytes = 0;
+  bool valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+               memcmp(header.magic, "R565", 4) == 0 &&
+               header.sourceSize == size && header.sourceModified == modified &&
+               header.requestX == x && header.requestY == y;
+  if (valid) {
+    pixelBytes = (size_t)header.width * header.height * 2;
+    valid = file.size() == sizeof(header) + pixelBytes;
+  }
+  if (!valid) {
+    file.close();
     return false;
   }
 
+  uint16_t* pixels = (uint16_t*)(psramFound() ? ps_malloc(pixelBytes) : malloc(pixelBytes));
+  bool drawn = pixels && file.read((uint8_t*)pixels, pixelBytes) == pixelBytes;
+  file.close();
+  if (drawn && pixelBytes > 0) {
+    display.startWrite();
+    display.setSwapBytes(true);
+    display.pushImage(header.x, header.y, header.width, header.height, pixels);
+    display.setSwapBytes(false);
+    display.endWrite();
+  }
+  free(pixels);
+  return drawn;
+}
+
+static void writeCachedRgb565(const char* filename, const Rgb565Header& header, const uint16_t* pixels) {
+  String cachePath = rgb565CachePath(filename);
+  size_t bytes = sizeof(header) + (size_t)header.width * header.height * 2;
+  size_t replacedSize = storedFileSize(cachePath);
+  if (!hasAvailableSpace(bytes)) return;
+
+  File file = storageFS->open(cachePath, "w");
+  accountFileChange(replacedSize, 0);
+  if (!file) return;
+  bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            file.write((const uint8_t*)pixels, bytes - sizeof(header)) == bytes - sizeof(header);
+  file.close();
+  if (ok) {
+    accountFileChange(0, bytes);
+  } else {
+    storageFS->remove(cachePath);
+  }
+}
+
+// Decodes uncompressed 1/4/8-bit palettized, 16-bit (555 or 565), 24-bit
+// and 32-bit BMPs a row at a time. Only the visible columns of each row
+// are read, in one call, so the row buffers never exceed the screen width.
+// With capture, the visible pixels are also kept for the RGB565 cache.
+static bool drawBmpFile(CachedFile &file, int16_t x, int16_t y, Rgb565Header* capture, uint16_t** captured) {
+  BufferedFileReader bmpFile(file);
+
   // Check BMP signature
   if (read16(bmpFile) != 0x4D42) {
     Serial.println("Not a valid BMP file");
-    bmpFile.close();
     return false;
   }
 
@@ -62,56 +174,154 @@ bool drawBmp(const char *filename, int16_t x, int16_t y) {
   uint16_t planes = read16(bmpFile);
   uint16_t depth = read16(bmpFile);
   uint32_t compression = read32(bmpFile);
+  read32(bmpFile); // Image size
+  read32(bmpFile); // Horizontal resolution
+  read32(bmpFile); // Vertical resolution
+  uint32_t colorsUsed = read32(bmpFile);
 
   // Support BI_RGB (0) and BI_BITFIELDS (3)
-  if (planes != 1 || (depth != 24 && depth != 32) || (compression != 0 && compression != 3)) {
+  bool palettized = depth == 1 || depth == 4 || depth == 8;
+  bool supported = palettized ? compression == 0
+                              : (depth == 16 || depth == 24 || depth == 32) && (compression == 0 || compression == 3);
+  if (planes != 1 || width <= 0 || !supported) {
     Serial.print("Unsupported BMP: Depth="); Serial.print(depth);
     Serial.print(", Comp="); Serial.println(compression);
-    bmpFile.close();
     return false;
   }
 
+  // 16-bit BI_RGB is 555; bitfields say which layout it is
+  bool is565 = false;
+  if (depth == 16 && compression == 3) {
+    bmpFile.seek(14 + 40);  // Masks follow the 40-byte header (or sit in a V4/V5 one)
+    read32(bmpFile); // Red mask
+    is565 = read32(bmpFile) == 0x07E0;
+  }
+
   bool topDown = (height < 0);
   if (topDown) height = -height;
 
-  bmpFile.seek(offset);
+  if (x == BMP_CENTERED) x = (display.width() - width) / 2;
+  if (y == BMP_CENTERED) y = (display.height() - height) / 2;
+
+  // Visible part of the image
+  int32_t colStart = max((int32_t)0, (int32_t)-x);
+  int32_t colEnd = min(width, (int32_t)display.width() - x);
+  int32_t rowStart = max((int32_t)0, (int32_t)-y);
+  int32_t rowEnd = min(height, (int32_t)display.height() - y);
+  int32_t visibleWidth = colEnd - colStart;
+  int32_t visibleHeight = rowEnd - rowStart;
+  if (visibleWidth <= 0 || visibleHeight <= 0) return true;
+
+  uint16_t palette[256];
+  if (palettized) {
+    uint32_t colors = (colorsUsed > 0 && colorsUsed <= (1u << depth)) ? colorsUsed : (1u << depth);
+    bmpFile.seek(14 + headerSize);
+    for (uint32_t i = 0; i < colors; i++) {
+      uint8_t bgrx[4];
+      bmpFile.readBytes(bgrx, 4);
+      palette[i] = rgb565(bgrx[2], bgrx[1], bgrx[0]);
+    }
+  }
 
-  int bytesPerPixel = depth / 8;
-  int rowPadding = (4 - (width * bytesPerPixel) % 4) % 4;
-  uint16_t lineBuffer[width];
+  uint32_t rowBytes = ((width * depth + 31) / 32) * 4;
+  uint32_t byteStart = colStart * depth / 8;
+  uint32_t byteEnd = (colEnd * depth + 7) / 8;
+  uint32_t byteCount = byteEnd - byteStart;
+
+  uint8_t* raw = (uint8_t*)malloc(byteCount);
+  uint16_t* lineBuffer = (uint16_t*)malloc(visibleWidth * 2);
+  if (capture) {
+    *captured = (uint16_t*)(psramFound() ? ps_malloc(visibleWidth * visibleHeight * 2)
+                                         : malloc(visibleWidth * visibleHeight * 2));
+  }
+  if (!raw || !lineBuffer) {
+    free(raw);
+    free(lineBuffer);
+    Serial.println("BMP error: Out of memory");
+    return false;
+  }
+
+  bmpFile.seek(offset);
 
   display.startWrite();
   display.setSwapBytes(true); // Ensure 16-bit colors are swapped for ST7735
-  
-  for (int row = 0; row < height; row++) {
-    // Determine target Y based on orientation
-    int32_t targetY = topDown ? (y + row) : (y + height - 1 - row);
-    
+
+  for (int32_t fileRow = 0; fileRow < height; fileRow++) {
+    int32_t imageRow = topDown ? fileRow : height - 1 - fileRow;
+
     // Skip if outside screen bounds
-    if (targetY < 0 || targetY >= display.height()) {
-       bmpFile.seek(bmpFile.position() + (width * bytesPerPixel) + rowPadding);
-       continue;
+    if (imageRow < rowStart || imageRow >= rowEnd) {
+      bmpFile.skip(rowBytes);
+      continue;
     }
 
-    for (int col = 0; col < width; col++) {
-      uint8_t b = bmpFile.read();
-      uint8_t g = bmpFile.read();
-      uint8_t r = bmpFile.read();
-      if (depth == 32) bmpFile.read(); // Skip alpha
-      
-      // BMP is usually BGR. color565 expects R, G, B
-      lineBuffer[col] = display.color565(r, g, b);
+    bmpFile.skip(byteStart);
+    bmpFile.readBytes(raw, byteCount);
+    bmpFile.skip(rowBytes - byteStart - byteCount);
+
+    for (int32_t i = 0; i < visibleWidth; i++) {
+      int32_t col = colStart + i;
+      uint16_t color;
+      if (palettized) {
+        uint32_t bit = col * depth - byteStart * 8;
+        uint8_t shift = 8 - depth - (bit % 8);
+        color = palette[(raw[bit / 8] >> shift) & ((1 << depth) - 1)];
+      } else if (depth == 16) {
+        uint16_t v = raw[i * 2] | (raw[i * 2 + 1] << 8);
+        if (!is565) {
+          uint16_t g = (v >> 5) & 0x1F;
+          v = ((v & 0x7C00) << 1) | (g << 6) | ((g >> 4) << 5) | (v & 0x1F);
+        }
+        color = v;
+      } else {
+        // BMP is usually BGR; 32-bit has a fourth byte
+        const uint8_t* p = raw + i * (depth / 8);
+        color = rgb565(p[2], p[1], p[0]);
+      }
+      lineBuffer[i] = color;
+    }
+
+    display.pushImage(x + colStart, y + imageRow, visibleWidth, 1, lineBuffer);
+    if (capture && *captured) {
+      memcpy(*captured + (imageRow - rowStart) * visibleWidth, lineBuffer, visibleWidth * 2);
     }
-    bmpFile.seek(bmpFile.position() + rowPadding);
-    display.pushImage(x, targetY, width, 1, lineBuffer);
   }
   display.setSwapBytes(false); // Reset to default
   display.endWrite();
 
-  bmpFile.close();
+  free(raw);
+  free(lineBuffer);
+
+  if (capture) {
+    capture->x = x + colStart;
+    capture->y = y + rowStart;
+    capture->width = visibleWidth;
+    capture->height = visibleHeight;
+  }
   return true;
 }
 
+bool drawBmp(const char *filename, int16_t x, int16_t y) {
+  if (!storageAvailable || !storageFS) return false;
+
+  uint32_t size = 0, modified = 0;
+  bool stamped = BMP_RGB565_CACHE && sourceStamp(filename, size, modified);
+  if (stamped && drawCachedRgb565(filename, x, y, size, modified)) return true;
+
+  CachedFile bmpFile(filename);
+  if (!bmpFile) {
+    Serial.println("BMP file not found: " + String(filename));
+    return false;
+  }
+
+  Rgb565Header header = { { 'R', '5', '6', '5' }, size, modified, x, y, 0, 0, 0, 0 };
+  uint16_t* pixels = nullptr;
+  bool drawn = drawBmpFile(bmpFile, x, y, stamped ? &header : nullptr, &pixels);
+  if (drawn && pixels) writeCachedRgb565(filename, header, pixels);
+  free(pixels);
+  return drawn;
+}
+
 // Internal function to show startup logo
 void showStartupLogo() {
   display.fillScreen(COLOR_BLACK);
@@ -123,19 +333,7 @@ void showStartupLogo() {
 
   bool logoDrawn = false;
   if (storageAvailable && storageFS && storageFS->exists(logoPath)) {
-    // Read dimensions for centering
-    fs::File file = storageFS->open(logoPath, "r");
-    if (file) {
-      file.seek(18);
-      int32_t w = read32(file);
-      int32_t h = read32(file);
-      if (h < 0) h = -h;
-      file.close();
-      
-      int16_t x = (display.width() - w) / 2;
-      int16_t y = (display.height() - h) / 2;
-      logoDrawn = drawBmp(logoPath, x, y);
-    }
+    logoDrawn = drawBmp(logoPath, BMP_CENTERED, BMP_CENTERED);
   }
 
   if (!logoDrawn) {
@@ -170,103 +368,210 @@ void setupDisplay() {
   Serial.print("x");
   Serial.println(display.height());
 
+  compositor = createCompositor(display);
+  statusLock = xSemaphoreCreateMutex();
+  frameLock = xSemaphoreCreateMutex();
+  displayStats.sprite = compositor->panel() != nullptr;
+  displayStats.fullFrameBytes = SPI_WINDOW_BYTES + display.width() * display.height() * 2;
+
   // Show formatted startup logo
   showStartupLogo();
+
+  // From here on the render task owns the panel
+  xTaskCreatePinnedToCore(renderTask, "display", 4096, nullptr, 1, &renderTaskHandle, 0);
+}
+
+// Status screen, optimized for 80x160 (or 160x80 in landscape). Each line
+// remembers what it last showed and is only redrawn when that changes, so
+// a typed command repaints the action line and nothing else.
+
+#define CHAR_WIDTH 6         // Built-in font at text size 1
+#define CHAR_HEIGHT 8
+#define LINE_HEIGHT 10
+#define MAX_CHARS 25         // Approx chars for 160px width
+
+struct StatusLine {
+  int16_t y;
+  String label;
+  String value;
+  bool drawn;
+};
+
+enum { LINE_ADDRESS, LINE_NETWORK, LINE_USER, LINE_PASS, LINE_COUNT };
+
+static StatusLine statusLines[LINE_COUNT] = {
+  { 18, "", "", false },
+  { 28, "", "", false },
+  { 38, "", "", false },
+  { 48, "", "", false },
+};
+
+#define ACTION_Y 62  // Separator, with the action text 4px below it
+
+static StatusLine actionLine = { ACTION_Y + 4, "", "", false };
+static bool frameDrawn = false;
+
+static String ellipsize(String text, int maxChars) {
+  if ((int)text.length() > maxChars) text = text.substring(0, maxChars - 3) + "...";
+  return text;
+}
+
+// Text is drawn with a background, so new glyphs erase the old ones
+static void drawLine(StatusLine& line, const String& label, uint16_t labelColor, const String& value) {
+  if (line.drawn && line.label == label && line.value == value) return;
+
+  int16_t oldEnd = line.drawn ? 2 + (line.label.length() + line.value.length()) * CHAR_WIDTH : 0;
+  int16_t valueX = 2 + label.length() * CHAR_WIDTH;
+  int16_t newEnd = valueX + value.length() * CHAR_WIDTH;
+
+  compositor->drawText(2, line.y, label, labelColor, COLOR_BLACK);
+  compositor->drawText(valueX, line.y, value, COLOR_WHITE, COLOR_BLACK);
+  // Clear whatever a longer previous value left behind
+  if (oldEnd > newEnd) compositor->fillRect(newEnd, line.y, oldEnd - newEnd, CHAR_HEIGHT, COLOR_BLACK);
+
+  line.label = label;
+  line.value = value;
+  line.drawn = true;
+}
+
+static void drawStaticFrame() {
+  compositor->fillRect(0, 0, compositor->width(), compositor->height(), COLOR_BLACK);
+  compositor->drawText(2, 2, "WiFi USB HID Control", COLOR_YELLOW, COLOR_BLACK);
+  compositor->hLine(2 + LINE_HEIGHT + 2, COLOR_BLUE);
+
+  for (int i = 0; i < LINE_COUNT; i++) statusLines[i].drawn = false;
+  actionLine.drawn = false;
+  frameDrawn = true;
+}
+
+static void drawActionLine(const StatusSnapshot& status) {
+  bool visible = status.action.length() > 0 && millis() - status.actionTime < DISPLAY_ACTION_MS;
+
+  if (!visible) {
+    if (actionLine.drawn) {
+      compositor->fillRect(0, ACTION_Y, compositor->width(), actionLine.y + CHAR_HEIGHT - ACTION_Y, COLOR_BLACK);
+      actionLine.drawn = false;
+    }
+    return;
+  }
+
+  if (!actionLine.drawn) compositor->hLine(ACTION_Y, COLOR_ORANGE);
+  drawLine(actionLine, "> ", COLOR_ORANGE, ellipsize(status.action, MAX_CHARS - 2));
+}
+
+static void renderStatus() {
+  xSemaphoreTake(statusLock, portMAX_DELAY);
+  StatusSnapshot status = pendingStatus;
+  xSemaphoreGive(statusLock);
+
+  uint32_t start = micros();
+  if (!frameDrawn) drawStaticFrame();
+
+  drawLine(statusLines[LINE_ADDRESS], status.apMode ? "AP: " : "IP: ", COLOR_GREEN, status.ip);
+  drawLine(statusLines[LINE_NETWORK], "Net: ", COLOR_GREEN, ellipsize(status.ssid, MAX_CHARS - 5));
+  drawLine(statusLines[LINE_USER], "U:", COLOR_CYAN, WEB_AUTH_USER);
+  drawLine(statusLines[LINE_PASS], "P:", COLOR_CYAN, ellipsize(WEB_AUTH_PASS, MAX_CHARS - 3));
+  drawActionLine(status);
+  uint32_t composed = micros();
+
+  // With a sprite this only starts the DMA push, which just reads the
+  // front buffer
+  xSemaphoreTake(frameLock, portMAX_DELAY);
+  uint32_t bytes = compositor->present();
+  xSemaphoreGive(frameLock);
+
+  displayStats.updates++;
+  if (bytes == 0) displayStats.unchanged++;
+  displayStats.lastBytes = bytes;
+  displayStats.totalBytes += bytes;
+  displayStats.composeUs = composed - start;
+  displayStats.presentUs = micros() - composed;
+}
+
+// Ticks until the action on screen is due to disappear
+static TickType_t expiryWait() {
+  if (!actionLine.drawn) return portMAX_DELAY;
+  xSemaphoreTake(statusLock, portMAX_DELAY);
+  unsigned long shown = millis() - pendingStatus.actionTime;
+  xSemaphoreGive(statusLock);
+  return shown >= DISPLAY_ACTION_MS ? 0 : pdMS_TO_TICKS(DISPLAY_ACTION_MS - shown);
+}
+
+// Redraws on request, at most DISPLAY_MAX_FPS times a second. Requests
+// that arrive while a frame is pending or being drawn fold into it, and
+// the wait times out when the action line is due to expire.
+static void renderTask(void* arg) {
+  const TickType_t frameInterval = pdMS_TO_TICKS(1000 / DISPLAY_MAX_FPS);
+  TickType_t lastFrame = xTaskGetTickCount() - frameInterval;
+
+  while (true) {
+    uint32_t requests = ulTaskNotifyTake(pdTRUE, expiryWait());
+
+    TickType_t sinceFrame = xTaskGetTickCount() - lastFrame;
+    if (sinceFrame < frameInterval) vTaskDelay(frameInterval - sinceFrame);
+    requests += ulTaskNotifyTake(pdTRUE, 0);
+    displayStats.requests += requests;
+
+    lastFrame = xTaskGetTickCount();
+    renderStatus();
+
+    // Only this task touches the panel, so it can wait out the DMA push
+    if (compositor->panel()) {
+      compositor->panel()->waitIdle();
+      displayStats.transferUs = compositor->panel()->lastTransferUs();
+    }
+  }
 }
 
-// Display Functions - Optimized for 80x160 (or 160x80 in landscape)
 void updateDisplayStatus() {
   if (!displayAvailable) return;
 
-  display.fillScreen(COLOR_BLACK);
-  display.setTextSize(1);
-
-  int y = 2;  // Starting Y position
-  int lineHeight = 10;
-  int maxChars = 25; // Approx chars for 160px width with 6px font
-
-  // Line 1: Title
-  display.setCursor(2, y);
-  display.setTextColor(COLOR_YELLOW);
-  display.println("WiFi USB HID Control");
-  y += lineHeight + 2;
-
-  // Separator line
-  display.drawFastHLine(0, y, display.width(), COLOR_BLUE);
-  y += 4;
-
-  // Line 2: Mode and IP
-  display.setCursor(2, y);
-  if (isAPMode) {
-    display.setTextColor(COLOR_GREEN);
-    display.print("AP: ");
-    display.setTextColor(COLOR_WHITE);
-    display.println("192.168.4.1");
+  // Snapshot what the task will draw; it never reads the globals
+  xSemaphoreTake(statusLock, portMAX_DELAY);
+  // The station's address wins once it is up, even with the setup AP open
+  pendingStatus.apMode = isAPMode && WiFi.status() != WL_CONNECTED;
+  pendingStatus.ip = pendingStatus.apMode ? String("192.168.4.1") : WiFi.localIP().toString();
+  pendingStatus.ssid = pendingStatus.apMode ? String(AP_SSID) : currentSSID;
+  pendingStatus.action = lastAction;
+  pendingStatus.actionTime = lastActionTime;
+  xSemaphoreGive(statusLock);
+
+  if (renderTaskHandle) {
+    xTaskNotifyGive(renderTaskHandle);
   } else {
-    display.setTextColor(COLOR_GREEN);
-    display.print("IP: ");
-    display.setTextColor(COLOR_WHITE);
-    String ip = WiFi.localIP().toString();
-    // IP usually fits in 160px
-    display.println(ip);
-  }
-  y += lineHeight;
-
-  // Line 3: SSID
-  display.setCursor(2, y);
-  display.setTextColor(COLOR_GREEN);
-  display.print("Net: ");
-  display.setTextColor(COLOR_WHITE);
-  String ssid = isAPMode ? String(AP_SSID) : currentSSID;
-  if (ssid.length() > maxChars - 5) {
-    ssid = ssid.substring(0, maxChars - 8) + "...";
-  }
-  display.println(ssid);
-  y += lineHeight;
-
-  // Line 4: Web Auth
-  display.setCursor(2, y);
-  display.setTextColor(COLOR_CYAN);
-  display.print("U:");
-  display.setTextColor(COLOR_WHITE);
-  display.print(WEB_AUTH_USER);
-  
-  // Display Pass on same line if short, or next line?
-  // Let's keep separate lines but use full width
-  y += lineHeight;
-  
-  display.setCursor(2, y);
-  display.setTextColor(COLOR_CYAN);
-  display.print("P:");
-  display.setTextColor(COLOR_WHITE);
-  String pass = String(WEB_AUTH_PASS);
-  if (pass.length() > maxChars - 3) {
-    pass = pass.substring(0, maxChars - 6) + "...";
-  }
-  display.println(pass);
-  y += lineHeight + 4;
-
-  // Last action (if any)
-  if (lastAction.length() > 0) {
-    unsigned long timeSinceAction = millis() - lastActionTime;
-    if (timeSinceAction < 3000) { // Show for 3 seconds
-      display.drawFastHLine(0, y, display.width(), COLOR_ORANGE);
-      y += 4;
-
-      display.setCursor(2, y);
-      display.setTextColor(COLOR_ORANGE);
-      display.print("> ");
-      display.setTextColor(COLOR_WHITE);
-      String action = lastAction;
-      if (action.length() > maxChars - 2) {
-        action = action.substring(0, maxChars - 5) + "...";
-      }
-      display.println(action);
-    }
+    displayStats.requests++;
+    renderStatus();
   }
 }
 
+const DisplayStats& getDisplayStats() {
+  return displayStats;
+}
+
+bool canCaptureDisplay() {
+  return displayAvailable && compositor && compositor->shownFrame();
+}
+
+uint16_t* captureDisplayFrame() {
+  if (!canCaptureDisplay()) return nullptr;
+  size_t bytes = (size_t)compositor->width() * compositor->height() * 2;
+  uint16_t* frame = (uint16_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+  if (!frame) return nullptr;
+
+  xSemaphoreTake(frameLock, portMAX_DELAY);
+  memcpy(frame, compositor->shownFrame(), bytes);
+  xSemaphoreGive(frameLock);
+  return frame;
+}
+
+bool writeDisplayPng(const uint16_t* frame, PngSink sink, void* ctx) {
+  return writeRgb565Png(frame, compositor->width(), compositor->height(), true, sink, ctx);
+}
+
 void displayAction(String action) {
+  // Mirror every action to the web UI's activity stream, display or not
+  publishEvent("activity", "{\"message\":\"" + escapeJson(action) + "\"}");
+
   if (!displayAvailable) return;
 
   lastAction = action;
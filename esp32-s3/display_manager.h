@@ -2,8 +2,35 @@
 #define DISPLAY_MANAGER_H
 
 #include <Arduino.h>
+#include "png_writer.h"
 
+// Status update costs. SPI byte counts are modeled from what was sent:
+// one address window plus 2 bytes per pixel per transfer.
+struct DisplayStats {
+  uint32_t requests;        // updateDisplayStatus() calls
+  uint32_t updates;         // Frames drawn; requests fold into fewer frames
+  uint32_t unchanged;       // Updates that found nothing to redraw
+  uint32_t lastBytes;
+  uint64_t totalBytes;
+  uint32_t fullFrameBytes;  // What a whole-screen repaint costs
+  uint32_t composeUs;       // Drawing the last update (includes SPI when direct)
+  uint32_t presentUs;       // Handing it to the panel
+  uint32_t transferUs;      // Last DMA transfer, sprite mode only
+  bool sprite;
+};
+
+// Queues a redraw and returns; a render task draws the status screen at
+// most DISPLAY_MAX_FPS times a second
 void updateDisplayStatus();
+const DisplayStats& getDisplayStats();
+// Screenshot of the status screen as last sent to the panel. Only
+// possible in sprite mode, where the frame is kept in memory.
+bool canCaptureDisplay();
+// Copy of that frame, taken under the lock the render task presents
+// with, so it is never half of one update and half of the next. Null
+// without a frame or memory for the copy; free() it when done.
+uint16_t* captureDisplayFrame();
+bool writeDisplayPng(const uint16_t* frame, PngSink sink, void* ctx);
 void displayAction(String action);
 void setupDisplay();
 
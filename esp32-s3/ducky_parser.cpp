@@ -1,12 +1,28 @@
 #include "ducky_parser.h"
 #include "hid_handler.h"
+#include "event_stream.h"
 
 void parseDuckyLine(String line);
 
+// Runs one script line; false for blank lines and comments
+static bool runScriptLine(String line) {
+  line.trim();
+
+  // Skip empty lines and comments
+  if (line.length() == 0 || line.startsWith("//")) {
+    return false;
+  }
+
+  parseDuckyLine(line);
+  return true;
+}
+
 void executeDuckyScript(String script) {
   Serial.println("Executing Ducky Script...");
+  publishEvent("job", "{\"state\":\"running\"}");
   int lineStart = 0;
   int lineEnd = 0;
+  int executed = 0;
 
   while (lineEnd != -1) {
     lineEnd = script.indexOf('\n', lineStart);
@@ -19,17 +35,26 @@ void executeDuckyScript(String script) {
       lineStart = lineEnd + 1;
     }
 
-    line.trim();
+    if (runScriptLine(line)) executed++;
 
-    // Skip empty lines and comments
-    if (line.length() == 0 || line.startsWith("//")) {
-      continue;
-    }
+    if (lineEnd == -1) break;
+  }
+
+  publishEvent("job", "{\"state\":\"done\",\"lines\":" + String(executed) + "}");
+}
 
-    parseDuckyLine(line);
+void executeDuckyScript(CompressedFileReader& reader) {
+  Serial.println("Executing Ducky Script from file...");
+  publishEvent("job", "{\"state\":\"running\"}");
+  int executed = 0;
 
-    if (lineEnd == -1) break;
+  // One line in memory at a time, however long the script is
+  String line;
+  while (reader.readLine(line)) {
+    if (runScriptLine(line)) executed++;
   }
+
+  publishEvent("job", "{\"state\":\"done\",\"lines\":" + String(executed) + "}");
 }
 
 void parseDuckyLine(String line) {
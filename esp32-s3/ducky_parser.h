@@ -2,7 +2,10 @@
 #define DUCKY_PARSER_H
 
 #include <Arduino.h>
+#include "compressed_file.h"
 
 void executeDuckyScript(String script);
+// Streams a saved script line by line (compressed or plain)
+void executeDuckyScript(CompressedFileReader& reader);
 
 #endif //DUCKY_PARSER_H
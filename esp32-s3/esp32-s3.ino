@@ -26,6 +26,9 @@
 #include "web_server.h"
 #include "display_manager.h"
 #include "littlefs_manager.h"
+#include "block_cache.h"
+#include "config_cache.h"
+#include "script_manifest.h"
 #include "ducky_parser.h"
 #include "quick_scripts.h"
 #include "hid_handler.h"
@@ -43,23 +46,19 @@ void setup() {
 
   // Initialize Storage (SD Card or LittleFS)
   setupStorage();
+  setupBlockCache();
+
+  // Parse quick actions, quick scripts and custom OS lists into RAM
+  setupConfigCache();
+  setupScriptManifest();
 
   // Initialize ST7735 LCD display
   setupDisplay();
 
-  // Load and connect to WiFi
+  // Load saved networks; the setup AP comes up right away and the station
+  // connects in the background from loop()
   loadWiFiNetworks();
-
-  if (knownNetworks.size() > 0) {
-    Serial.println("Attempting to connect to saved networks...");
-    if (!connectToAnyWiFi()) {
-      Serial.println("Failed to connect to any network, starting AP mode");
-      startAPMode();
-    }
-  } else {
-    Serial.println("No saved credentials, starting AP mode");
-    startAPMode();
-  }
+  startWiFi();
 
   // Setup web server
   setupWebServer();
@@ -69,8 +68,6 @@ void setup() {
 
   if (isAPMode) {
     Serial.println("AP Mode - IP: 192.168.4.1");
-  } else {
-    Serial.println("Station Mode - IP: " + WiFi.localIP().toString());
   }
 
   updateDisplayStatus();
@@ -82,6 +79,12 @@ void loop() {
   // Handle web server requests
   handleWebClients();
 
+  // Join, fail over and reconnect WiFi without blocking
+  handleWiFi();
+
   // Handle mouse jiggler
   updateJiggler();
+
+  // Fold the config journal into snapshots when it gets long
+  handleConfigCache();
 }
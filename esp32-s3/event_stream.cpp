@@ -0,0 +1,127 @@
+#include "event_stream.h"
+#include <WiFi.h>
+#include "config.h"
+
+struct StreamEvent {
+  uint32_t id;
+  char type[16];
+  String data;
+};
+
+struct EventClient {
+  WiFiClient client;
+  uint32_t lastSentId;
+  unsigned long lastWrite;
+  bool active;
+};
+
+// Fixed-size history; a reconnecting client resumes from it via Last-Event-ID
+static StreamEvent eventRing[EVENT_RING_SIZE];
+static uint32_t nextEventId = 1;
+
+static EventClient eventClients[MAX_EVENT_STREAMS];
+
+static uint32_t oldestEventId() {
+  return nextEventId > EVENT_RING_SIZE ? nextEventId - EVENT_RING_SIZE : 1;
+}
+
+void publishEvent(const char* type, const String& data) {
+  StreamEvent& event = eventRing[nextEventId % EVENT_RING_SIZE];
+  event.id = nextEventId++;
+  strncpy(event.type, type, sizeof(event.type) - 1);
+  event.type[sizeof(event.type) - 1] = '\0';
+  event.data = data;
+}
+
+static bool writeEvent(EventClient& ec, const StreamEvent& event) {
+  String frame = "id: " + String(event.id) + "\nevent: " + String(event.type) +
+                 "\ndata: " + event.data + "\n\n";
+  if (ec.client.print(frame) != frame.length()) return false;
+  ec.lastSentId = event.id;
+  ec.lastWrite = millis();
+  return true;
+}
+
+bool openEventStream(WebServer& server, uint32_t lastEventId,
+                     const char* snapshotType, const String& snapshot) {
+  int slot = -1;
+  for (int i = 0; i < MAX_EVENT_STREAMS; i++) {
+    if (eventClients[i].active && !eventClients[i].client.connected()) {
+      eventClients[i].client.stop();
+      eventClients[i].active = false;
+    }
+    if (!eventClients[i].active && slot < 0) slot = i;
+  }
+  if (slot < 0) return false;
+
+  // Keep our own reference to the socket. WebServer drops its copy once
+  // the handler returns, which leaves the connection open for streaming.
+  EventClient& ec = eventClients[slot];
+  ec.client = server.client();
+  ec.client.print("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Connection: keep-alive\r\n\r\n"
+                  "retry: 3000\n\n");
+  ec.lastWrite = millis();
+  ec.active = true;
+
+  if (lastEventId == 0 || lastEventId >= nextEventId) {
+    // New stream: only events from now on
+    ec.lastSentId = nextEventId - 1;
+    if (lastEventId == 0 && snapshotType) {
+      ec.client.print("event: " + String(snapshotType) + "\ndata: " + snapshot + "\n\n");
+    }
+  } else if (lastEventId + 1 < oldestEventId()) {
+    // Too far behind for the ring; tell the client to reload its state
+    ec.client.print("event: reset\ndata: {}\n\n");
+    ec.lastSentId = nextEventId - 1;
+  } else {
+    ec.lastSentId = lastEventId;
+  }
+
+  Serial.println("Event stream opened (slot " + String(slot) + ")");
+  return true;
+}
+
+void handleEventStreams() {
+  unsigned long now = millis();
+
+  for (int i = 0; i < MAX_EVENT_STREAMS; i++) {
+    EventClient& ec = eventClients[i];
+    if (!ec.active) continue;
+
+    if (!ec.client.connected()) {
+      ec.client.stop();
+      ec.active = false;
+      Serial.println("Event stream closed (slot " + String(i) + ")");
+      continue;
+    }
+
+    bool ok = true;
+    while (ok && ec.lastSentId + 1 < nextEventId) {
+      uint32_t id = ec.lastSentId + 1;
+      if (id < oldestEventId()) id = oldestEventId();
+      ok = writeEvent(ec, eventRing[id % EVENT_RING_SIZE]);
+    }
+
+    // Comment lines keep proxies and the browser from timing out an idle stream
+    if (ok && now - ec.lastWrite >= EVENT_HEARTBEAT_MS) {
+      ok = ec.client.print(": ping\n\n") > 0;
+      ec.lastWrite = now;
+    }
+
+    if (!ok) {
+      ec.client.stop();
+      ec.active = false;
+    }
+  }
+}
+
+int openEventStreamCount() {
+  int count = 0;
+  for (int i = 0; i < MAX_EVENT_STREAMS; i++) {
+    if (eventClients[i].active) count++;
+  }
+  return count;
+}
@@ -0,0 +1,23 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+// Queue an event for every open /api/events stream.
+// data must be a JSON value; it is kept in a fixed-size ring for resume.
+void publishEvent(const char* type, const String& data);
+
+// Takes over the current client as a Server-Sent Events stream.
+// A fresh stream (lastEventId 0) first gets the optional snapshot, sent to
+// this client only and without an id so it doesn't move Last-Event-ID.
+// Returns false if every stream slot is in use.
+bool openEventStream(WebServer& server, uint32_t lastEventId,
+                     const char* snapshotType = nullptr, const String& snapshot = String());
+
+// Flushes pending events and heartbeats; call from loop()
+void handleEventStreams();
+
+int openEventStreamCount();
+
+#endif //EVENT_STREAM_H
@@ -9,6 +9,7 @@
 
 #include "hid_handler.h"
 #include <Arduino.h>
+#include "event_stream.h"
 
 // ESP32-S3 has native USB HID support
 #include "USB.h"
@@ -120,12 +121,14 @@ void enableJiggler(String type, int diameter, unsigned long interval) {
   jigglerEnabled = true;
   lastJiggleTime = millis();
   Serial.println("Jiggler enabled (type=" + type + ", diameter=" + String(diameter) + ", delay=" + String(interval) + ")");
+  publishEvent("jiggler", "{\"enabled\":true,\"type\":\"" + type + "\",\"diameter\":" + String(diameter) + ",\"delay\":" + String(interval) + "}");
   blinkLED(2, 100);
 }
 
 void disableJiggler() {
   jigglerEnabled = false;
   Serial.println("Jiggler disabled");
+  publishEvent("jiggler", "{\"enabled\":false}");
   digitalWrite(LED_PIN, LOW);
 }
 
@@ -167,7 +170,7 @@ uint8_t getHIDKeyCode(String key) {
   return 0;
 }
 
-void processHIDCommand(String cmd) {
+bool processHIDCommand(String cmd) {
   cmd.trim();
 
   // Key Capture commands
@@ -552,7 +555,10 @@ void processHIDCommand(String cmd) {
   // Unknown command
   else {
     Serial.println("ERROR: Unknown command - " + cmd);
+    return false;
   }
+
+  return true;
 }
 
 void blinkLED(int times, int delayMs) {
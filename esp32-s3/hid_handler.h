@@ -7,7 +7,8 @@
 void setupHID();
 
 // Command processor (similar to pro-micro's processCommand)
-void processHIDCommand(String cmd);
+// Returns false if the command was not recognized
+bool processHIDCommand(String cmd);
 
 // Mouse jiggler functions
 void updateJiggler();
@@ -2,11 +2,65 @@
 #include <LittleFS.h>
 #include <SD_MMC.h>
 #include "config.h"
+#include "buffered_file.h"
 
 bool storageAvailable = false;
 bool usingSD = false;
 fs::FS* storageFS = nullptr;
 
+// Usage is scanned once in the background and then adjusted by every write
+// and delete that goes through here. SD_MMC.usedBytes() walks the FAT, which
+// takes seconds on a large card. Only usageTask ever scans; everything
+// below is shared with it and only touched under usageLock.
+static uint64_t usageTotal = 0;
+static uint64_t usageUsed = 0;
+static bool usageKnown = false;
+static int64_t scanDelta = 0;  // Changes accounted while a scan runs
+static StorageUsageStats usageStats = { 0, 0, 0 };
+static portMUX_TYPE usageLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void scanUsage(uint64_t& total, uint64_t& used) {
+  if (usingSD) {
+    total = SD_MMC.totalBytes();
+    used = SD_MMC.usedBytes();
+  } else {
+    total = LittleFS.totalBytes();
+    used = LittleFS.usedBytes();
+  }
+}
+
+// Files take whole clusters/blocks, so round sizes the way the disk does
+static uint64_t allocatedSize(size_t size) {
+  uint64_t unit = usingSD ? STORAGE_ALLOC_UNIT_SD : STORAGE_ALLOC_UNIT_LITTLEFS;
+  return (size + unit - 1) / unit * unit;
+}
+
+static void usageTask(void* arg) {
+  while (true) {
+    uint32_t started = millis();
+    portENTER_CRITICAL(&usageLock);
+    scanDelta = 0;
+    portEXIT_CRITICAL(&usageLock);
+
+    uint64_t total, used;
+    scanUsage(total, used);
+
+    portENTER_CRITICAL(&usageLock);
+    // Writes made during the scan may or may not be in its result; counting
+    // them again errs towards less free space, and the next scan settles it
+    used = scanDelta < 0 && (uint64_t)-scanDelta > used ? 0 : used + scanDelta;
+    usageStats.lastDrift = usageKnown ? (int64_t)used - (int64_t)usageUsed : 0;
+    usageTotal = total;
+    usageUsed = used;
+    usageKnown = true;
+    usageStats.scans++;
+    usageStats.lastScanMs = millis() - started;
+    portEXIT_CRITICAL(&usageLock);
+
+    vTaskDelay(pdMS_TO_TICKS(STORAGE_USAGE_RECONCILE_MS));
+  }
+}
+
 void setupStorage() {
     // Try to initialize SD Card first
     Serial.println("Attempting to mount SD Card...");
@@ -51,12 +105,9 @@ void setupStorage() {
     }
 
     if (storageAvailable) {
-        size_t total = 0, used = 0;
-        getFilesystemInfo(total, used);
-        Serial.print("Storage Total bytes: ");
-        Serial.println(total);
-        Serial.print("Storage Used bytes: ");
-        Serial.println(used);
+        // First scan runs in the background; until it is done
+        // getFilesystemInfo() reports STORAGE_USAGE_SCANNING
+        xTaskCreatePinnedToCore(usageTask, "fs_usage", 4096, nullptr, 1, nullptr, 0);
 
         Serial.println("Storage contents:");
         File root = storageFS->open("/");
@@ -69,96 +120,37 @@ void setupStorage() {
     }
 }
 
-String getScriptFilename(String name) {
-  // Sanitize filename - remove invalid characters
-  String filename = name;
-  filename.replace(" ", "_");
-  filename.replace("/", "_");
-  filename.replace("\\", "_");
-  filename.replace("..", "_");
-
-  // Truncate if too long
-  if (filename.length() > MAX_SCRIPT_NAME_LEN) {
-    filename = filename.substring(0, MAX_SCRIPT_NAME_LEN);
-  }
-
-  return String("/scripts_") + filename + ".txt";
-}
-
-bool saveScriptToFile(String name, String script) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for saving script");
-    return false;
-  }
-
-  String filename = getScriptFilename(name);
-
-  File file = storageFS->open(filename, "w");
-  if (!file) {
-    Serial.println("Failed to open file for writing: " + filename);
-    return false;
-  }
-
-  // Write script content
-  file.print(script);
-  file.close();
-
-  Serial.println("Script saved: " + filename);
-  return true;
-}
-
-String loadScriptFromFile(String name) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for loading script");
+String readTextFile(const String& path) {
+  if (!storageAvailable || !storageFS || !storageFS->exists(path)) {
     return "";
   }
 
-  String filename = getScriptFilename(name);
-
-  File file = storageFS->open(filename, "r");
+  File file = storageFS->open(path, "r");
   if (!file) {
-    Serial.println("Failed to open file for reading: " + filename);
+    Serial.println("Failed to open file for reading: " + path);
     return "";
   }
 
-  String script = "";
-  while (file.available()) {
-    script += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
-  return script;
+  return content;
 }
 
-bool deleteScriptFile(String name) {
+bool writeTextFile(const String& path, const String& content) {
   if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for deleting script");
     return false;
   }
 
-  String filename = getScriptFilename(name);
-
-  if (storageFS->exists(filename)) {
-    storageFS->remove(filename);
-    Serial.println("Script deleted: " + filename);
-    return true;
+  File file = storageFS->open(path, "w");
+  if (!file) {
+    Serial.println("Failed to open file for writing: " + path);
+    return false;
   }
 
-  return false;
-}
-
-String getScriptNameFromFilename(String filename) {
-  // Extract name from "/scripts_<name>.txt"
-  // Remove leading slash if present
-  if (filename.startsWith("/")) filename = filename.substring(1);
-  
-  if (filename.startsWith("scripts_") && filename.endsWith(".txt")) {
-    String name = filename.substring(8); // Skip "scripts_"
-    name = name.substring(0, name.length() - 4); // Remove ".txt"
-    name.replace("_", " ");
-    return name;
-  }
-  return "";
+  size_t written = file.print(content);
+  file.close();
+  return written == content.length();
 }
 
 // Quick Actions Management Functions
@@ -172,337 +164,8 @@ String getQuickActionsFilename(String os) {
   return String("/quickactions_") + filename + ".txt";
 }
 
-bool saveQuickAction(String os, String cmd, String label, String desc, String btnClass) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for saving quick action");
-    return false;
-  }
-
-  String filename = getQuickActionsFilename(os);
-
-  // Load existing actions
-  String content = "";
-  if (storageFS->exists(filename)) {
-    File file = storageFS->open(filename, "r");
-    if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
-      file.close();
-    }
-  }
-
-  // Check if action already exists and remove it
-  String newContent = "";
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingCmd = line.substring(0, firstPipe);
-      if (existingCmd != cmd) {
-        newContent += line + "\n";
-      }
-    }
-    startPos = endPos + 1;
-  }
-  // Handle last line without newline
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingCmd = line.substring(0, firstPipe);
-      if (existingCmd != cmd) {
-        newContent += line + "\n";
-      }
-    }
-  }
-
-  // Add new action
-  newContent += cmd + "|" + label + "|" + desc + "|" + btnClass + "\n";
-
-  // Save to file
-  File file = storageFS->open(filename, "w");
-  if (!file) {
-    Serial.println("Failed to open file for writing: " + filename);
-    return false;
-  }
-
-  file.print(newContent);
-  file.close();
-
-  Serial.println("Quick action saved for " + os + ": " + cmd);
-  return true;
-}
-
-String loadQuickActions(String os) {
-  if (!storageAvailable || !storageFS) {
-    return "";
-  }
-
-  String filename = getQuickActionsFilename(os);
-
-  if (!storageFS->exists(filename)) {
-    return "";
-  }
-
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    Serial.println("Failed to open file for reading: " + filename);
-    return "";
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  return content;
-}
-
-bool deleteQuickAction(String os, String cmd) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for deleting quick action");
-    return false;
-  }
-
-  String filename = getQuickActionsFilename(os);
-
-  if (!storageFS->exists(filename)) {
-    return false;
-  }
-
-  // Load existing actions
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    return false;
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  // Remove the action
-  String newContent = "";
-  bool found = false;
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingCmd = line.substring(0, firstPipe);
-      if (existingCmd == cmd) {
-        found = true;
-      } else {
-        newContent += line + "\n";
-      }
-    }
-    startPos = endPos + 1;
-  }
-  // Handle last line
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingCmd = line.substring(0, firstPipe);
-      if (existingCmd == cmd) {
-        found = true;
-      } else {
-        newContent += line + "\n";
-      }
-    }
-  }
-
-  if (!found) {
-    return false;
-  }
-
-  // Save back to file
-  file = storageFS->open(filename, "w");
-  if (!file) {
-    return false;
-  }
-
-  file.print(newContent);
-  file.close();
-
-  Serial.println("Quick action deleted from " + os + ": " + cmd);
-  return true;
-}
-
-bool deleteAllQuickActions(String os) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available");
-    return false;
-  }
-
-  String filename = getQuickActionsFilename(os);
-
-  if (storageFS->exists(filename)) {
-    storageFS->remove(filename);
-    Serial.println("All quick actions deleted for: " + os);
-    return true;
-  }
-
-  return false;
-}
-
 // Custom OS Management Functions
 
-bool addCustomOS(String osName) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for saving custom OS");
-    return false;
-  }
-
-  String filename = "/customos.txt";
-
-  // Load existing OS list
-  String content = "";
-  if (storageFS->exists(filename)) {
-    File file = storageFS->open(filename, "r");
-    if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
-      file.close();
-    }
-  }
-
-  // Check if OS already exists
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    if (line == osName) {
-      return true; // Already exists
-    }
-    startPos = endPos + 1;
-  }
-  // Check last line
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    if (line == osName) {
-      return true;
-    }
-  }
-
-  // Add new OS
-  content += osName + "\n";
-
-  // Save to file
-  File file = storageFS->open(filename, "w");
-  if (!file) {
-    Serial.println("Failed to open file for writing: " + filename);
-    return false;
-  }
-
-  file.print(content);
-  file.close();
-
-  Serial.println("Custom OS added: " + osName);
-  return true;
-}
-
-bool deleteCustomOS(String osName) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for deleting custom OS");
-    return false;
-  }
-
-  String filename = "/customos.txt";
-
-  if (!storageFS->exists(filename)) {
-    return false;
-  }
-
-  // Load existing OS list
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    return false;
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  // Remove the OS
-  String newContent = "";
-  bool found = false;
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    if (line == osName) {
-      found = true;
-    } else if (line.length() > 0) {
-      newContent += line + "\n";
-    }
-    startPos = endPos + 1;
-  }
-  // Handle last line
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    if (line == osName) {
-      found = true;
-    } else if (line.length() > 0) {
-      newContent += line + "\n";
-    }
-  }
-
-  if (!found) {
-    return false;
-  }
-
-  // Save back to file
-  file = storageFS->open(filename, "w");
-  if (!file) {
-    return false;
-  }
-
-  file.print(newContent);
-  file.close();
-
-  // Also delete all quick actions for this OS
-  deleteAllQuickActions(osName);
-
-  Serial.println("Custom OS deleted: " + osName);
-  return true;
-}
-
-String loadCustomOSList() {
-  if (!storageAvailable || !storageFS) {
-    return "";
-  }
-
-  String filename = "/customos.txt";
-
-  if (!storageFS->exists(filename)) {
-    return "";
-  }
-
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    Serial.println("Failed to open file for reading: " + filename);
-    return "";
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  return content;
-}
-
 // Quick Scripts Management Functions
 
 String getQuickScriptsFilename(String os) {
@@ -514,190 +177,6 @@ String getQuickScriptsFilename(String os) {
   return String("/quickscripts_") + filename + ".txt";
 }
 
-bool saveQuickScript(String os, String id, String label, String script, String btnClass) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for saving quick script");
-    return false;
-  }
-
-  String filename = getQuickScriptsFilename(os);
-
-  // Load existing scripts
-  String content = "";
-  if (storageFS->exists(filename)) {
-    File file = storageFS->open(filename, "r");
-    if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
-      file.close();
-    }
-  }
-
-  // Check if script already exists and remove it
-  String newContent = "";
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingId = line.substring(0, firstPipe);
-      if (existingId != id) {
-        newContent += line + "\n";
-      }
-    }
-    startPos = endPos + 1;
-  }
-  // Handle last line
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingId = line.substring(0, firstPipe);
-      if (existingId != id) {
-        newContent += line + "\n";
-      }
-    }
-  }
-
-  // Escape newlines in script for storage
-  String escapedScript = script;
-  escapedScript.replace("\n", "\\n");
-
-  // Add new script (format: id|label|script|class)
-  newContent += id + "|" + label + "|" + escapedScript + "|" + btnClass + "\n";
-
-  // Save to file
-  File file = storageFS->open(filename, "w");
-  if (!file) {
-    Serial.println("Failed to open file for writing: " + filename);
-    return false;
-  }
-
-  file.print(newContent);
-  file.close();
-
-  Serial.println("Quick script saved for " + os + ": " + id);
-  return true;
-}
-
-String loadQuickScripts(String os) {
-  if (!storageAvailable || !storageFS) {
-    return "";
-  }
-
-  String filename = getQuickScriptsFilename(os);
-
-  if (!storageFS->exists(filename)) {
-    return "";
-  }
-
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    Serial.println("Failed to open file for reading: " + filename);
-    return "";
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  return content;
-}
-
-bool deleteQuickScript(String os, String id) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available for deleting quick script");
-    return false;
-  }
-
-  String filename = getQuickScriptsFilename(os);
-
-  if (!storageFS->exists(filename)) {
-    return false;
-  }
-
-  // Load existing scripts
-  File file = storageFS->open(filename, "r");
-  if (!file) {
-    return false;
-  }
-
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
-  file.close();
-
-  // Remove the script
-  String newContent = "";
-  bool found = false;
-  int startPos = 0;
-  int endPos;
-  while ((endPos = content.indexOf('\n', startPos)) != -1) {
-    String line = content.substring(startPos, endPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingId = line.substring(0, firstPipe);
-      if (existingId == id) {
-        found = true;
-      } else {
-        newContent += line + "\n";
-      }
-    }
-    startPos = endPos + 1;
-  }
-  // Handle last line
-  if (startPos < content.length()) {
-    String line = content.substring(startPos);
-    int firstPipe = line.indexOf('|');
-    if (firstPipe > 0) {
-      String existingId = line.substring(0, firstPipe);
-      if (existingId == id) {
-        found = true;
-      } else {
-        newContent += line + "\n";
-      }
-    }
-  }
-
-  if (!found) {
-    return false;
-  }
-
-  // Save back to file
-  file = storageFS->open(filename, "w");
-  if (!file) {
-    return false;
-  }
-
-  file.print(newContent);
-  file.close();
-
-  Serial.println("Quick script deleted from " + os + ": " + id);
-  return true;
-}
-
-bool deleteAllQuickScripts(String os) {
-  if (!storageAvailable || !storageFS) {
-    Serial.println("Storage not available");
-    return false;
-  }
-
-  String filename = getQuickScriptsFilename(os);
-
-  if (storageFS->exists(filename)) {
-    storageFS->remove(filename);
-    Serial.println("All quick scripts deleted for: " + os);
-    return true;
-  }
-
-  return false;
-}
-
 // File Management Functions
 
 String sanitizeFilename(String filename) {
@@ -726,43 +205,78 @@ String sanitizeFilename(String filename) {
   return filename;
 }
 
-bool hasAvailableSpace(size_t requiredBytes) {
+bool hasAvailableSpace(size_t requiredBytes, size_t freedBytes) {
   if (!storageAvailable || !storageFS) {
     return false;
   }
 
-  size_t totalBytes = 0;
-  size_t usedBytes = 0;
-  getFilesystemInfo(totalBytes, usedBytes);
+  uint64_t totalBytes = 0;
+  uint64_t usedBytes = 0;
+  StorageUsageState state = getFilesystemInfo(totalBytes, usedBytes);
+  // Not known until the first scan is done; a write that doesn't fit
+  // fails on its own then
+  if (state == STORAGE_USAGE_SCANNING) return true;
+  uint64_t freed = allocatedSize(freedBytes);
+  usedBytes = usedBytes > freed ? usedBytes - freed : 0;
 
-  if (totalBytes == 0) {
+  if (totalBytes == 0 || usedBytes >= totalBytes) {
     return false;
   }
 
-  size_t availableBytes = totalBytes - usedBytes;
+  uint64_t availableBytes = totalBytes - usedBytes;
 
   // Keep 10% safety margin
-  size_t safetyMargin = totalBytes / 10;
+  uint64_t safetyMargin = totalBytes / 10;
+  if (availableBytes <= safetyMargin) {
+    return false;
+  }
 
   return (availableBytes - safetyMargin) >= requiredBytes;
 }
 
-bool getFilesystemInfo(size_t &totalBytes, size_t &usedBytes) {
+StorageUsageState getFilesystemInfo(uint64_t &totalBytes, uint64_t &usedBytes) {
+  totalBytes = 0;
+  usedBytes = 0;
   if (!storageAvailable) {
-    return false;
+    return STORAGE_USAGE_UNAVAILABLE;
   }
 
-  if (usingSD) {
-     totalBytes = SD_MMC.totalBytes();
-     usedBytes = SD_MMC.usedBytes();
-  } else {
-     totalBytes = LittleFS.totalBytes();
-     usedBytes = LittleFS.usedBytes();
+  portENTER_CRITICAL(&usageLock);
+  bool known = usageKnown;
+  totalBytes = usageTotal;
+  usedBytes = usageUsed;
+  portEXIT_CRITICAL(&usageLock);
+
+  if (!known) {
+    return STORAGE_USAGE_SCANNING;
   }
+  return totalBytes > 0 ? STORAGE_USAGE_READY : STORAGE_USAGE_UNAVAILABLE;
+}
 
-  if (totalBytes == 0) {
-    return false;
+size_t storedFileSize(const String& path) {
+  if (!storageAvailable || !storageFS || !storageFS->exists(path)) return 0;
+  File file = storageFS->open(path, "r");
+  if (!file) return 0;
+  size_t size = file.isDirectory() ? 0 : file.size();
+  file.close();
+  return size;
+}
+
+void accountFileChange(size_t oldSize, size_t newSize) {
+  int64_t delta = (int64_t)allocatedSize(newSize) - (int64_t)allocatedSize(oldSize);
+  if (delta == 0) return;
+
+  portENTER_CRITICAL(&usageLock);
+  scanDelta += delta;
+  if (usageKnown) {
+    usageUsed = delta < 0 && (uint64_t)-delta > usageUsed ? 0 : usageUsed + delta;
   }
+  portEXIT_CRITICAL(&usageLock);
+}
 
-  return true;
-}
\ No newline at end of file
+StorageUsageStats getStorageUsageStats() {
+  portENTER_CRITICAL(&usageLock);
+  StorageUsageStats stats = usageStats;
+  portEXIT_CRITICAL(&usageLock);
+  return stats;
+}
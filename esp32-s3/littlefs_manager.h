@@ -5,33 +5,41 @@
 #include <FS.h>
 
 void setupStorage();
-bool saveScriptToFile(String name, String script);
-String loadScriptFromFile(String name);
-bool deleteScriptFile(String name);
-String getScriptNameFromFilename(String filename);
-String getScriptFilename(String name);
-
-// Quick actions management
-bool saveQuickAction(String os, String cmd, String label, String desc, String btnClass);
-String loadQuickActions(String os);
-bool deleteQuickAction(String os, String cmd);
-bool deleteAllQuickActions(String os);
-
-// Custom OS management
-bool addCustomOS(String osName);
-bool deleteCustomOS(String osName);
-String loadCustomOSList();
-
-// Quick scripts management
-bool saveQuickScript(String os, String id, String label, String script, String btnClass);
-String loadQuickScripts(String os);
-bool deleteQuickScript(String os, String id);
-bool deleteAllQuickScripts(String os);
+
+#define CUSTOM_OS_FILE "/customos.txt"
+
+// Whole-file text helpers
+String readTextFile(const String& path);
+bool writeTextFile(const String& path, const String& content);
+
+// Quick action / quick script files, parsed by config_cache
+String getQuickActionsFilename(String os);
+String getQuickScriptsFilename(String os);
 
 // File management functions
 String sanitizeFilename(String filename);
-bool hasAvailableSpace(size_t requiredBytes);
-bool getFilesystemInfo(size_t &totalBytes, size_t &usedBytes);
+// freedBytes: size of a file the write replaces, whose space comes back first
+bool hasAvailableSpace(size_t requiredBytes, size_t freedBytes = 0);
+enum StorageUsageState {
+  STORAGE_USAGE_UNAVAILABLE,  // No storage mounted
+  STORAGE_USAGE_SCANNING,     // First background scan not done; sizes are 0
+  STORAGE_USAGE_READY
+};
+// Served from the tracked usage; never scans the filesystem itself
+StorageUsageState getFilesystemInfo(uint64_t &totalBytes, uint64_t &usedBytes);
+
+// Usage tracking. Call accountFileChange() after writing, replacing or
+// deleting a file (newSize 0 for a delete); a background rescan every
+// STORAGE_USAGE_RECONCILE_MS corrects whatever this misses. Safe to call
+// from any task.
+struct StorageUsageStats {
+  uint32_t scans;
+  uint32_t lastScanMs;
+  int64_t lastDrift;  // Correction applied by the last rescan, in bytes
+};
+size_t storedFileSize(const String& path);
+void accountFileChange(size_t oldSize, size_t newSize);
+StorageUsageStats getStorageUsageStats();
 
 extern bool storageAvailable;
 extern bool usingSD;
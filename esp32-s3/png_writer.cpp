@@ -0,0 +1,83 @@
+#include "png_writer.h"
+#include <esp_rom_crc.h>
+#include <vector>
+
+#define ADLER_MOD 65521
+
+static void putBE32(uint8_t* p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+// One chunk: length, type, data, CRC32 over type and data
+static bool writeChunk(const char* type, const uint8_t* data, size_t len, PngSink sink, void* ctx) {
+  uint8_t head[8];
+  putBE32(head, len);
+  memcpy(head + 4, type, 4);
+  uint32_t crc = esp_rom_crc32_le(0, head + 4, 4);
+  if (len > 0) crc = esp_rom_crc32_le(crc, data, len);
+  uint8_t tail[4];
+  putBE32(tail, crc);
+  return sink(head, sizeof(head), ctx) && (len == 0 || sink(data, len, ctx)) && sink(tail, sizeof(tail), ctx);
+}
+
+bool writeRgb565Png(const uint16_t* pixels, uint16_t width, uint16_t height, bool bigEndian,
+                    PngSink sink, void* ctx) {
+  static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  if (!sink(signature, sizeof(signature), ctx)) return false;
+
+  uint8_t ihdr[13];
+  putBE32(ihdr, width);
+  putBE32(ihdr + 4, height);
+  ihdr[8] = 8;   // Bit depth
+  ihdr[9] = 2;   // Truecolor
+  ihdr[10] = 0;  // Deflate
+  ihdr[11] = 0;  // Adaptive filtering
+  ihdr[12] = 0;  // No interlace
+  if (!writeChunk("IHDR", ihdr, sizeof(ihdr), sink, ctx)) return false;
+
+  // Per IDAT: [zlib header], stored block header, filter byte, RGB row, [Adler-32]
+  size_t rowBytes = 1 + (size_t)width * 3;
+  std::vector<uint8_t> chunk;
+  chunk.reserve(2 + 5 + rowBytes + 4);
+  uint32_t adlerA = 1, adlerB = 0;
+
+  for (uint16_t y = 0; y < height; y++) {
+    chunk.clear();
+    if (y == 0) {
+      chunk.push_back(0x78);  // zlib: deflate, 32 KB window
+      chunk.push_back(0x01);  // No dictionary, check bits
+    }
+    chunk.push_back(y == height - 1 ? 1 : 0);  // BFINAL, BTYPE = stored
+    chunk.push_back(rowBytes & 0xFF);
+    chunk.push_back(rowBytes >> 8);
+    chunk.push_back(~rowBytes & 0xFF);
+    chunk.push_back((~rowBytes >> 8) & 0xFF);
+
+    size_t rowStart = chunk.size();
+    chunk.push_back(0);  // Filter: none
+    const uint16_t* row = pixels + (size_t)y * width;
+    for (uint16_t x = 0; x < width; x++) {
+      uint16_t c = bigEndian ? (uint16_t)((row[x] >> 8) | (row[x] << 8)) : row[x];
+      uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+      chunk.push_back((r << 3) | (r >> 2));
+      chunk.push_back((g << 2) | (g >> 4));
+      chunk.push_back((b << 3) | (b >> 2));
+    }
+    for (size_t i = rowStart; i < chunk.size(); i++) {
+      adlerA = (adlerA + chunk[i]) % ADLER_MOD;
+      adlerB = (adlerB + adlerA) % ADLER_MOD;
+    }
+
+    if (y == height - 1) {
+      uint8_t adler[4];
+      putBE32(adler, (adlerB << 16) | adlerA);
+      chunk.insert(chunk.end(), adler, adler + 4);
+    }
+    if (!writeChunk("IDAT", chunk.data(), chunk.size(), sink, ctx)) return false;
+  }
+
+  return writeChunk("IEND", nullptr, 0, sink, ctx);
+}
@@ -0,0 +1,17 @@
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <Arduino.h>
+
+// Minimal PNG encoder for RGB565 frames (24-bit RGB output). Rows go out
+// as stored deflate blocks, one IDAT chunk each, so nothing but the frame
+// itself is held in memory and no compressor state is needed.
+
+// Receives PNG output; returning false aborts
+typedef bool (*PngSink)(const uint8_t* data, size_t len, void* ctx);
+
+// bigEndian: pixels are in panel byte order, as TFT_eSprite stores them
+bool writeRgb565Png(const uint16_t* pixels, uint16_t width, uint16_t height, bool bigEndian,
+                    PngSink sink, void* ctx);
+
+#endif //PNG_WRITER_H
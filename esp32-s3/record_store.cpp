@@ -0,0 +1,200 @@
+#include "record_store.h"
+#include "config.h"
+#include "littlefs_manager.h"
+#include "buffered_file.h"
+#include "compressed_file.h"
+
+#define STORE_MAGIC 0x32535251     // "QRS2"
+#define STORE_MAGIC_V1 0x31535251  // "QRS1", still read
+#define STORE_COMPRESSED 0x0001    // Records region is one LZSS stream
+
+struct StoreHeader {
+  uint32_t magic;
+  uint16_t count;
+  uint16_t flags;
+};
+
+// Version 1 carried a hash index and an order table that nothing read
+struct StoreHeaderV1 {
+  uint32_t magic;
+  uint16_t slots;
+  uint16_t capacity;
+  uint16_t count;
+  uint16_t flags;
+  uint32_t dataEnd;
+  uint32_t deadBytes;
+};
+
+struct RecordHeaderV1 {
+  uint32_t hash;
+  uint16_t size;
+  uint16_t used;
+};
+
+// Payload: RECORD_FIELDS x (uint16 length + bytes)
+static bool encodeRecord(const StoredRecord& record, std::vector<uint8_t>& out) {
+  out.clear();
+  for (int i = 0; i < RECORD_FIELDS; i++) {
+    size_t len = record.fields[i].length();
+    if (out.size() + 2 + len > 0xFFFF) return false;
+    out.push_back(len & 0xFF);
+    out.push_back(len >> 8);
+    out.insert(out.end(), record.fields[i].c_str(), record.fields[i].c_str() + len);
+  }
+  return true;
+}
+
+static bool decodeRecord(const uint8_t* data, size_t len, StoredRecord& record) {
+  size_t pos = 0;
+  for (int i = 0; i < RECORD_FIELDS; i++) {
+    if (pos + 2 > len) return false;
+    size_t fieldLen = data[pos] | (data[pos + 1] << 8);
+    pos += 2;
+    if (pos + fieldLen > len) return false;
+    record.fields[i] = "";
+    record.fields[i].concat((const char*)data + pos, fieldLen);
+    pos += fieldLen;
+  }
+  return true;
+}
+
+// Reads the record at the reader's position; works on the plain file and
+// on the decompressed records region alike
+template <typename Reader>
+static bool readRecord(Reader& reader, bool v1, std::vector<uint8_t>& payload, StoredRecord& record) {
+  size_t size, used;
+  if (v1) {
+    RecordHeaderV1 rh;
+    if (reader.readBytes((uint8_t*)&rh, sizeof(rh)) != sizeof(rh) || rh.used == 0) return false;
+    size = rh.size;
+    used = rh.used;
+  } else {
+    uint16_t len;
+    if (reader.readBytes((uint8_t*)&len, sizeof(len)) != sizeof(len)) return false;
+    size = used = len;
+  }
+  payload.resize(size);
+  return reader.readBytes(payload.data(), size) == size && decodeRecord(payload.data(), used, record);
+}
+
+RecordStore::RecordStore(const String& path) : _path(path) {}
+
+String RecordStore::tempPath() const {
+  return _path + ".tmp";
+}
+
+// A snapshot is written to <path>.tmp and then moved over <path>. If the
+// old file is gone but the temp file is there, power was lost between the
+// two steps and the temp file is complete; otherwise a temp file is a
+// half-written snapshot and is dropped.
+void RecordStore::recover() const {
+  if (!storageAvailable || !storageFS || !storageFS->exists(tempPath())) return;
+  if (storageFS->exists(_path)) {
+    storageFS->remove(tempPath());
+  } else {
+    storageFS->rename(tempPath(), _path);
+    Serial.println("Recovered snapshot: " + _path);
+  }
+}
+
+bool RecordStore::exists() const {
+  recover();
+  return storageAvailable && storageFS && storageFS->exists(_path);
+}
+
+bool RecordStore::loadAll(std::vector<StoredRecord>& out) {
+  out.clear();
+  if (!exists()) return false;
+
+  File file = storageFS->open(_path, "r");
+  if (!file) return false;
+
+  StoreHeader header;
+  size_t recordsStart = sizeof(header);
+  bool v1 = false;
+  bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header);
+  if (ok && header.magic == STORE_MAGIC_V1) {
+    StoreHeaderV1 old;
+    ok = file.seek(0) && file.read((uint8_t*)&old, sizeof(old)) == sizeof(old) && old.count <= old.capacity;
+    header.count = old.count;
+    header.flags = old.flags;
+    // Records follow the index and order table, already in display order
+    recordsStart = sizeof(old) + (old.slots + old.capacity) * sizeof(uint32_t);
+    v1 = true;
+  } else {
+    ok = ok && header.magic == STORE_MAGIC;
+  }
+  ok = ok && header.count <= RECORD_STORE_MAX && file.seek(recordsStart);
+  if (!ok) {
+    Serial.println("Record store corrupt: " + _path);
+    file.close();
+    return false;
+  }
+
+  std::vector<uint8_t> payload;
+  StoredRecord record;
+  if (header.flags & STORE_COMPRESSED) {
+    CompressedFileReader reader(file);
+    while (out.size() < header.count && readRecord(reader, v1, payload, record)) out.push_back(record);
+  } else {
+    BufferedFileReader reader(file);
+    while (out.size() < header.count && readRecord(reader, v1, payload, record)) out.push_back(record);
+  }
+  file.close();
+  return true;
+}
+
+bool RecordStore::rewrite(const std::vector<StoredRecord>& records, size_t* written) {
+  if (!storageAvailable || !storageFS) return false;
+  if (records.size() > RECORD_STORE_MAX) return false;
+
+  StoreHeader header = { STORE_MAGIC, (uint16_t)records.size(), 0 };
+  std::vector<uint8_t> region;
+  std::vector<uint8_t> payload;
+  for (const auto& record : records) {
+    if (!encodeRecord(record, payload)) return false;
+    uint16_t len = payload.size();
+    region.insert(region.end(), (const uint8_t*)&len, (const uint8_t*)&len + sizeof(len));
+    region.insert(region.end(), payload.begin(), payload.end());
+  }
+
+  // Only the records region is packed, into one stream, and only if that
+  // makes it smaller
+  std::vector<uint8_t> packed;
+  if (compressionEnabled()) {
+    lzssCompress(region.data(), region.size(), packed);
+    if (packed.size() < region.size()) {
+      header.flags |= STORE_COMPRESSED;
+      region.swap(packed);
+    }
+  }
+
+  File file = storageFS->open(tempPath(), "w");
+  if (!file) {
+    Serial.println("Failed to open file for writing: " + tempPath());
+    return false;
+  }
+  bool ok;
+  {
+    BufferedFileWriter writer(file);
+    writer.write((const uint8_t*)&header, sizeof(header));
+    writer.write(region.data(), region.size());
+    ok = writer.flush();
+  }
+  file.close();
+
+  if (!ok) {
+    storageFS->remove(tempPath());
+    return false;
+  }
+  if (storageFS->exists(_path)) storageFS->remove(_path);
+  if (!storageFS->rename(tempPath(), _path)) return false;
+
+  if (written) *written = sizeof(header) + region.size();
+  return true;
+}
+
+bool RecordStore::erase() {
+  if (!exists()) return false;
+  return storageFS->remove(_path);
+}
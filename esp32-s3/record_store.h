@@ -0,0 +1,41 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define RECORD_FIELDS 4
+
+// One stored entry; fields[0] is the key (quick action cmd / quick script id)
+struct StoredRecord {
+  String fields[RECORD_FIELDS];
+};
+
+// Binary record file used as the snapshot of a quick action or quick
+// script list (edits in between go to the config journal). Lists are only
+// ever loaded whole, so records are simply stored in display order.
+//
+// Layout:
+//   header | records (uint16 size + fields), optionally one LZSS stream
+//
+// Snapshots are written whole to a temp file and renamed into place, so a
+// reader sees either the old or the new list, never a mix.
+class RecordStore {
+public:
+  explicit RecordStore(const String& path);
+
+  bool exists() const;
+  // Records in display order
+  bool loadAll(std::vector<StoredRecord>& out);
+  // Atomically replaces the file; written receives the bytes written
+  bool rewrite(const std::vector<StoredRecord>& records, size_t* written = nullptr);
+  bool erase();
+
+private:
+  String tempPath() const;
+  void recover() const;
+
+  String _path;
+};
+
+#endif //RECORD_STORE_H
@@ -0,0 +1,98 @@
+#include "request_router.h"
+
+RequestContext currentRequest = { nullptr, nullptr, 0 };
+uint32_t totalRequests = 0;
+
+// Shared by every listener, since they all dispatch the same table
+static RouteStats routeStats[ROUTE_BUCKETS];
+
+// Iterative twin of routeHash() for request URIs (avoids recursion at runtime)
+static uint32_t hashUri(const char* s) {
+  uint32_t h = 2166136261u;
+  while (*s) {
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  }
+  return h;
+}
+
+void beginRequest(WebServer& server, const Route* route) {
+  currentRequest.server = &server;
+  currentRequest.route = route;
+  currentRequest.startedAt = micros();
+  totalRequests++;
+}
+
+const RouteStats& getRouteStats(size_t index) {
+  return routeStats[index < ROUTE_BUCKETS ? index : 0];
+}
+
+RouteTableHandler::RouteTableHandler(const Route* routes, size_t count)
+  : _routes(routes), _count(count), _matched(nullptr), _uploadStarted(false) {
+  memset(_buckets, 0, sizeof(_buckets));
+
+  // Build the open-addressing index from the precomputed hashes
+  for (size_t i = 0; i < _count && i < ROUTE_BUCKETS - 1; i++) {
+    uint32_t slot = _routes[i].hash & (ROUTE_BUCKETS - 1);
+    while (_buckets[slot] != 0) {
+      slot = (slot + 1) & (ROUTE_BUCKETS - 1);
+    }
+    _buckets[slot] = i + 1;
+  }
+}
+
+const Route* RouteTableHandler::find(HTTPMethod method, const String& uri) const {
+  uint32_t hash = hashUri(uri.c_str());
+  uint32_t slot = hash & (ROUTE_BUCKETS - 1);
+
+  while (_buckets[slot] != 0) {
+    const Route* route = &_routes[_buckets[slot] - 1];
+    if (route->hash == hash && route->method == method && uri.equals(route->path)) {
+      return route;
+    }
+    slot = (slot + 1) & (ROUTE_BUCKETS - 1);
+  }
+  return nullptr;
+}
+
+bool RouteTableHandler::canHandle(HTTPMethod method, String uri) {
+  // Called once while the request line is parsed; remember the match
+  // so handle() and upload() don't have to look it up again
+  _matched = find(method, uri);
+  return _matched != nullptr;
+}
+
+bool RouteTableHandler::canUpload(String uri) {
+  return _matched != nullptr && _matched->upload != nullptr;
+}
+
+bool RouteTableHandler::handle(WebServer& server, HTTPMethod requestMethod, String requestUri) {
+  if (!_matched) return false;
+
+  // Uploads are timed from their first chunk
+  if (_uploadStarted) {
+    currentRequest.server = &server;
+    _uploadStarted = false;
+  } else {
+    beginRequest(server, _matched);
+  }
+  _matched->handler();
+
+  uint32_t elapsed = micros() - currentRequest.startedAt;
+  RouteStats& stats = routeStats[_matched - _routes];
+  stats.count++;
+  stats.totalMicros += elapsed;
+  if (elapsed > stats.maxMicros) stats.maxMicros = elapsed;
+
+  _matched = nullptr;
+  return true;
+}
+
+void RouteTableHandler::upload(WebServer& server, String requestUri, HTTPUpload& upload) {
+  if (!_matched || !_matched->upload) return;
+
+  if (upload.status == UPLOAD_FILE_START) {
+    beginRequest(server, _matched);
+    _uploadStarted = true;
+  }
+  _matched->upload();
+}
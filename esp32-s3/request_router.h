@@ -0,0 +1,70 @@
+#ifndef REQUEST_ROUTER_H
+#define REQUEST_ROUTER_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+// Number of hash buckets in the route index (power of two, >= 2x route count)
+#define ROUTE_BUCKETS 128
+
+// FNV-1a hash, evaluated at compile time for the route table literals
+constexpr uint32_t routeHash(const char* s, uint32_t h = 2166136261u) {
+  return *s ? routeHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+typedef void (*RouteHandlerFn)();
+
+struct Route {
+  const char* path;
+  uint32_t hash;
+  HTTPMethod method;
+  RouteHandlerFn handler;
+  RouteHandlerFn upload;  // Multipart upload callback (nullptr if none)
+};
+
+// Declare a route once; the path hash is computed by the compiler
+#define ROUTE(path, method, handler) { path, routeHash(path), method, handler, nullptr }
+#define UPLOAD_ROUTE(path, method, handler, upload) { path, routeHash(path), method, handler, upload }
+
+// Per-request context, resolved once when the request is dispatched.
+// Handlers use it instead of asking each listener whether it owns the client.
+struct RequestContext {
+  WebServer* server;
+  const Route* route;
+  unsigned long startedAt;  // micros()
+};
+
+// Per-route counters, indexed like the route table
+struct RouteStats {
+  uint32_t count;
+  uint64_t totalMicros;
+  uint32_t maxMicros;
+};
+
+extern RequestContext currentRequest;
+extern uint32_t totalRequests;
+
+// Single dispatcher for the static route table, attached to every listener
+class RouteTableHandler : public RequestHandler {
+public:
+  RouteTableHandler(const Route* routes, size_t count);
+
+  bool canHandle(HTTPMethod method, String uri) override;
+  bool canUpload(String uri) override;
+  bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) override;
+  void upload(WebServer& server, String requestUri, HTTPUpload& upload) override;
+
+private:
+  const Route* find(HTTPMethod method, const String& uri) const;
+
+  const Route* _routes;
+  size_t _count;
+  uint8_t _buckets[ROUTE_BUCKETS];  // Route index + 1, 0 = empty
+  const Route* _matched;
+  bool _uploadStarted;
+};
+
+void beginRequest(WebServer& server, const Route* route);
+const RouteStats& getRouteStats(size_t index);
+
+#endif //REQUEST_ROUTER_H
@@ -0,0 +1,427 @@
+#include "script_manifest.h"
+#include <esp_rom_crc.h>
+#include <time.h>
+#include "config.h"
+#include "littlefs_manager.h"
+#include "buffered_file.h"
+#include "compressed_file.h"
+#include "dir_listing.h"
+#include "block_cache.h"
+
+static std::vector<ScriptInfo> scripts;
+
+// Name as used before scripts moved to /scripts/: "/scripts_<name>.txt",
+// spaces stored as underscores
+static String legacyScriptName(String filename) {
+  int slash = filename.lastIndexOf('/');
+  if (slash >= 0) filename = filename.substring(slash + 1);
+  if (!filename.startsWith("scripts_") || !filename.endsWith(".txt")) return "";
+  String name = filename.substring(8, filename.length() - 4);
+  name.replace("_", " ");
+  return name;
+}
+
+// The manifest is tab-separated, so names can't hold tabs or newlines
+static String cleanName(String name) {
+  name.replace("\t", " ");
+  name.replace("\r", " ");
+  name.replace("\n", " ");
+  return name;
+}
+
+static ScriptInfo* findEntry(const String& name) {
+  for (auto& script : scripts) {
+    if (script.name == name) return &script;
+  }
+  return nullptr;
+}
+
+static bool fileTaken(const String& file) {
+  if (file == SCRIPT_MANIFEST_FILE) return true;
+  for (const auto& script : scripts) {
+    if (script.file == file) return true;
+  }
+  return false;
+}
+
+// Extension new script files get: ".lzs" when they are stored compressed
+static const char* scriptExtension() {
+  return compressionEnabled() ? ".lzs" : ".txt";
+}
+
+static bool isScriptFile(const String& filename) {
+  return filename.endsWith(".txt") || filename.endsWith(".lzs");
+}
+
+// A readable file name for a new script; the manifest holds the real name
+static String newFileFor(const String& name, const char* extension) {
+  String base;
+  for (size_t i = 0; i < name.length() && base.length() < MAX_SCRIPT_NAME_LEN; i++) {
+    char c = name[i];
+    base += (isalnum(c) || c == '-' || c == '.') ? c : '_';
+  }
+  if (base.length() == 0) base = "script";
+
+  String file = String(SCRIPTS_DIR) + "/" + base + extension;
+  for (int n = 2; fileTaken(file) || storageFS->exists(file); n++) {
+    file = String(SCRIPTS_DIR) + "/" + base + "_" + String(n) + extension;
+  }
+  return file;
+}
+
+// The hash covers the script text, so it doesn't change with the storage
+// format; size is what the file takes on disk
+static bool hashFile(const String& path, ScriptInfo& info) {
+  File file = storageFS->open(path, "r");
+  if (!file || file.isDirectory()) return false;
+
+  uint32_t crc = 0;
+  {
+    CompressedFileReader reader(file);
+    uint8_t buffer[512];
+    size_t n;
+    while ((n = reader.readBytes(buffer, sizeof(buffer))) > 0) {
+      crc = esp_rom_crc32_le(crc, buffer, n);
+    }
+  }
+  info.size = file.size();
+  info.hash = crc;
+  info.modified = file.getLastWrite();
+  file.close();
+  return true;
+}
+
+static bool saveManifest() {
+  String tempPath = String(SCRIPT_MANIFEST_FILE) + ".tmp";
+  File file = storageFS->open(tempPath, "w");
+  if (!file) {
+    Serial.println("Failed to open file for writing: " + tempPath);
+    return false;
+  }
+  bool ok;
+  {
+    BufferedFileWriter writer(file);
+    for (const auto& script : scripts) {
+      writer.print(script.name + "\t" + script.file + "\t" + String(script.size) + "\t" +
+                   String(script.hash, HEX) + "\t" + String(script.modified) + "\n");
+    }
+    ok = writer.flush();
+  }
+  file.close();
+
+  if (!ok) {
+    storageFS->remove(tempPath);
+    return false;
+  }
+  if (storageFS->exists(SCRIPT_MANIFEST_FILE)) storageFS->remove(SCRIPT_MANIFEST_FILE);
+  return storageFS->rename(tempPath, SCRIPT_MANIFEST_FILE);
+}
+
+static bool loadManifest() {
+  String tempPath = String(SCRIPT_MANIFEST_FILE) + ".tmp";
+  if (!storageFS->exists(SCRIPT_MANIFEST_FILE) && storageFS->exists(tempPath)) {
+    storageFS->rename(tempPath, SCRIPT_MANIFEST_FILE);
+  }
+  if (!storageFS->exists(SCRIPT_MANIFEST_FILE)) return false;
+
+  File file = storageFS->open(SCRIPT_MANIFEST_FILE, "r");
+  if (!file) return false;
+  {
+    BufferedFileReader reader(file);
+    String line;
+    while (reader.readLine(line)) {
+      // Manifests from earlier builds have a sixth, always empty column
+      String fields[5];
+      int start = 0;
+      for (int i = 0; i < 5; i++) {
+        int tab = line.indexOf('\t', start);
+        fields[i] = tab >= 0 ? line.substring(start, tab) : line.substring(start);
+        start = tab + 1;
+        if (tab < 0) break;
+      }
+      if (fields[0].length() == 0 || fields[1].length() == 0) continue;
+      scripts.push_back({ fields[0], fields[1], (uint32_t)fields[2].toInt(),
+                          (uint32_t)strtoul(fields[3].c_str(), nullptr, 16),
+                          (uint32_t)strtoul(fields[4].c_str(), nullptr, 10) });
+    }
+  }
+  file.close();
+  return true;
+}
+
+// One-time O(#files) pass: older firmware kept scripts in the root
+static void migrateScripts() {
+  File root = storageFS->open("/");
+  std::vector<String> legacy;
+  File file = root.openNextFile();
+  while (file) {
+    String filename = file.name();
+    if (!file.isDirectory() && legacyScriptName(filename).length() > 0) {
+      legacy.push_back(filename.startsWith("/") ? filename : "/" + filename);
+    }
+    file = root.openNextFile();
+  }
+  root.close();
+
+  for (const auto& oldPath : legacy) {
+    ScriptInfo info = { legacyScriptName(oldPath), "", 0, 0, 0 };
+    if (findEntry(info.name)) continue;
+    info.file = newFileFor(info.name, ".txt");
+    if (!storageFS->rename(oldPath, info.file) || !hashFile(info.file, info)) continue;
+    scripts.push_back(info);
+    Serial.println("Moved script " + oldPath + " -> " + info.file);
+  }
+
+  // Scripts in /scripts/ that a lost manifest no longer mentions
+  File dir = storageFS->open(SCRIPTS_DIR);
+  file = dir.openNextFile();
+  while (file) {
+    String filename = file.name();
+    int slash = filename.lastIndexOf('/');
+    if (slash >= 0) filename = filename.substring(slash + 1);
+    String path = String(SCRIPTS_DIR) + "/" + filename;
+    if (!file.isDirectory() && isScriptFile(filename) && !fileTaken(path)) {
+      ScriptInfo info = { filename.substring(0, filename.length() - 4), path, 0, 0, 0 };
+      if (!findEntry(info.name)) {
+        info.size = file.size();
+        scripts.push_back(info);
+      }
+    }
+    file = dir.openNextFile();
+  }
+  dir.close();
+
+  for (auto& script : scripts) {
+    if (script.hash == 0) hashFile(script.file, script);
+  }
+}
+
+// Finishes a save cut short between removing the old file and renaming
+// the new one; a temp file next to a complete script is dropped
+static bool recoverSaves() {
+  bool changed = false;
+  for (auto& script : scripts) {
+    String tempPath = script.file + ".tmp";
+    if (!storageFS->exists(tempPath)) continue;
+    if (storageFS->exists(script.file)) {
+      storageFS->remove(tempPath);
+    } else if (storageFS->rename(tempPath, script.file) && hashFile(script.file, script)) {
+      Serial.println("Recovered script save: " + script.file);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void setupScriptManifest() {
+  scripts.clear();
+  if (!storageAvailable || !storageFS) return;
+
+  if (!storageFS->exists(SCRIPTS_DIR)) storageFS->mkdir(SCRIPTS_DIR);
+
+  if (!loadManifest()) {
+    migrateScripts();
+    saveManifest();
+    invalidateDirListing("/");
+  } else if (recoverSaves()) {
+    saveManifest();
+  }
+  Serial.println("Script manifest: " + String(scripts.size()) + " scripts");
+}
+
+const std::vector<ScriptInfo>& getScriptList() {
+  return scripts;
+}
+
+const ScriptInfo* findScript(const String& name) {
+  return findEntry(cleanName(name));
+}
+
+bool saveScriptToFile(String name, String script) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for saving script");
+    return false;
+  }
+
+  name = cleanName(name);
+  ScriptInfo* entry = findEntry(name);
+  bool compress = compressionEnabled();
+  // A script saved before the storage format changed moves to a file with
+  // the matching extension
+  bool moved = entry && !entry->file.endsWith(scriptExtension());
+  String filename = entry && !moved ? entry->file : newFileFor(name, scriptExtension());
+  size_t oldSize = entry ? entry->size : 0;
+
+  // Written beside the old file and renamed over it, so a failed or cut
+  // short save leaves the previous version in place
+  String tempPath = filename + ".tmp";
+  size_t written = writeStoredFile(tempPath, (const uint8_t*)script.c_str(), script.length(), compress);
+  if (written == 0 && script.length() > 0) {
+    storageFS->remove(tempPath);
+    return false;
+  }
+  if (storageFS->exists(filename)) storageFS->remove(filename);
+  if (!storageFS->rename(tempPath, filename)) {
+    Serial.println("Failed to move " + tempPath + " into place");
+    if (entry && !moved) {
+      // The old file is gone; recoverSaves() puts this one in its place
+      // at the next boot
+      accountFileChange(oldSize, written);
+      invalidateDirListing(filename);
+      invalidateBlockCache(filename);
+    } else {
+      storageFS->remove(tempPath);
+    }
+    return false;
+  }
+  if (moved) {
+    storageFS->remove(entry->file);
+    invalidateDirListing(entry->file);
+    invalidateBlockCache(entry->file);
+    entry->file = filename;
+  }
+  accountFileChange(oldSize, written);
+  invalidateDirListing(filename);
+  invalidateBlockCache(filename);
+
+  uint32_t hash = esp_rom_crc32_le(0, (const uint8_t*)script.c_str(), script.length());
+  if (!entry) {
+    scripts.push_back({ name, filename, 0, 0, 0 });
+    entry = &scripts.back();
+  }
+  entry->size = written;
+  entry->hash = hash;
+  entry->modified = time(nullptr);
+  if (!saveManifest()) return false;
+
+  Serial.println("Script saved: " + filename);
+  return true;
+}
+
+bool adoptScriptFile(String name, const String& tempPath) {
+  if (!storageAvailable || !storageFS) return false;
+
+  name = cleanName(name);
+  ScriptInfo* entry = findEntry(name);
+  size_t oldSize = 0;
+  if (entry) {
+    oldSize = entry->size;
+    storageFS->remove(entry->file);
+    invalidateDirListing(entry->file);
+    invalidateBlockCache(entry->file);
+  } else {
+    scripts.push_back({ name, "", 0, 0, 0 });
+    entry = &scripts.back();
+  }
+
+  // The content is plain text; it moves to the compressed format on its
+  // next save
+  entry->file = "";
+  entry->file = newFileFor(name, ".txt");
+  if (!storageFS->rename(tempPath, entry->file) || !hashFile(entry->file, *entry)) {
+    accountFileChange(oldSize, 0);
+    scripts.erase(scripts.begin() + (entry - scripts.data()));
+    saveManifest();
+    return false;
+  }
+  accountFileChange(oldSize, entry->size);
+  invalidateDirListing(entry->file);
+  invalidateBlockCache(entry->file);
+  return saveManifest();
+}
+
+// Script files sit directly in /scripts/; subfolders aren't scripts
+static bool inScriptsDir(const String& path) {
+  return path.startsWith(String(SCRIPTS_DIR) + "/") && path.lastIndexOf('/') == (int)strlen(SCRIPTS_DIR);
+}
+
+void scriptFileWritten(const String& path) {
+  if (!storageAvailable || !storageFS) return;
+
+  // A manifest put there by hand becomes the index
+  if (path == SCRIPT_MANIFEST_FILE) {
+    scripts.clear();
+    loadManifest();
+    Serial.println("Script manifest replaced: " + String(scripts.size()) + " scripts");
+    return;
+  }
+  if (!inScriptsDir(path) || !isScriptFile(path)) return;
+
+  ScriptInfo* entry = nullptr;
+  for (auto& script : scripts) {
+    if (script.file == path) entry = &script;
+  }
+  if (!entry) {
+    String base = cleanName(path.substring(strlen(SCRIPTS_DIR) + 1, path.length() - 4));
+    String name = base;
+    for (int n = 2; findEntry(name); n++) name = base + " (" + String(n) + ")";
+    scripts.push_back({ name, path, 0, 0, 0 });
+    entry = &scripts.back();
+  }
+
+  if (!hashFile(path, *entry)) {
+    scripts.erase(scripts.begin() + (entry - scripts.data()));
+  }
+  saveManifest();
+}
+
+void scriptFileRemoved(const String& path) {
+  if (!storageAvailable || !storageFS) return;
+
+  // Written back from RAM, so deleting it loses nothing
+  if (path == SCRIPT_MANIFEST_FILE) {
+    saveManifest();
+    return;
+  }
+
+  for (size_t i = 0; i < scripts.size(); i++) {
+    if (scripts[i].file != path) continue;
+    Serial.println("Script removed by file manager: " + scripts[i].name);
+    scripts.erase(scripts.begin() + i);
+    saveManifest();
+    return;
+  }
+}
+
+String loadScriptFromFile(String name) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for loading script");
+    return "";
+  }
+
+  const ScriptInfo* entry = findScript(name);
+  if (!entry) return "";
+
+  CachedFile file(entry->file);
+  if (!file) {
+    Serial.println("Failed to open file for reading: " + entry->file);
+    return "";
+  }
+
+  return CompressedFileReader(file).readAll();
+}
+
+bool deleteScriptFile(String name) {
+  if (!storageAvailable || !storageFS) {
+    Serial.println("Storage not available for deleting script");
+    return false;
+  }
+
+  name = cleanName(name);
+  for (size_t i = 0; i < scripts.size(); i++) {
+    if (scripts[i].name != name) continue;
+
+    String filename = scripts[i].file;
+    storageFS->remove(filename);
+    accountFileChange(scripts[i].size, 0);
+    invalidateDirListing(filename);
+    invalidateBlockCache(filename);
+
+    scripts.erase(scripts.begin() + i);
+    saveManifest();
+    Serial.println("Script deleted: " + filename);
+    return true;
+  }
+
+  return false;
+}
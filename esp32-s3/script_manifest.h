@@ -0,0 +1,45 @@
+#ifndef SCRIPT_MANIFEST_H
+#define SCRIPT_MANIFEST_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define SCRIPTS_DIR "/scripts"
+#define SCRIPT_MANIFEST_FILE "/scripts/manifest.txt"
+
+// Saved scripts live in /scripts/ and are indexed by /scripts/manifest.txt,
+// which is loaded into RAM at boot. Listing and lookup use the manifest
+// and never scan a directory; the script name is stored as typed, so
+// lookups no longer depend on how it maps to a file name.
+
+struct ScriptInfo {
+  String name;
+  String file;        // e.g. "/scripts/my_script.txt"
+  uint32_t size;
+  uint32_t hash;      // CRC32 of the content
+  uint32_t modified;  // File timestamp (device clock)
+};
+
+// Loads the manifest; moves old /scripts_<name>.txt files from the root
+// into /scripts/ the first time
+void setupScriptManifest();
+
+const std::vector<ScriptInfo>& getScriptList();
+const ScriptInfo* findScript(const String& name);
+
+bool saveScriptToFile(String name, String script);
+String loadScriptFromFile(String name);
+bool deleteScriptFile(String name);
+// Registers a complete plain-text file (e.g. from a restore) as the
+// script name, replacing any script of that name. tempPath is moved into
+// /scripts/.
+bool adoptScriptFile(String name, const String& tempPath);
+
+// Hooks for the file manager, whose uploads and deletes bypass the
+// functions above. A script file written straight into /scripts/ is
+// indexed (or re-hashed) under its file name; a removed one is dropped.
+// Other paths are ignored.
+void scriptFileWritten(const String& path);
+void scriptFileRemoved(const String& path);
+
+#endif //SCRIPT_MANIFEST_H
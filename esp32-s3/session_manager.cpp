@@ -0,0 +1,150 @@
+#include "session_manager.h"
+#include <esp_system.h>
+#include <esp_timer.h>
+#include "mbedtls/md.h"
+#include "config.h"
+
+#define SESSION_ID_LEN 8
+#define SESSION_MAC_LEN 16
+#define SESSION_RAW_LEN (SESSION_ID_LEN + 4 + SESSION_MAC_LEN)
+
+// Token layout (hex encoded): id[8] | expiry seconds (LE)[4] | HMAC-SHA256[16]
+struct Session {
+  uint8_t id[SESSION_ID_LEN];
+  uint32_t expires;  // Seconds since boot
+  bool active;
+};
+
+static Session sessions[SESSION_SLOTS];
+static uint8_t sessionKey[32];
+
+static uint32_t nowSeconds() {
+  return (uint32_t)(esp_timer_get_time() / 1000000ULL);
+}
+
+static void signSession(const uint8_t* id, uint32_t expires, uint8_t* mac) {
+  uint8_t message[SESSION_ID_LEN + 4];
+  memcpy(message, id, SESSION_ID_LEN);
+  memcpy(message + SESSION_ID_LEN, &expires, 4);
+
+  uint8_t digest[32];
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                  sessionKey, sizeof(sessionKey), message, sizeof(message), digest);
+  memcpy(mac, digest, SESSION_MAC_LEN);
+}
+
+static String toHex(const uint8_t* data, size_t len) {
+  static const char digits[] = "0123456789abcdef";
+  String hex;
+  hex.reserve(len * 2);
+  for (size_t i = 0; i < len; i++) {
+    hex += digits[data[i] >> 4];
+    hex += digits[data[i] & 0x0F];
+  }
+  return hex;
+}
+
+static bool fromHex(const String& hex, uint8_t* out, size_t len) {
+  if (hex.length() != len * 2) return false;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t value = 0;
+    for (int n = 0; n < 2; n++) {
+      char c = hex.charAt(i * 2 + n);
+      value <<= 4;
+      if (c >= '0' && c <= '9') value |= c - '0';
+      else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+      else return false;
+    }
+    out[i] = value;
+  }
+  return true;
+}
+
+bool constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t len) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < len; i++) {
+    diff |= a[i] ^ b[i];
+  }
+  return diff == 0;
+}
+
+void setupSessions() {
+  // A fresh key per boot invalidates every token issued before a restart
+  esp_fill_random(sessionKey, sizeof(sessionKey));
+  memset(sessions, 0, sizeof(sessions));
+}
+
+String createSession() {
+  uint32_t now = nowSeconds();
+
+  // Reuse a free or expired slot, otherwise evict the one closest to expiry
+  int slot = 0;
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (!sessions[i].active || sessions[i].expires <= now) {
+      slot = i;
+      break;
+    }
+    if (sessions[i].expires < sessions[slot].expires) {
+      slot = i;
+    }
+  }
+
+  Session& session = sessions[slot];
+  esp_fill_random(session.id, SESSION_ID_LEN);
+  session.expires = now + SESSION_TTL_SECONDS;
+  session.active = true;
+
+  uint8_t raw[SESSION_RAW_LEN];
+  memcpy(raw, session.id, SESSION_ID_LEN);
+  memcpy(raw + SESSION_ID_LEN, &session.expires, 4);
+  signSession(session.id, session.expires, raw + SESSION_ID_LEN + 4);
+
+  return toHex(raw, sizeof(raw));
+}
+
+bool validateSession(const String& token) {
+  uint8_t raw[SESSION_RAW_LEN];
+  if (!fromHex(token, raw, sizeof(raw))) return false;
+
+  uint32_t expires;
+  memcpy(&expires, raw + SESSION_ID_LEN, 4);
+  if (expires <= nowSeconds()) return false;
+
+  uint8_t mac[SESSION_MAC_LEN];
+  signSession(raw, expires, mac);
+  if (!constantTimeEquals(mac, raw + SESSION_ID_LEN + 4, SESSION_MAC_LEN)) return false;
+
+  // Scan every slot so the lookup takes the same time wherever the match is
+  bool found = false;
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    bool match = constantTimeEquals(sessions[i].id, raw, SESSION_ID_LEN);
+    found |= match && sessions[i].active && sessions[i].expires == expires;
+  }
+  return found;
+}
+
+void revokeSession(const String& token) {
+  uint8_t raw[SESSION_RAW_LEN];
+  if (!fromHex(token, raw, sizeof(raw))) return;
+
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (sessions[i].active && constantTimeEquals(sessions[i].id, raw, SESSION_ID_LEN)) {
+      sessions[i].active = false;
+    }
+  }
+}
+
+String getSessionFromCookie(const String& cookieHeader) {
+  String prefix = String(SESSION_COOKIE) + "=";
+  int start = cookieHeader.indexOf(prefix);
+
+  // Make sure we matched a whole cookie name, not a suffix of another one
+  while (start > 0 && cookieHeader.charAt(start - 1) != ' ' && cookieHeader.charAt(start - 1) != ';') {
+    start = cookieHeader.indexOf(prefix, start + 1);
+  }
+  if (start < 0) return "";
+
+  start += prefix.length();
+  int end = cookieHeader.indexOf(';', start);
+  return end < 0 ? cookieHeader.substring(start) : cookieHeader.substring(start, end);
+}
@@ -0,0 +1,18 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include <Arduino.h>
+
+void setupSessions();
+
+// Issues a new signed token, evicting the oldest session if the table is full
+String createSession();
+bool validateSession(const String& token);
+void revokeSession(const String& token);
+
+// Extracts the session token from a Cookie header ("" if absent)
+String getSessionFromCookie(const String& cookieHeader);
+
+bool constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t len);
+
+#endif //SESSION_MANAGER_H
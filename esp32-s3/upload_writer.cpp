@@ -0,0 +1,83 @@
+#include "upload_writer.h"
+#include "config.h"
+#include "littlefs_manager.h"
+
+UploadWriter::UploadWriter()
+  : _buffer(nullptr), _capacity(0), _used(0), _written(0),
+    _startedAt(0), _elapsedMs(0), _active(false), _failed(false) {}
+
+bool UploadWriter::begin(File file) {
+  if (_active) abort();
+
+  size_t capacity = usingSD ? UPLOAD_BUFFER_SD : UPLOAD_BUFFER_LITTLEFS;
+
+  _buffer = psramFound() ? (uint8_t*)ps_malloc(capacity) : nullptr;
+  if (!_buffer) {
+    // No PSRAM: fall back to a smaller internal RAM buffer
+    capacity = UPLOAD_BUFFER_FALLBACK;
+    _buffer = (uint8_t*)malloc(capacity);
+  }
+  if (!_buffer) return false;
+  _capacity = capacity;
+
+  _file = file;
+  _used = 0;
+  _written = 0;
+  _elapsedMs = 0;
+  _startedAt = millis();
+  _failed = false;
+  _active = true;
+  return true;
+}
+
+bool UploadWriter::flush() {
+  if (_used == 0) return true;
+  // Only what reached storage counts, a short write included
+  size_t n = _file.write(_buffer, _used);
+  if (n != _used) {
+    _failed = true;
+  }
+  _written += n;
+  _used = 0;
+  return !_failed;
+}
+
+bool UploadWriter::write(const uint8_t* data, size_t len) {
+  if (!_active || _failed) return false;
+
+  while (len > 0) {
+    size_t space = _capacity - _used;
+    size_t n = len < space ? len : space;
+    memcpy(_buffer + _used, data, n);
+    _used += n;
+    data += n;
+    len -= n;
+
+    // Only full buffers hit storage, so every write but the last is
+    // a whole multiple of the sector/page size
+    if (_used == _capacity && !flush()) return false;
+  }
+  return true;
+}
+
+bool UploadWriter::finish() {
+  if (!_active) return false;
+  bool ok = flush();
+  _file.close();
+  release();
+  return ok && !_failed;
+}
+
+void UploadWriter::abort() {
+  if (!_active) return;
+  _file.close();
+  release();
+}
+
+void UploadWriter::release() {
+  free(_buffer);
+  _buffer = nullptr;
+  _used = 0;
+  _elapsedMs = millis() - _startedAt;
+  _active = false;
+}
@@ -0,0 +1,43 @@
+#ifndef UPLOAD_WRITER_H
+#define UPLOAD_WRITER_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Coalesces small upload chunks into large writes to the storage backend.
+// Writes are synchronous: a full buffer is written from inside write(), in
+// the request handler, and finish() writes the rest. The buffer is taken
+// from PSRAM when available in begin() and freed when the upload ends;
+// nothing is preallocated on storage.
+class UploadWriter {
+public:
+  UploadWriter();
+
+  // Takes ownership of an open file; returns false if no buffer could be allocated
+  bool begin(File file);
+  bool write(const uint8_t* data, size_t len);
+  // Flushes the remaining bytes and closes the file
+  bool finish();
+  // Closes the file without flushing (caller removes the partial file)
+  void abort();
+
+  bool active() const { return _active; }
+  size_t bytesWritten() const { return _written; }  // Bytes storage accepted
+  uint32_t elapsedMs() const { return _elapsedMs; }
+
+private:
+  bool flush();
+  void release();
+
+  File _file;
+  uint8_t* _buffer;
+  size_t _capacity;
+  size_t _used;
+  size_t _written;
+  unsigned long _startedAt;
+  uint32_t _elapsedMs;
+  bool _active;
+  bool _failed;
+};
+
+#endif //UPLOAD_WRITER_H
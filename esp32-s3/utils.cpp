@@ -27,3 +27,85 @@ String escapeJson(String str) {
   }
   return result;
 }
+
+// Parses a flat JSON array of strings, e.g. ["TYPE:hi","ENTER"].
+// Returns false on malformed input; out is only filled on success.
+bool parseJsonStringArray(const String& json, std::vector<String>& out, size_t maxItems) {
+  std::vector<String> items;
+  unsigned int i = 0;
+  unsigned int len = json.length();
+
+  while (i < len && isspace(json.charAt(i))) i++;
+  if (i >= len || json.charAt(i) != '[') return false;
+  i++;
+
+  bool expectValue = true;
+  while (i < len) {
+    char c = json.charAt(i);
+    if (isspace(c)) {
+      i++;
+      continue;
+    }
+    if (c == ']') {
+      // Allow "[]" but not a trailing comma
+      if (expectValue && !items.empty()) return false;
+      out.swap(items);
+      return true;
+    }
+    if (c == ',' && !expectValue) {
+      expectValue = true;
+      i++;
+      continue;
+    }
+    if (c != '"' || !expectValue) return false;
+    if (items.size() >= maxItems) return false;
+
+    String value = "";
+    i++;
+    bool closed = false;
+    while (i < len) {
+      c = json.charAt(i++);
+      if (c == '"') {
+        closed = true;
+        break;
+      }
+      if (c != '\\') {
+        value += c;
+        continue;
+      }
+      if (i >= len) return false;
+      c = json.charAt(i++);
+      switch (c) {
+        case 'n': value += '\n'; break;
+        case 'r': value += '\r'; break;
+        case 't': value += '\t'; break;
+        case 'b': value += '\b'; break;
+        case 'f': value += '\f'; break;
+        case 'u': {
+          if (i + 4 > len) return false;
+          unsigned long code = strtoul(json.substring(i, i + 4).c_str(), nullptr, 16);
+          i += 4;
+          // Encode the BMP code point as UTF-8
+          if (code < 0x80) {
+            value += (char)code;
+          } else if (code < 0x800) {
+            value += (char)(0xC0 | (code >> 6));
+            value += (char)(0x80 | (code & 0x3F));
+          } else {
+            value += (char)(0xE0 | (code >> 12));
+            value += (char)(0x80 | ((code >> 6) & 0x3F));
+            value += (char)(0x80 | (code & 0x3F));
+          }
+          break;
+        }
+        default: value += c; break;  // \" \\ \/
+      }
+    }
+    if (!closed) return false;
+
+    items.push_back(value);
+    expectValue = false;
+  }
+
+  return false;
+}
@@ -2,7 +2,9 @@
 #define UTILS_H
 
 #include <Arduino.h>
+#include <vector>
 
 String escapeJson(String str);
+bool parseJsonStringArray(const String& json, std::vector<String>& out, size_t maxItems);
 
 #endif //UTILS_H
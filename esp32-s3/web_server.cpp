@@ -2,12 +2,25 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <FS.h>
+#include <algorithm>
 #include "wifi_manager.h"
 #include "display_manager.h"
 #include "hid_handler.h"
 #include "ducky_parser.h"
 #include "littlefs_manager.h"
 #include "utils.h"
+#include "request_router.h"
+#include "session_manager.h"
+#include "event_stream.h"
+#include "upload_writer.h"
+#include "chunked_upload.h"
+#include "config_cache.h"
+#include "config_journal.h"
+#include "dir_listing.h"
+#include "script_manifest.h"
+#include "block_cache.h"
+#include "config_backup.h"
+#include "compressed_file.h"
 #include "config.h"
 
 #if ENABLE_HTTPS
@@ -22,45 +35,73 @@ WebServerSecure secureServer(443);
 bool httpsEnabled = false;
 #endif
 
-// Macro to handle both HTTP and HTTPS server responses
-#if ENABLE_HTTPS
-#define GET_ACTIVE_SERVER() (httpsEnabled && secureServer.client() ? secureServer : server)
-#define SERVER_SEND(code, type, content) \
-  do { \
-    if (httpsEnabled && secureServer.client()) { \
-      secureServer.send(code, type, content); \
-    } else { \
-      server.send(code, type, content); \
-    } \
-  } while(0)
-
-#define SERVER_HAS_ARG(argname) (httpsEnabled && secureServer.client() ? secureServer.hasArg(argname) : server.hasArg(argname))
-#define SERVER_ARG(argname) (httpsEnabled && secureServer.client() ? secureServer.arg(argname) : server.arg(argname))
-#define SERVER_STREAM_FILE(file, type) \
-  do { \
-    if (httpsEnabled && secureServer.client()) { \
-      secureServer.streamFile(file, type); \
-    } else { \
-      server.streamFile(file, type); \
-    } \
-  } while(0)
-#define SERVER_AUTHENTICATE(user, pass) (httpsEnabled && secureServer.client() ? secureServer.authenticate(user, pass) : server.authenticate(user, pass))
-#define SERVER_REQUEST_AUTH() \
-  do { \
-    if (httpsEnabled && secureServer.client()) { \
-      secureServer.requestAuthentication(); \
-    } else { \
-      server.requestAuthentication(); \
-    } \
-  } while(0)
-#else
-#define SERVER_SEND(code, type, content) server.send(code, type, content)
-#define SERVER_HAS_ARG(argname) server.hasArg(argname)
-#define SERVER_ARG(argname) server.arg(argname)
-#define SERVER_STREAM_FILE(file, type) server.streamFile(file, type)
-#define SERVER_AUTHENTICATE(user, pass) server.authenticate(user, pass)
-#define SERVER_REQUEST_AUTH() server.requestAuthentication()
-#endif
+// Handlers talk to whichever listener owns the current request. The context is
+// filled in once by the route dispatcher instead of on every call.
+#define SERVER_SEND(code, type, content) currentRequest.server->send(code, type, content)
+#define SERVER_HAS_ARG(argname) currentRequest.server->hasArg(argname)
+#define SERVER_ARG(argname) currentRequest.server->arg(argname)
+#define SERVER_STREAM_FILE(file, type) currentRequest.server->streamFile(file, type)
+#define SERVER_AUTHENTICATE(user, pass) currentRequest.server->authenticate(user, pass)
+#define SERVER_REQUEST_AUTH() currentRequest.server->requestAuthentication()
+
+// Every endpoint is declared exactly once here and served by both listeners
+static const Route routeTable[] = {
+  ROUTE("/api/login", HTTP_POST, handleLogin),
+  ROUTE("/api/logout", HTTP_POST, handleLogout),
+  ROUTE("/api/metrics", HTTP_GET, handleMetrics),
+  ROUTE("/api/command", HTTP_POST, handleCommand),
+  ROUTE("/api/commands", HTTP_POST, handleCommands),
+  ROUTE("/api/script", HTTP_POST, handleScript),
+  ROUTE("/api/jiggler", HTTP_GET, handleJiggler),
+  ROUTE("/api/status", HTTP_GET, handleStatus),
+  ROUTE("/api/events", HTTP_GET, handleEvents),
+  ROUTE("/api/wifi", HTTP_GET, handleGetWiFi),
+  ROUTE("/api/wifi", HTTP_POST, handleSetWiFi),
+  ROUTE("/api/wifi/delete", HTTP_POST, handleDeleteWiFi),
+  ROUTE("/api/scan", HTTP_GET, handleScan),
+  ROUTE("/api/scripts", HTTP_GET, handleListScripts),
+  ROUTE("/api/scripts", HTTP_POST, handleSaveScript),
+  ROUTE("/api/scripts/load", HTTP_POST, handleLoadScript),
+  ROUTE("/api/scripts/delete", HTTP_POST, handleDeleteScript),
+  ROUTE("/api/scripts/run", HTTP_POST, handleRunScript),
+  ROUTE("/api/quickactions", HTTP_GET, handleListQuickActions),
+  ROUTE("/api/quickactions", HTTP_POST, handleSaveQuickAction),
+  ROUTE("/api/quickactions/delete", HTTP_POST, handleDeleteQuickAction),
+  ROUTE("/api/quickactions/reorder", HTTP_POST, handleReorderQuickActions),
+  ROUTE("/api/quickactions/export", HTTP_GET, handleExportQuickActions),
+  ROUTE("/api/quickactions/import", HTTP_POST, handleImportQuickActions),
+  ROUTE("/api/quickscripts", HTTP_GET, handleListQuickScripts),
+  ROUTE("/api/quickscripts", HTTP_POST, handleSaveQuickScript),
+  ROUTE("/api/quickscripts/delete", HTTP_POST, handleDeleteQuickScript),
+  ROUTE("/api/quickscripts/export", HTTP_GET, handleExportQuickScripts),
+  ROUTE("/api/quickscripts/import", HTTP_POST, handleImportQuickScripts),
+  ROUTE("/api/customos", HTTP_GET, handleListCustomOS),
+  ROUTE("/api/customos", HTTP_POST, handleSaveCustomOS),
+  ROUTE("/api/customos/delete", HTTP_POST, handleDeleteCustomOS),
+  ROUTE("/api/files", HTTP_GET, handleListFiles),
+  UPLOAD_ROUTE("/api/files/upload", HTTP_POST, handleFileUploadDone, handleFileUpload),
+  ROUTE("/api/files/delete", HTTP_POST, handleFileDelete),
+  ROUTE("/api/files/download", HTTP_GET, handleFileDownload),
+  ROUTE("/api/files/create_dir", HTTP_POST, handleCreateDir),
+  ROUTE("/api/files/chunked/open", HTTP_POST, handleChunkedOpen),
+  ROUTE("/api/files/chunked/status", HTTP_GET, handleChunkedStatus),
+  UPLOAD_ROUTE("/api/files/chunked/chunk", HTTP_POST, handleChunkDone, handleChunkUpload),
+  ROUTE("/api/files/chunked/finalize", HTTP_POST, handleChunkedFinalize),
+  ROUTE("/api/files/chunked/cancel", HTTP_POST, handleChunkedCancel),
+  ROUTE("/api/display/screenshot", HTTP_GET, handleDisplayScreenshot),
+  ROUTE("/api/backup", HTTP_GET, handleBackup),
+  UPLOAD_ROUTE("/api/restore", HTTP_POST, handleRestoreDone, handleRestoreUpload),
+};
+
+static const size_t routeCount = sizeof(routeTable) / sizeof(routeTable[0]);
+
+// Request headers the handlers read (WebServer only keeps the ones listed)
+static const char* collectedHeaders[] = { "Cookie", "Last-Event-ID", "Range", "If-Range", "Content-Length", "If-None-Match" };
+
+// Authentication counters reported by /api/metrics
+static uint32_t authSessionHits = 0;
+static uint32_t authBasicHits = 0;
+static uint32_t authRejected = 0;
 
 String getContentType(String filename) {
   if (filename.endsWith(".html")) return "text/html";
@@ -74,6 +115,32 @@ String getContentType(String filename) {
   return "text/plain";
 }
 
+// Sends a file through the block cache; false if it doesn't exist
+static bool streamCachedFile(const String& path, const String& contentType) {
+  CachedFile file(path);
+  if (!file) return false;
+
+  // Allocated before the headers go out, so a failure can still be a 500
+  // instead of a short body behind a valid Content-Length
+  uint8_t* buffer = (uint8_t*)malloc(FILE_BLOCK_SIZE);
+  if (!buffer) {
+    Serial.println("Static file error: Out of memory");
+    SERVER_SEND(500, "text/plain", "Out of memory");
+    return true;
+  }
+
+  WebServer* web = currentRequest.server;
+  web->setContentLength(file.size());
+  SERVER_SEND(200, contentType, "");
+
+  size_t n;
+  while (web->client().connected() && (n = file.read(buffer, FILE_BLOCK_SIZE)) > 0) {
+    web->sendContent((const char*)buffer, n);
+  }
+  free(buffer);
+  return true;
+}
+
 bool handleStaticFile(String path) {
   if (!storageAvailable || !storageFS) return false;
 
@@ -81,29 +148,9 @@ bool handleStaticFile(String path) {
   if (path == "/") path = "/index.html";
 
   String contentType = getContentType(path);
-  
-  // Try /www directory first
-  String wwwPath = "/www" + path;
-  if (storageFS->exists(wwwPath)) {
-    File file = storageFS->open(wwwPath, "r");
-    if (file) {
-      SERVER_STREAM_FILE(file, contentType);
-      file.close();
-      return true;
-    }
-  }
 
-  // Fallback to root
-  if (storageFS->exists(path)) {
-    File file = storageFS->open(path, "r");
-    if (file) {
-      SERVER_STREAM_FILE(file, contentType);
-      file.close();
-      return true;
-    }
-  }
-
-  return false;
+  // Try /www directory first, then fall back to root
+  return streamCachedFile("/www" + path, contentType) || streamCachedFile(path, contentType);
 }
 
 void serveStaticFile(String path, String contentType) {
@@ -112,59 +159,67 @@ void serveStaticFile(String path, String contentType) {
   }
 }
 
+// The same check as checkAuthentication() without answering the request,
+// for upload callbacks that leave the response to the done handler
+static bool requestAuthenticated() {
+  String token = getSessionFromCookie(currentRequest.server->header("Cookie"));
+  if (token.length() > 0 && validateSession(token)) return true;
+  return SERVER_AUTHENTICATE(WEB_AUTH_USER, WEB_AUTH_PASS);
+}
+
 bool checkAuthentication() {
+  // Fast path: a session cookie issued by /api/login
+  String token = getSessionFromCookie(currentRequest.server->header("Cookie"));
+  if (token.length() > 0 && validateSession(token)) {
+    authSessionHits++;
+    return true;
+  }
+
   if (!SERVER_AUTHENTICATE(WEB_AUTH_USER, WEB_AUTH_PASS)) {
+    authRejected++;
     SERVER_REQUEST_AUTH();
     return false;
   }
+  authBasicHits++;
   return true;
 }
 
+static bool credentialsMatch(const String& user, const String& pass) {
+  String expectedUser = WEB_AUTH_USER;
+  String expectedPass = WEB_AUTH_PASS;
+  if (user.length() != expectedUser.length() || pass.length() != expectedPass.length()) {
+    return false;
+  }
+  bool userOk = constantTimeEquals((const uint8_t*)user.c_str(), (const uint8_t*)expectedUser.c_str(), user.length());
+  bool passOk = constantTimeEquals((const uint8_t*)pass.c_str(), (const uint8_t*)expectedPass.c_str(), pass.length());
+  return userOk && passOk;
+}
+
 // Try to serve the file directly
 void handleNotFound() {
   if (!checkAuthentication()) return;
   
-  String path = server.uri();
+  String path = currentRequest.server->uri();
   if (handleStaticFile(path)) return;
   
   SERVER_SEND(404, "text/plain", "File not found: " + path);
 }
 
 void setupWebServer() {
-  // Register API routes on HTTP server
-  server.on("/api/command", HTTP_POST, handleCommand);
-  server.on("/api/script", HTTP_POST, handleScript);
-  server.on("/api/jiggler", HTTP_GET, handleJiggler);
-  server.on("/api/status", HTTP_GET, handleStatus);
-  server.on("/api/wifi", HTTP_GET, handleGetWiFi);
-  server.on("/api/wifi", HTTP_POST, handleSetWiFi);
-  server.on("/api/wifi/delete", HTTP_POST, handleDeleteWiFi);
-  server.on("/api/scan", HTTP_GET, handleScan);
-  server.on("/api/scripts", HTTP_GET, handleListScripts);
-  server.on("/api/scripts", HTTP_POST, handleSaveScript);
-  server.on("/api/scripts/load", HTTP_POST, handleLoadScript);
-  server.on("/api/scripts/delete", HTTP_POST, handleDeleteScript);
-  server.on("/api/quickactions", HTTP_GET, handleListQuickActions);
-  server.on("/api/quickactions", HTTP_POST, handleSaveQuickAction);
-  server.on("/api/quickactions/delete", HTTP_POST, handleDeleteQuickAction);
-  server.on("/api/quickactions/reorder", HTTP_POST, handleReorderQuickActions);
-  server.on("/api/quickscripts", HTTP_GET, handleListQuickScripts);
-  server.on("/api/quickscripts", HTTP_POST, handleSaveQuickScript);
-  server.on("/api/quickscripts/delete", HTTP_POST, handleDeleteQuickScript);
-  server.on("/api/customos", HTTP_GET, handleListCustomOS);
-  server.on("/api/customos", HTTP_POST, handleSaveCustomOS);
-  server.on("/api/customos/delete", HTTP_POST, handleDeleteCustomOS);
-  server.on("/api/files", HTTP_GET, handleListFiles);
-  server.on("/api/files/upload", HTTP_POST, handleFileUploadDone, handleFileUpload);
-  server.on("/api/files/delete", HTTP_POST, handleFileDelete);
-  server.on("/api/files/download", HTTP_GET, handleFileDownload);
-  server.on("/api/files/create_dir", HTTP_POST, handleCreateDir);
+  setupSessions();
+
+  // One dispatcher per listener, both backed by the same route table
+  server.addHandler(new RouteTableHandler(routeTable, routeCount));
+  server.collectHeaders(collectedHeaders, sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
 
   // Catch-all for static files
-  server.onNotFound(handleNotFound);
+  server.onNotFound([]() {
+    beginRequest(server, nullptr);
+    handleNotFound();
+  });
 
   server.begin();
-  Serial.println("HTTP server started on port 80");
+  Serial.println("HTTP server started on port 80 (" + String(routeCount) + " routes)");
 
 #if ENABLE_HTTPS
   // Try to initialize HTTPS server
@@ -174,37 +229,14 @@ void setupWebServer() {
   static BearSSL::PrivateKey serverKey(server_key, server_key_len);
   secureServer.getServer().setRSACert(&serverCert, &serverKey);
 
-  // Register API routes on HTTPS server
-  secureServer.on("/api/command", HTTP_POST, handleCommand);
-  secureServer.on("/api/script", HTTP_POST, handleScript);
-  secureServer.on("/api/jiggler", HTTP_GET, handleJiggler);
-  secureServer.on("/api/status", HTTP_GET, handleStatus);
-  secureServer.on("/api/wifi", HTTP_GET, handleGetWiFi);
-  secureServer.on("/api/wifi", HTTP_POST, handleSetWiFi);
-  secureServer.on("/api/wifi/delete", HTTP_POST, handleDeleteWiFi);
-  secureServer.on("/api/scan", HTTP_GET, handleScan);
-  secureServer.on("/api/scripts", HTTP_GET, handleListScripts);
-  secureServer.on("/api/scripts", HTTP_POST, handleSaveScript);
-  secureServer.on("/api/scripts/load", HTTP_POST, handleLoadScript);
-  secureServer.on("/api/scripts/delete", HTTP_POST, handleDeleteScript);
-  secureServer.on("/api/quickactions", HTTP_GET, handleListQuickActions);
-  secureServer.on("/api/quickactions", HTTP_POST, handleSaveQuickAction);
-  secureServer.on("/api/quickactions/delete", HTTP_POST, handleDeleteQuickAction);
-  secureServer.on("/api/quickactions/reorder", HTTP_POST, handleReorderQuickActions);
-  secureServer.on("/api/quickscripts", HTTP_GET, handleListQuickScripts);
-  secureServer.on("/api/quickscripts", HTTP_POST, handleSaveQuickScript);
-  secureServer.on("/api/quickscripts/delete", HTTP_POST, handleDeleteQuickScript);
-  secureServer.on("/api/customos", HTTP_GET, handleListCustomOS);
-  secureServer.on("/api/customos", HTTP_POST, handleSaveCustomOS);
-  secureServer.on("/api/customos/delete", HTTP_POST, handleDeleteCustomOS);
-  secureServer.on("/api/files", HTTP_GET, handleListFiles);
-  secureServer.on("/api/files/upload", HTTP_POST, handleFileUploadDone, handleFileUpload);
-  secureServer.on("/api/files/delete", HTTP_POST, handleFileDelete);
-  secureServer.on("/api/files/download", HTTP_GET, handleFileDownload);
-  secureServer.on("/api/files/create_dir", HTTP_POST, handleCreateDir);
+  secureServer.addHandler(new RouteTableHandler(routeTable, routeCount));
+  secureServer.collectHeaders(collectedHeaders, sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
 
   // Secure catch-all
-  secureServer.onNotFound(handleNotFound);
+  secureServer.onNotFound([]() {
+    beginRequest(secureServer, nullptr);
+    handleNotFound();
+  });
 
   secureServer.begin();
   httpsEnabled = true;
@@ -221,6 +253,158 @@ void handleWebClients() {
     secureServer.handleClient();
   }
 #endif
+  handleEventStreams();
+}
+
+void handleLogin() {
+  // Accept form credentials, or the Basic auth header the browser already sends
+  bool valid;
+  if (SERVER_HAS_ARG("user") && SERVER_HAS_ARG("pass")) {
+    valid = credentialsMatch(SERVER_ARG("user"), SERVER_ARG("pass"));
+  } else {
+    valid = SERVER_AUTHENTICATE(WEB_AUTH_USER, WEB_AUTH_PASS);
+  }
+
+  if (!valid) {
+    authRejected++;
+    SERVER_SEND(401, "application/json", "{\"status\":\"error\",\"message\":\"Invalid credentials\"}");
+    return;
+  }
+
+  String token = createSession();
+  currentRequest.server->sendHeader("Set-Cookie", String(SESSION_COOKIE) + "=" + token +
+    "; Path=/; Max-Age=" + String(SESSION_TTL_SECONDS) + "; HttpOnly; SameSite=Strict");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"expires_in\":" + String(SESSION_TTL_SECONDS) + "}");
+}
+
+void handleLogout() {
+  String token = getSessionFromCookie(currentRequest.server->header("Cookie"));
+  if (token.length() > 0) {
+    revokeSession(token);
+  }
+  currentRequest.server->sendHeader("Set-Cookie", String(SESSION_COOKIE) + "=; Path=/; Max-Age=0; HttpOnly; SameSite=Strict");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Logged out\"}");
+}
+
+static const char* methodName(HTTPMethod method) {
+  switch (method) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_PUT: return "PUT";
+    case HTTP_DELETE: return "DELETE";
+    default: return "OTHER";
+  }
+}
+
+static const char* storageUsageStateName(StorageUsageState state) {
+  switch (state) {
+    case STORAGE_USAGE_SCANNING: return "scanning";
+    case STORAGE_USAGE_READY: return "ready";
+    default: return "unavailable";
+  }
+}
+
+void handleMetrics() {
+  if (!checkAuthentication()) return;
+
+  String json = "{";
+  json += "\"uptime_ms\":" + String(millis()) + ",";
+  json += "\"requests\":" + String(totalRequests) + ",";
+  json += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
+  json += "\"event_streams\":" + String(openEventStreamCount()) + ",";
+  uint64_t storageTotal = 0, storageUsed = 0;
+  StorageUsageState storageState = getFilesystemInfo(storageTotal, storageUsed);
+  StorageUsageStats usage = getStorageUsageStats();
+  json += "\"storage_usage\":{";
+  json += "\"state\":\"" + String(storageUsageStateName(storageState)) + "\",";
+  json += "\"total\":" + String(storageTotal) + ",";
+  json += "\"used\":" + String(storageUsed) + ",";
+  json += "\"scans\":" + String(usage.scans) + ",";
+  json += "\"last_scan_ms\":" + String(usage.lastScanMs) + ",";
+  json += "\"last_drift\":" + String(usage.lastDrift);
+  json += "},";
+  const JournalStats& journal = getJournalStats();
+  json += "\"config_journal\":{";
+  json += "\"size\":" + String(getJournalSize()) + ",";
+  json += "\"edits\":" + String(journal.edits) + ",";
+  json += "\"logical_bytes\":" + String(journal.logicalBytes) + ",";
+  json += "\"journal_bytes\":" + String(journal.journalBytes) + ",";
+  json += "\"snapshot_bytes\":" + String(journal.snapshotBytes) + ",";
+  json += "\"compactions\":" + String(journal.compactions) + ",";
+  // Bytes written to flash per byte of edited data
+  float amplification = journal.logicalBytes > 0
+    ? (float)(journal.journalBytes + journal.snapshotBytes) / journal.logicalBytes : 0;
+  json += "\"write_amplification\":" + String(amplification, 2);
+  json += "},";
+  BlockCacheStats cache = getBlockCacheStats();
+  json += "\"block_cache\":{";
+  json += "\"capacity\":" + String(cache.capacity) + ",";
+  json += "\"cached_bytes\":" + String(cache.cachedBytes) + ",";
+  json += "\"pinned_bytes\":" + String(cache.pinnedBytes) + ",";
+  json += "\"files\":" + String(cache.files) + ",";
+  json += "\"hits\":" + String(cache.hits) + ",";
+  json += "\"misses\":" + String(cache.misses) + ",";
+  json += "\"evictions\":" + String(cache.evictions);
+  json += "},";
+  const DisplayStats& screen = getDisplayStats();
+  json += "\"display\":{";
+  json += "\"mode\":\"" + String(screen.sprite ? "sprite" : "direct") + "\",";
+  json += "\"requests\":" + String(screen.requests) + ",";
+  json += "\"updates\":" + String(screen.updates) + ",";
+  json += "\"unchanged\":" + String(screen.unchanged) + ",";
+  json += "\"last_spi_bytes\":" + String(screen.lastBytes) + ",";
+  json += "\"total_spi_bytes\":" + String((uint32_t)screen.totalBytes) + ",";
+  json += "\"full_frame_bytes\":" + String(screen.fullFrameBytes) + ",";
+  json += "\"compose_us\":" + String(screen.composeUs) + ",";
+  json += "\"present_us\":" + String(screen.presentUs) + ",";
+  json += "\"dma_us\":" + String(screen.transferUs);
+  json += "},";
+  json += "\"auth\":{";
+  json += "\"session\":" + String(authSessionHits) + ",";
+  json += "\"basic\":" + String(authBasicHits) + ",";
+  json += "\"rejected\":" + String(authRejected);
+  json += "},";
+  json += "\"routes\":[";
+  bool first = true;
+  for (size_t i = 0; i < routeCount; i++) {
+    const RouteStats& stats = getRouteStats(i);
+    if (stats.count == 0) continue;
+    if (!first) json += ",";
+    first = false;
+    json += "{";
+    json += "\"path\":\"" + String(routeTable[i].path) + "\",";
+    json += "\"method\":\"" + String(methodName(routeTable[i].method)) + "\",";
+    json += "\"count\":" + String(stats.count) + ",";
+    json += "\"avg_us\":" + String((uint32_t)(stats.totalMicros / stats.count)) + ",";
+    json += "\"max_us\":" + String(stats.maxMicros);
+    json += "}";
+  }
+  json += "]}";
+  SERVER_SEND(200, "application/json", json);
+}
+
+// Returns the display history line for a command, or "" if it isn't logged
+String describeCommand(const String& cmd) {
+  // Only log typed text to display history
+  if (cmd.startsWith("TYPE_DELAY:")) {
+    int separatorPos = cmd.indexOf(':', 11);
+    if (separatorPos > 11) {
+      return "Type: " + cmd.substring(separatorPos + 1);
+    }
+  }
+  else if (cmd.startsWith("TYPELN_DELAY:")) {
+    int separatorPos = cmd.indexOf(':', 13);
+    if (separatorPos > 13) {
+      return "TypeLn: " + cmd.substring(separatorPos + 1);
+    }
+  }
+  else if (cmd.startsWith("TYPE:")) {
+    return "Type: " + cmd.substring(5);
+  } 
+  else if (cmd.startsWith("TYPELN:")) {
+    return "TypeLn: " + cmd.substring(7);
+  }
+  return "";
 }
 
 void handleCommand() {
@@ -229,24 +413,9 @@ void handleCommand() {
     String cmd = SERVER_ARG("cmd");
     processHIDCommand(cmd);
     
-    // Only log typed text to display history
-    if (cmd.startsWith("TYPE_DELAY:")) {
-      int separatorPos = cmd.indexOf(':', 11);
-      if (separatorPos > 11) {
-        displayAction("Type: " + cmd.substring(separatorPos + 1));
-      }
-    }
-    else if (cmd.startsWith("TYPELN_DELAY:")) {
-      int separatorPos = cmd.indexOf(':', 13);
-      if (separatorPos > 13) {
-        displayAction("TypeLn: " + cmd.substring(separatorPos + 1));
-      }
-    }
-    else if (cmd.startsWith("TYPE:")) {
-      displayAction("Type: " + cmd.substring(5));
-    } 
-    else if (cmd.startsWith("TYPELN:")) {
-      displayAction("TypeLn: " + cmd.substring(7));
+    String description = describeCommand(cmd);
+    if (description.length() > 0) {
+      displayAction(description);
     }
 
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Command sent\"}");
@@ -255,6 +424,76 @@ void handleCommand() {
   }
 }
 
+// Time a batch spends waiting: the pauses between steps plus DELAY and
+// TYPE_DELAY/TYPELN_DELAY steps (the latter wait once per character)
+static uint64_t batchDelayMs(const std::vector<String>& cmds, int stepDelay) {
+  uint64_t total = cmds.size() > 1 ? (uint64_t)stepDelay * (cmds.size() - 1) : 0;
+  for (const auto& cmd : cmds) {
+    if (cmd.startsWith("DELAY:")) {
+      long ms = cmd.substring(6).toInt();
+      if (ms > 0 && ms <= 10000) total += ms;
+    } else if (cmd.startsWith("TYPE_DELAY:") || cmd.startsWith("TYPELN_DELAY:")) {
+      int start = cmd.indexOf(':') + 1;
+      int separator = cmd.indexOf(':', start);
+      if (separator > start) {
+        long ms = cmd.substring(start, separator).toInt();
+        if (ms > 0) total += (uint64_t)ms * (cmd.length() - separator - 1);
+      }
+    }
+  }
+  return total;
+}
+
+void handleCommands() {
+  if (!checkAuthentication()) return;
+  if (!SERVER_HAS_ARG("cmds")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing cmds parameter\"}");
+    return;
+  }
+
+  // Parse the whole batch up front so a malformed request runs nothing
+  std::vector<String> cmds;
+  if (!parseJsonStringArray(SERVER_ARG("cmds"), cmds, MAX_BATCH_COMMANDS)) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"cmds must be a JSON array of at most " + String(MAX_BATCH_COMMANDS) + " strings\"}");
+    return;
+  }
+
+  // Optional pause between steps. The batch runs inside this request and
+  // blocks the server, so all of its pauses together are capped.
+  int stepDelay = SERVER_HAS_ARG("delay") ? SERVER_ARG("delay").toInt() : 0;
+  if (stepDelay < 0 || batchDelayMs(cmds, stepDelay) > MAX_BATCH_DELAY_MS) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Delays in one batch may add up to at most " + String(MAX_BATCH_DELAY_MS) + " ms\"}");
+    return;
+  }
+
+  // Steps run back to back inside this request, so nothing else reaches
+  // the HID path until the batch is done
+  String json = "{\"status\":\"ok\",\"steps\":[";
+  String lastDescription = "";
+  int failed = 0;
+  for (size_t i = 0; i < cmds.size(); i++) {
+    if (i > 0 && stepDelay > 0) delay(stepDelay);
+
+    bool ok = processHIDCommand(cmds[i]);
+    if (!ok) failed++;
+
+    String description = describeCommand(cmds[i]);
+    if (description.length() > 0) lastDescription = description;
+
+    if (i > 0) json += ",";
+    json += "{\"cmd\":\"" + escapeJson(cmds[i]) + "\",\"ok\":" + String(ok ? "true" : "false") + "}";
+  }
+  json += "],\"executed\":" + String(cmds.size()) + ",\"failed\":" + String(failed) + "}";
+
+  if (lastDescription.length() > 0) {
+    displayAction(lastDescription);
+  } else if (cmds.size() > 1) {
+    displayAction("Batch: " + String(cmds.size()) + " commands");
+  }
+
+  SERVER_SEND(200, "application/json", json);
+}
+
 void handleScript() {
   if (!checkAuthentication()) return;
   if (SERVER_HAS_ARG("script")) {
@@ -302,13 +541,23 @@ void handleJiggler() {
 
 void handleStatus() {
   if (!checkAuthentication()) return;
-  String json = "{";
-  json += "\"wifi_mode\":\"" + String(isAPMode ? "AP" : "Station") + "\",";
-  json += "\"ssid\":\"" + (isAPMode ? String(AP_SSID) : currentSSID) + "\",";
-  json += "\"ip\":\"" + (isAPMode ? "192.168.4.1" : WiFi.localIP().toString()) + "\",";
-  json += "\"connected\":" + String(WiFi.status() == WL_CONNECTED ? "true" : "false");
-  json += "}";
-  SERVER_SEND(200, "application/json", json);
+  SERVER_SEND(200, "application/json", getStatusJson());
+}
+
+void handleEvents() {
+  if (!checkAuthentication()) return;
+
+  // EventSource sends Last-Event-ID on reconnect; allow a query arg for manual resume
+  String lastId = currentRequest.server->header("Last-Event-ID");
+  if (lastId.length() == 0 && SERVER_HAS_ARG("lastEventId")) {
+    lastId = SERVER_ARG("lastEventId");
+  }
+  uint32_t lastEventId = lastId.length() > 0 ? strtoul(lastId.c_str(), nullptr, 10) : 0;
+
+  // A fresh stream starts with a snapshot so the page needs no initial poll
+  if (!openEventStream(*currentRequest.server, lastEventId, "status", getStatusJson())) {
+    SERVER_SEND(503, "application/json", "{\"status\":\"error\",\"message\":\"Too many event streams\"}");
+  }
 }
 
 void handleGetWiFi() {
@@ -338,6 +587,8 @@ void handleSetWiFi() {
     if (addWifiNetwork(ssid, password)) {
       displayAction("WiFi saved: " + ssid);
       String json = "{\"status\":\"ok\",\"message\":\"WiFi credentials saved.\"}";
+      publishEvent("wifi", "{\"changed\":\"networks\"}");
+      wifiNetworksChanged();
       SERVER_SEND(200, "application/json", json);
     } else {
       String json = "{\"status\":\"error\",\"message\":\"Maximum number of WiFi networks reached (" + String(MAX_WIFI_NETWORKS) + ")\"}";
@@ -361,8 +612,11 @@ void handleDeleteWiFi() {
     }
 
     if (index != -1) {
+      // The connector follows the delete itself; restarting it would drop
+      // a join that is about to succeed
       deleteWiFiNetwork(index);
       displayAction("WiFi deleted: " + ssid);
+      publishEvent("wifi", "{\"changed\":\"networks\"}");
       SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"WiFi network deleted\"}");
     } else {
       SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"WiFi network not found\"}");
@@ -374,15 +628,16 @@ void handleDeleteWiFi() {
 
 void handleScan() {
   if (!checkAuthentication()) return;
-  int n = WiFi.scanNetworks();
+  std::vector<WiFiScanResult> networks;
+  int n = scanWiFiNetworks(networks);
   String json = "[";
 
   for (int i = 0; i < n; i++) {
     if (i > 0) json += ",";
     json += "{";
-    json += "\"ssid\":\"" + WiFi.SSID(i) + "\",";
-    json += "\"rssi\":" + String(WiFi.RSSI(i)) + ",";
-    json += "\"encryption\":" + String(WiFi.encryptionType(i));
+    json += "\"ssid\":\"" + escapeJson(networks[i].ssid) + "\",";
+    json += "\"rssi\":" + String(networks[i].rssi) + ",";
+    json += "\"encryption\":" + String(networks[i].encryption);
     json += "}";
   }
 
@@ -396,31 +651,16 @@ void handleListScripts() {
   String json = "[";
   bool first = true;
 
-  // Check if Storage is available
-  if (storageAvailable && storageFS) {
-    // Iterate through all files
-    File root = storageFS->open("/");
-    File file = root.openNextFile();
-    while (file) {
-      String filename = String(file.name());
-
-      // Remove leading slash if present
-      if (filename.startsWith("/")) {
-        filename = filename.substring(1);
-      }
-
-      // Check if it's a script file (starts with "scripts_")
-      if (filename.startsWith("scripts_") && filename.endsWith(".txt")) {
-        if (!first) json += ",";
-        first = false;
+  for (const auto& script : getScriptList()) {
+    if (!first) json += ",";
+    first = false;
 
-        String name = getScriptNameFromFilename(filename);
-        json += "{";
-        json += "\"name\":\"" + escapeJson(name) + "\"";
-        json += "}";
-      }
-      file = root.openNextFile();
-    }
+    json += "{";
+    json += "\"name\":\"" + escapeJson(script.name) + "\",";
+    json += "\"size\":" + String(script.size) + ",";
+    json += "\"hash\":\"" + String(script.hash, HEX) + "\",";
+    json += "\"modified\":" + String(script.modified);
+    json += "}";
   }
 
   json += "]";
@@ -445,6 +685,7 @@ void handleSaveScript() {
 
     if (saveScriptToFile(name, script)) {
       displayAction("Saved: " + name);
+      publishEvent("storage", "{\"changed\":\"scripts\"}");
       SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Script saved\"}");
     } else {
       SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save script\"}");
@@ -486,6 +727,7 @@ void handleDeleteScript() {
 
     if (deleteScriptFile(name)) {
       displayAction("Deleted: " + name);
+      publishEvent("storage", "{\"changed\":\"scripts\"}");
       SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Script deleted\"}");
     } else {
       SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Script not found\"}");
@@ -495,8 +737,57 @@ void handleDeleteScript() {
   }
 }
 
+// Runs a saved script straight from storage, decoding it a line at a time
+void handleRunScript() {
+  if (!checkAuthentication()) return;
+  if (!SERVER_HAS_ARG("name")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing name parameter\"}");
+    return;
+  }
+
+  String name = SERVER_ARG("name");
+  const ScriptInfo* script = findScript(name);
+  CachedFile file(script ? script->file : String());
+  if (!script || !file) {
+    SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Script not found\"}");
+    return;
+  }
+
+  {
+    CompressedFileReader reader(file);
+    executeDuckyScript(reader);
+  }
+
+  displayAction("Script: " + name);
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Script executed\"}");
+}
+
 // Quick Actions Management Handlers
 
+// Config lists are served from RAM; the cache version doubles as an ETag so
+// unchanged lists cost a 304 instead of a body
+static bool configNotModified() {
+  String etag = "\"cfg-" + String(getConfigVersion()) + "\"";
+  currentRequest.server->sendHeader("ETag", etag);
+  currentRequest.server->sendHeader("Cache-Control", "no-cache");
+  if (currentRequest.server->header("If-None-Match") == etag) {
+    SERVER_SEND(304, "application/json", "");
+    return true;
+  }
+  return false;
+}
+
+// Config fields are journaled and stored with 16-bit lengths; longer ones
+// are refused before anything is changed
+static bool fieldTooLong(const String& value) {
+  return value.length() > CONFIG_FIELD_MAX;
+}
+
+static void sendFieldTooLong() {
+  SERVER_SEND(400, "application/json",
+              "{\"status\":\"error\",\"message\":\"Field too long (max " + String(CONFIG_FIELD_MAX) + " bytes)\"}");
+}
+
 void handleListQuickActions() {
   if (!checkAuthentication()) return;
 
@@ -505,46 +796,8 @@ void handleListQuickActions() {
     return;
   }
 
-  String os = SERVER_ARG("os");
-  String content = loadQuickActions(os);
-
-  String json = "[";
-  if (content.length() > 0) {
-    bool first = true;
-    int startPos = 0;
-    int endPos;
-
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-      String line = content.substring(startPos, endPos);
-      if (line.length() > 0) {
-        // Parse line: cmd|label|desc|class
-        int pipe1 = line.indexOf('|');
-        int pipe2 = line.indexOf('|', pipe1 + 1);
-        int pipe3 = line.indexOf('|', pipe2 + 1);
-
-        if (pipe1 > 0 && pipe2 > pipe1 && pipe3 > pipe2) {
-          String cmd = line.substring(0, pipe1);
-          String label = line.substring(pipe1 + 1, pipe2);
-          String desc = line.substring(pipe2 + 1, pipe3);
-          String btnClass = line.substring(pipe3 + 1);
-
-          if (!first) json += ",";
-          first = false;
-
-          json += "{";
-          json += "\"cmd\":\"" + escapeJson(cmd) + "\",";
-          json += "\"label\":\"" + escapeJson(label) + "\",";
-          json += "\"desc\":\"" + escapeJson(desc) + "\",";
-          json += "\"class\":\"" + escapeJson(btnClass) + "\"";
-          json += "}";
-        }
-      }
-      startPos = endPos + 1;
-    }
-  }
-
-  json += "]";
-  SERVER_SEND(200, "application/json", json);
+  if (configNotModified()) return;
+  SERVER_SEND(200, "application/json", getQuickActionsJson(SERVER_ARG("os")));
 }
 
 void handleSaveQuickAction() {
@@ -567,8 +820,14 @@ void handleSaveQuickAction() {
     return;
   }
 
+  if (fieldTooLong(os) || fieldTooLong(cmd) || fieldTooLong(label) || fieldTooLong(desc) || fieldTooLong(btnClass)) {
+    sendFieldTooLong();
+    return;
+  }
+
   if (saveQuickAction(os, cmd, label, desc, btnClass)) {
     displayAction("Quick action saved");
+    publishEvent("config", "{\"changed\":\"quickactions\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Quick action saved\"}");
   } else {
     SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save quick action\"}");
@@ -588,6 +847,7 @@ void handleDeleteQuickAction() {
 
   if (deleteQuickAction(os, cmd)) {
     displayAction("Quick action deleted");
+    publishEvent("config", "{\"changed\":\"quickactions\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Quick action deleted\"}");
   } else {
     SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Quick action not found\"}");
@@ -599,27 +859,8 @@ void handleDeleteQuickAction() {
 void handleListCustomOS() {
   if (!checkAuthentication()) return;
 
-  String content = loadCustomOSList();
-
-  String json = "[";
-  if (content.length() > 0) {
-    bool first = true;
-    int startPos = 0;
-    int endPos;
-
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-      String line = content.substring(startPos, endPos);
-      if (line.length() > 0) {
-        if (!first) json += ",";
-        first = false;
-        json += "\"" + escapeJson(line) + "\"";
-      }
-      startPos = endPos + 1;
-    }
-  }
-
-  json += "]";
-  SERVER_SEND(200, "application/json", json);
+  if (configNotModified()) return;
+  SERVER_SEND(200, "application/json", getCustomOSJson());
 }
 
 void handleSaveCustomOS() {
@@ -643,8 +884,14 @@ void handleSaveCustomOS() {
     return;
   }
 
+  if (fieldTooLong(osName)) {
+    sendFieldTooLong();
+    return;
+  }
+
   if (addCustomOS(osName)) {
     displayAction("Custom OS added: " + osName);
+    publishEvent("config", "{\"changed\":\"customos\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Custom OS added\"}");
   } else {
     SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to add custom OS\"}");
@@ -663,6 +910,7 @@ void handleDeleteCustomOS() {
 
   if (deleteCustomOS(osName)) {
     displayAction("Custom OS deleted: " + osName);
+    publishEvent("config", "{\"changed\":\"customos\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Custom OS deleted\"}");
   } else {
     SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Custom OS not found\"}");
@@ -682,71 +930,100 @@ void handleReorderQuickActions() {
   String os = SERVER_ARG("os");
   String order = SERVER_ARG("order"); // Comma-separated list of cmd values
 
-  // Load existing actions
-  String content = loadQuickActions(os);
-  if (content.length() == 0) {
+  if (getQuickActions(os).empty()) {
     SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"No actions found for this OS\"}");
     return;
   }
 
   // Parse order list
-  String newContent = "";
+  std::vector<String> cmds;
   int orderStart = 0;
-  int orderEnd;
-
-  while ((orderEnd = order.indexOf(',', orderStart)) != -1) {
+  while (orderStart <= (int)order.length()) {
+    int orderEnd = order.indexOf(',', orderStart);
+    if (orderEnd == -1) orderEnd = order.length();
     String cmd = order.substring(orderStart, orderEnd);
     cmd.trim();
+    if (cmd.length() > 0) cmds.push_back(cmd);
+    orderStart = orderEnd + 1;
+  }
 
-    // Find this action in content and add it
-    int startPos = 0;
-    int endPos;
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-      String line = content.substring(startPos, endPos);
-      if (line.startsWith(cmd + "|")) {
-        newContent += line + "\n";
-        break;
-      }
-      startPos = endPos + 1;
+  for (const auto& cmd : cmds) {
+    if (fieldTooLong(cmd)) {
+      sendFieldTooLong();
+      return;
     }
+  }
 
-    orderStart = orderEnd + 1;
+  if (!reorderQuickActions(os, cmds)) {
+    SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save reordered actions\"}");
+    return;
   }
 
-  // Handle last cmd in order
-  if (orderStart < order.length()) {
-    String cmd = order.substring(orderStart);
-    cmd.trim();
+  displayAction("Quick actions reordered");
+  publishEvent("config", "{\"changed\":\"quickactions\"}");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Actions reordered\"}");
+}
 
-    int startPos = 0;
-    int endPos;
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-      String line = content.substring(startPos, endPos);
-      if (line.startsWith(cmd + "|")) {
-        newContent += line + "\n";
-        break;
-      }
-      startPos = endPos + 1;
-    }
+// Quick Actions/Scripts Import & Export Handlers
+
+void handleExportQuickActions() {
+  if (!checkAuthentication()) return;
+
+  if (!SERVER_HAS_ARG("os")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing os parameter\"}");
+    return;
   }
 
-  // Save reordered content
-  String filename = String("/quickactions_") + os + ".txt";
-  filename.replace(" ", "_");
+  SERVER_SEND(200, "text/plain", exportQuickActionsText(SERVER_ARG("os")));
+}
 
-  if (storageAvailable && storageFS) {
-    File file = storageFS->open(filename, "w");
-    if (!file) {
-      SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save reordered actions\"}");
-      return;
-    }
+void handleImportQuickActions() {
+  if (!checkAuthentication()) return;
 
-    file.print(newContent);
-    file.close();
+  if (!SERVER_HAS_ARG("os") || !SERVER_HAS_ARG("data")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing os or data parameter\"}");
+    return;
   }
 
-  displayAction("Quick actions reordered");
-  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Actions reordered\"}");
+  int count = importQuickActionsText(SERVER_ARG("os"), SERVER_ARG("data"));
+  if (count < 0) {
+    SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to import quick actions\"}");
+    return;
+  }
+
+  displayAction("Quick actions imported");
+  publishEvent("config", "{\"changed\":\"quickactions\"}");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"imported\":" + String(count) + "}");
+}
+
+void handleExportQuickScripts() {
+  if (!checkAuthentication()) return;
+
+  if (!SERVER_HAS_ARG("os")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing os parameter\"}");
+    return;
+  }
+
+  SERVER_SEND(200, "text/plain", exportQuickScriptsText(SERVER_ARG("os")));
+}
+
+void handleImportQuickScripts() {
+  if (!checkAuthentication()) return;
+
+  if (!SERVER_HAS_ARG("os") || !SERVER_HAS_ARG("data")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing os or data parameter\"}");
+    return;
+  }
+
+  int count = importQuickScriptsText(SERVER_ARG("os"), SERVER_ARG("data"));
+  if (count < 0) {
+    SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to import quick scripts\"}");
+    return;
+  }
+
+  displayAction("Quick scripts imported");
+  publishEvent("config", "{\"changed\":\"quickscripts\"}");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"imported\":" + String(count) + "}");
 }
 
 // Quick Scripts Management Handlers
@@ -769,49 +1046,8 @@ void handleListQuickScripts() {
     return;
   }
 
-  String os = SERVER_ARG("os");
-  String content = loadQuickScripts(os);
-
-  String json = "[";
-  if (content.length() > 0) {
-    bool first = true;
-    int startPos = 0;
-    int endPos;
-
-    while ((endPos = content.indexOf('\n', startPos)) != -1) {
-      String line = content.substring(startPos, endPos);
-      if (line.length() > 0) {
-        // Parse line: id|label|script|class
-        int pipe1 = line.indexOf('|');
-        int pipe2 = line.indexOf('|', pipe1 + 1);
-        int pipe3 = line.indexOf('|', pipe2 + 1);
-
-        if (pipe1 > 0 && pipe2 > pipe1 && pipe3 > pipe2) {
-          String id = line.substring(0, pipe1);
-          String label = line.substring(pipe1 + 1, pipe2);
-          String script = line.substring(pipe2 + 1, pipe3);
-          String btnClass = line.substring(pipe3 + 1);
-
-          // Unescape newlines
-          script.replace("\\n", "\n");
-
-          if (!first) json += ",";
-          first = false;
-
-          json += "{";
-          json += "\"id\":\"" + escapeJson(id) + "\",";
-          json += "\"label\":\"" + escapeJson(label) + "\",";
-          json += "\"script\":\"" + escapeJson(script) + "\",";
-          json += "\"class\":\"" + escapeJson(btnClass) + "\"";
-          json += "}";
-        }
-      }
-      startPos = endPos + 1;
-    }
-  }
-
-  json += "]";
-  SERVER_SEND(200, "application/json", json);
+  if (configNotModified()) return;
+  SERVER_SEND(200, "application/json", getQuickScriptsJson(SERVER_ARG("os")));
 }
 
 void handleSaveQuickScript() {
@@ -834,8 +1070,14 @@ void handleSaveQuickScript() {
     return;
   }
 
+  if (fieldTooLong(os) || fieldTooLong(id) || fieldTooLong(label) || fieldTooLong(script) || fieldTooLong(btnClass)) {
+    sendFieldTooLong();
+    return;
+  }
+
   if (saveQuickScript(os, id, label, script, btnClass)) {
     displayAction("Quick script saved");
+    publishEvent("config", "{\"changed\":\"quickscripts\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Quick script saved\"}");
   } else {
     SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save quick script\"}");
@@ -855,6 +1097,7 @@ void handleDeleteQuickScript() {
 
   if (deleteQuickScript(os, id)) {
     displayAction("Quick script deleted");
+    publishEvent("config", "{\"changed\":\"quickscripts\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Quick script deleted\"}");
   } else {
     SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Quick script not found\"}");
@@ -887,56 +1130,81 @@ void handleListFiles() {
      return;
   }
 
-  size_t totalBytes = 0;
-  size_t usedBytes = 0;
-  getFilesystemInfo(totalBytes, usedBytes);
+  const DirListing* listing = getDirListing(path);
+  if (!listing) {
+      SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to open directory\"}");
+      return;
+  }
+
+  // Filter by name prefix, then sort: listings come directories first and
+  // by name, so only size order needs sorting here
+  String prefix = SERVER_ARG("prefix");
+  String sort = SERVER_HAS_ARG("sort") ? SERVER_ARG("sort") : String("name");
+  bool descending = SERVER_ARG("order") == "desc";
+
+  std::vector<uint32_t> view;
+  for (uint32_t i = 0; i < listing->entries.size(); i++) {
+    if (prefix.length() == 0 || strncasecmp(listing->name(listing->entries[i]), prefix.c_str(), prefix.length()) == 0) {
+      view.push_back(i);
+    }
+  }
+  if (sort == "size") {
+    std::stable_sort(view.begin(), view.end(), [listing](uint32_t a, uint32_t b) {
+      return listing->entries[a].size < listing->entries[b].size;
+    });
+  }
+  if (descending) std::reverse(view.begin(), view.end());
+
+  // The cursor is the offset of the first entry of the page
+  size_t cursor = SERVER_HAS_ARG("cursor") ? SERVER_ARG("cursor").toInt() : 0;
+  size_t limit = SERVER_HAS_ARG("limit") ? SERVER_ARG("limit").toInt() : DIR_PAGE_DEFAULT;
+  if (limit == 0 || limit > DIR_PAGE_MAX) limit = DIR_PAGE_MAX;
+  if (cursor > view.size()) cursor = view.size();
+  size_t end = min(cursor + limit, view.size());
+
+  uint64_t totalBytes = 0;
+  uint64_t usedBytes = 0;
+  StorageUsageState storageState = getFilesystemInfo(totalBytes, usedBytes);
+
+  String dirPrefix = path;
+  if (!dirPrefix.endsWith("/")) dirPrefix += "/";
 
   String json = "{";
   json += "\"path\":\"" + escapeJson(path) + "\",";
   json += "\"filesystem\":{";
+  json += "\"state\":\"" + String(storageUsageStateName(storageState)) + "\",";
   json += "\"total\":" + String(totalBytes) + ",";
   json += "\"used\":" + String(usedBytes) + ",";
   json += "\"free\":" + String(totalBytes - usedBytes);
   json += "},";
+  json += "\"total\":" + String(view.size()) + ",";
+  json += "\"cursor\":" + String(cursor) + ",";
+  json += "\"next_cursor\":" + (end < view.size() ? String(end) : String("null")) + ",";
   json += "\"files\":[";
 
-  // Iterate through files in directory
-  File root = storageFS->open(path);
-  if (!root || !root.isDirectory()) {
-      SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to open directory\"}");
-      return;
-  }
-
-  File file = root.openNextFile();
-  bool first = true;
-
-  while (file) {
-    if (!first) json += ",";
-    first = false;
-
-    String filename = String(file.name());
-    // Ensure filename is a full path. Some FS return just the name.
-    if (!filename.startsWith("/")) {
-        String fullPath = path;
-        if (!fullPath.endsWith("/")) fullPath += "/";
-        fullPath += filename;
-        filename = fullPath;
-    }
-
-    bool isDir = file.isDirectory();
-    size_t filesize = isDir ? 0 : file.size();
+  // Stream the page in small pieces instead of building it in one String
+  WebServer* web = currentRequest.server;
+  web->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  SERVER_SEND(200, "application/json", "");
 
+  for (size_t i = cursor; i < end; i++) {
+    const DirEntry& entry = listing->entries[view[i]];
+    if (i > cursor) json += ",";
     json += "{";
-    json += "\"name\":\"" + escapeJson(filename) + "\",";
-    json += "\"size\":" + String(filesize) + ",";
-    json += "\"is_dir\":" + String(isDir ? "true" : "false");
+    json += "\"name\":\"" + escapeJson(dirPrefix + listing->name(entry)) + "\",";
+    json += "\"size\":" + String(entry.size) + ",";
+    json += "\"is_dir\":" + String(entry.isDir ? "true" : "false");
     json += "}";
 
-    file = root.openNextFile();
+    if (json.length() >= 1024) {
+      web->sendContent(json);
+      json = "";
+    }
   }
 
   json += "]}";
-  SERVER_SEND(200, "application/json", json);
+  web->sendContent(json);
+  web->sendContent("");  // Ends the chunked response
 }
 
 void handleCreateDir() {
@@ -961,23 +1229,62 @@ void handleCreateDir() {
   }
   
   if (storageFS->mkdir(path)) {
+     invalidateDirListing(path);
+     publishEvent("storage", "{\"changed\":\"files\"}");
      SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Directory created\"}");
   } else {
      SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to create directory\"}");
   }
 }
 
-// Global variable for file upload
-File uploadFile;
+// State for the upload in progress
+static UploadWriter uploadWriter;
+static String uploadPath;
+static String uploadError;
+static int uploadErrorCode = 500;
+
+// The target was truncated, rewritten or removed. Done here rather than in
+// handleFileUploadDone(), which WebServer skips for an aborted request, so
+// the block cache never serves a file that is no longer on the card.
+static void uploadTargetChanged(const String& path, bool written) {
+  invalidateDirListing(path);
+  invalidateBlockCache(path);
+  if (written) {
+    scriptFileWritten(path);
+  } else {
+    scriptFileRemoved(path);
+  }
+}
 
-void handleFileUpload() {
-  if (!checkAuthentication()) return;
+// Drops what was written of a failed upload
+static void uploadFailed(const String& error) {
+  uploadWriter.abort();
+  storageFS->remove(uploadPath);
+  uploadTargetChanged(uploadPath, false);
+  uploadError = error;
+  Serial.println("Upload error: " + error + " (" + uploadPath + ")");
+  uploadPath = "";
+}
 
-  HTTPUpload& upload = server.upload();
+void handleFileUpload() {
+  HTTPUpload& upload = currentRequest.server->upload();
 
   if (upload.status == UPLOAD_FILE_START) {
+    uploadError = "";
+    uploadErrorCode = 500;
+    uploadPath = "";
+
+    // Authenticate once per upload instead of on every chunk. The 401 is
+    // sent by handleFileUploadDone(), which checks again.
+    if (!requestAuthenticated()) {
+      uploadError = "Unauthorized";
+      uploadErrorCode = 401;
+      return;
+    }
+
     String filename = upload.filename;
     if (filename.length() == 0) {
+      uploadError = "No filename";
       Serial.println("Upload error: No filename");
       return;
     }
@@ -997,47 +1304,212 @@ void handleFileUpload() {
     
     Serial.println("Upload start: " + fullPath);
 
-    // Check available space (rough estimate)
-    if (!hasAvailableSpace(100000)) { // Reserve 100KB minimum
-      Serial.println("Upload error: Insufficient space");
+    if (!storageAvailable || !storageFS) {
+      uploadError = "Storage not available";
       return;
     }
 
-    // Open file for writing
-    if (storageAvailable && storageFS) {
-      uploadFile = storageFS->open(fullPath, "w");
-      if (!uploadFile) {
-        Serial.println("Upload error: Failed to open file for writing");
-      }
+    // The multipart body is slightly larger than the file, so this errs on
+    // the safe side. A file being replaced is truncated first, so its space
+    // counts as free.
+    size_t expected = strtoul(currentRequest.server->header("Content-Length").c_str(), nullptr, 10);
+    size_t replacedSize = storedFileSize(fullPath);
+    if (!hasAvailableSpace(expected, replacedSize)) {
+      uploadError = "Insufficient space";
+      uploadErrorCode = 507;
+      Serial.println("Upload error: Insufficient space for " + String(expected) + " bytes");
+      return;
+    }
+
+    // Opening with "w" truncates any file being replaced, so the cached
+    // copy goes now
+    File file = storageFS->open(fullPath, "w");
+    accountFileChange(replacedSize, 0);
+    uploadPath = fullPath;
+    invalidateDirListing(fullPath);
+    invalidateBlockCache(fullPath);
+    if (!file) {
+      uploadFailed("Failed to open file for writing");
+      return;
+    }
+    if (!uploadWriter.begin(file)) {
+      file.close();
+      uploadFailed("Out of memory");
+      return;
     }
   }
   else if (upload.status == UPLOAD_FILE_WRITE) {
-    // Write chunk to file
-    if (uploadFile) {
-      uploadFile.write(upload.buf, upload.currentSize);
-      Serial.print(".");
+    if (uploadWriter.active() && !uploadWriter.write(upload.buf, upload.currentSize)) {
+      uploadFailed("Write failed");
     }
   }
   else if (upload.status == UPLOAD_FILE_END) {
-    // Close file
-    if (uploadFile) {
-      uploadFile.close();
-      Serial.println("\nUpload complete: " + String(upload.totalSize) + " bytes");
-      displayAction("File uploaded: " + upload.filename);
+    if (uploadWriter.active()) {
+      if (uploadWriter.finish()) {
+        accountFileChange(0, uploadWriter.bytesWritten());
+        uploadTargetChanged(uploadPath, true);
+        Serial.println("Upload complete: " + String(uploadWriter.bytesWritten()) + " bytes in " +
+                       String(uploadWriter.elapsedMs()) + " ms");
+        displayAction("File uploaded: " + upload.filename);
+      } else {
+        uploadFailed("Write failed");
+      }
     }
   }
+  else if (upload.status == UPLOAD_FILE_ABORTED) {
+    if (uploadWriter.active()) {
+      uploadFailed("Upload aborted");
+    }
+    uploadError = "Upload aborted";
+  }
 }
 
 void handleFileUploadDone() {
   if (!checkAuthentication()) return;
 
-  HTTPUpload& upload = server.upload();
+  HTTPUpload& upload = currentRequest.server->upload();
 
-  if (upload.status == UPLOAD_FILE_END) {
-    SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"File uploaded successfully\"}");
+  // Caches and the script manifest were updated as the upload went
+  bool failed = uploadError.length() > 0 || upload.status != UPLOAD_FILE_END;
+
+  if (failed) {
+    String message = uploadError.length() > 0 ? uploadError : String("Upload failed");
+    SERVER_SEND(uploadErrorCode, "application/json", "{\"status\":\"error\",\"message\":\"" + escapeJson(message) + "\"}");
   } else {
-    SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Upload failed\"}");
+    size_t bytes = uploadWriter.bytesWritten();
+    uint32_t ms = uploadWriter.elapsedMs();
+    // Measured from the first to the last chunk, so it includes network time
+    float mbps = ms > 0 ? (bytes / 1048576.0f) / (ms / 1000.0f) : 0;
+
+    publishEvent("storage", "{\"changed\":\"files\"}");
+    String json = "{\"status\":\"ok\",\"message\":\"File uploaded successfully\",";
+    json += "\"bytes\":" + String(bytes) + ",";
+    json += "\"ms\":" + String(ms) + ",";
+    json += "\"mb_per_s\":" + String(mbps, 2) + ",";
+    json += "\"backend\":\"" + String(usingSD ? "SD" : "LittleFS") + "\"}";
+    SERVER_SEND(200, "application/json", json);
+  }
+}
+
+// Resumable chunked uploads
+
+static ChunkedUpload* chunkedSessionArg() {
+  ChunkedUpload* session = SERVER_HAS_ARG("id") ? findChunkedUpload(SERVER_ARG("id")) : nullptr;
+  if (!session) {
+    SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"Unknown upload id\"}");
+  }
+  return session;
+}
+
+void handleChunkedOpen() {
+  if (!checkAuthentication()) return;
+
+  if (!SERVER_HAS_ARG("path") || !SERVER_HAS_ARG("size")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing path or size parameter\"}");
+    return;
+  }
+
+  String path = sanitizeFilename(SERVER_ARG("path"));
+  size_t size = strtoul(SERVER_ARG("size").c_str(), nullptr, 10);
+  size_t chunkSize = SERVER_HAS_ARG("chunk") ? strtoul(SERVER_ARG("chunk").c_str(), nullptr, 10) : CHUNKED_DEFAULT_CHUNK;
+
+  String error;
+  ChunkedUpload* session = openChunkedUpload(path, size, chunkSize, error);
+  if (!session) {
+    int code = error == "Insufficient space" ? 507 : (error == "Too many uploads in progress" ? 503 : 400);
+    SERVER_SEND(code, "application/json", "{\"status\":\"error\",\"message\":\"" + error + "\"}");
+    return;
+  }
+  SERVER_SEND(200, "application/json", chunkedUploadStatusJson(session));
+}
+
+void handleChunkedStatus() {
+  if (!checkAuthentication()) return;
+  ChunkedUpload* session = chunkedSessionArg();
+  if (!session) return;
+  SERVER_SEND(200, "application/json", chunkedUploadStatusJson(session));
+}
+
+static String chunkError;
+
+void handleChunkUpload() {
+  HTTPUpload& upload = currentRequest.server->upload();
+
+  if (upload.status == UPLOAD_FILE_START) {
+    chunkError = "";
+    if (!requestAuthenticated()) {
+      chunkError = "Unauthorized";
+      return;
+    }
+
+    ChunkedUpload* session = SERVER_HAS_ARG("id") ? findChunkedUpload(SERVER_ARG("id")) : nullptr;
+    if (!session || !SERVER_HAS_ARG("offset") || !SERVER_HAS_ARG("crc")) {
+      chunkError = "Missing or unknown id, offset or crc";
+      return;
+    }
+    size_t offset = strtoul(SERVER_ARG("offset").c_str(), nullptr, 10);
+    uint32_t crc = strtoul(SERVER_ARG("crc").c_str(), nullptr, 16);
+    beginChunk(session, offset, crc, chunkError);
+  }
+  else if (upload.status == UPLOAD_FILE_WRITE) {
+    if (chunkError.length() == 0 && !writeChunk(upload.buf, upload.currentSize)) {
+      endChunk(chunkError);
+    }
+  }
+  else if (upload.status == UPLOAD_FILE_END) {
+    if (chunkError.length() == 0) {
+      endChunk(chunkError);
+    }
+  }
+  else if (upload.status == UPLOAD_FILE_ABORTED) {
+    abortChunk();
+    chunkError = "Upload aborted";
+  }
+}
+
+void handleChunkDone() {
+  if (!checkAuthentication()) return;
+
+  if (chunkError.length() > 0) {
+    int code = chunkError == "CRC mismatch" ? 422 : 400;
+    SERVER_SEND(code, "application/json", "{\"status\":\"error\",\"message\":\"" + chunkError + "\"}");
+    return;
+  }
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\"}");
+}
+
+void handleChunkedFinalize() {
+  if (!checkAuthentication()) return;
+  ChunkedUpload* session = chunkedSessionArg();
+  if (!session) return;
+
+  if (!SERVER_HAS_ARG("crc")) {
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing crc parameter\"}");
+    return;
+  }
+
+  String path = session->path;
+  String error;
+  if (!finalizeChunkedUpload(session, strtoul(SERVER_ARG("crc").c_str(), nullptr, 16), error)) {
+    int code = error == "Missing chunks" ? 409 : (error == "File CRC mismatch" ? 422 : 500);
+    SERVER_SEND(code, "application/json", "{\"status\":\"error\",\"message\":\"" + error + "\"}");
+    return;
   }
+
+  invalidateDirListing(path);
+  invalidateBlockCache(path);
+  scriptFileWritten(path);
+  displayAction("File uploaded: " + path);
+  publishEvent("storage", "{\"changed\":\"files\"}");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"File uploaded successfully\"}");
+}
+
+void handleChunkedCancel() {
+  if (!checkAuthentication()) return;
+  ChunkedUpload* session = chunkedSessionArg();
+  if (!session) return;
+  cancelChunkedUpload(session);
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Upload cancelled\"}");
 }
 
 void handleFileDelete() {
@@ -1067,6 +1539,7 @@ void handleFileDelete() {
 
   File file = storageFS->open(filename);
   bool isDir = file && file.isDirectory();
+  size_t fileSize = file && !isDir ? file.size() : 0;
   file.close();
 
   bool success = false;
@@ -1077,14 +1550,167 @@ void handleFileDelete() {
   }
 
   if (success) {
+    accountFileChange(fileSize, 0);
+    invalidateDirListing(filename);
+    invalidateBlockCache(filename);
+    if (!isDir) scriptFileRemoved(filename);
     Serial.println("Deleted: " + filename);
     displayAction("Deleted: " + filename);
+    publishEvent("storage", "{\"changed\":\"files\"}");
     SERVER_SEND(200, "application/json", "{\"status\":\"ok\",\"message\":\"Item deleted\"}");
   } else {
     SERVER_SEND(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to delete item (dir must be empty)\"}");
   }
 }
 
+enum RangeResult { RANGE_NONE, RANGE_OK, RANGE_UNSATISFIABLE };
+
+// Parses a single "bytes=start-end", "bytes=start-" or "bytes=-suffix" range.
+// Multi-range requests are rejected rather than served as multipart/byteranges.
+static bool isDigits(const String& s) {
+  if (s.length() == 0) return false;
+  for (size_t i = 0; i < s.length(); i++) {
+    if (!isdigit((unsigned char)s[i])) return false;
+  }
+  return true;
+}
+
+// A malformed header, another unit or several ranges are ignored (RFC 9110
+// lets a server answer those with the whole file); only a well-formed range
+// that misses the file is unsatisfiable
+static RangeResult parseByteRange(const String& header, size_t fileSize, size_t& start, size_t& end) {
+  if (header.length() == 0) return RANGE_NONE;
+  if (!header.startsWith("bytes=") || header.indexOf(',') >= 0) return RANGE_NONE;
+
+  String spec = header.substring(6);
+  spec.trim();
+  int dash = spec.indexOf('-');
+  if (dash < 0) return RANGE_NONE;
+
+  String first = spec.substring(0, dash);
+  String last = spec.substring(dash + 1);
+
+  if (first.length() == 0) {
+    // Suffix range: the last N bytes
+    if (!isDigits(last)) return RANGE_NONE;
+    size_t suffix = strtoul(last.c_str(), nullptr, 10);
+    if (suffix == 0 || fileSize == 0) return RANGE_UNSATISFIABLE;
+    start = suffix >= fileSize ? 0 : fileSize - suffix;
+    end = fileSize - 1;
+    return RANGE_OK;
+  }
+
+  if (!isDigits(first) || (last.length() > 0 && !isDigits(last))) return RANGE_NONE;
+  size_t from = strtoul(first.c_str(), nullptr, 10);
+  size_t to = last.length() > 0 ? strtoul(last.c_str(), nullptr, 10) : fileSize - 1;
+  if (last.length() > 0 && to < from) return RANGE_NONE;  // Invalid, not unsatisfiable
+  if (from >= fileSize) return RANGE_UNSATISFIABLE;
+  start = from;
+  end = to >= fileSize ? fileSize - 1 : to;
+  return RANGE_OK;
+}
+
+// Strong validator for If-Range, derived from size and modification time
+static String fileETag(File& file) {
+  return "\"" + String((uint32_t)file.size(), HEX) + "-" + String((uint32_t)file.getLastWrite(), HEX) + "\"";
+}
+
+// Where a download's bytes come from: the file as stored, or the LZSS
+// decoder over it
+struct PlainSource {
+  File& file;
+  explicit PlainSource(File& f) : file(f) {}
+  size_t read(uint8_t* buffer, size_t len) { return file.read(buffer, len); }
+  void skip(size_t count) { file.seek(count); }
+};
+
+struct DecodedSource {
+  CompressedFileReader& reader;
+  explicit DecodedSource(CompressedFileReader& r) : reader(r) {}
+  size_t read(uint8_t* buffer, size_t len) { return reader.readBytes(buffer, len); }
+  // The stream can only be decoded from the start
+  void skip(size_t count) {
+    uint8_t scratch[256];
+    while (count > 0) {
+      size_t n = reader.readBytes(scratch, min(count, sizeof(scratch)));
+      if (n == 0) break;
+      count -= n;
+    }
+  }
+};
+
+// Sends size bytes from source as an attachment, or the part a Range
+// header asks for
+template <typename Source>
+static void sendDownload(Source& source, size_t fileSize, const String& filename, const String& cleanFilename,
+                         const String& etag, const char* contentType) {
+  // Set Content-Disposition header for download
+  String contentDisposition = "attachment; filename=\"" + cleanFilename + "\"";
+
+  WebServer* web = currentRequest.server;
+
+  size_t start = 0;
+  size_t end = fileSize > 0 ? fileSize - 1 : 0;
+  RangeResult range = parseByteRange(web->header("Range"), fileSize, start, end);
+
+  // A stale If-Range validator means the client's partial copy is out of date
+  String ifRange = web->header("If-Range");
+  if (range != RANGE_NONE && ifRange.length() > 0 && ifRange != etag) {
+    range = RANGE_NONE;
+    start = 0;
+    end = fileSize > 0 ? fileSize - 1 : 0;
+  }
+
+  web->sendHeader("Accept-Ranges", "bytes");
+  web->sendHeader("ETag", etag);
+
+  if (range == RANGE_UNSATISFIABLE) {
+    web->sendHeader("Content-Range", "bytes */" + String(fileSize));
+    SERVER_SEND(416, "text/plain", "Range not satisfiable");
+    return;
+  }
+
+  size_t length = fileSize > 0 ? end - start + 1 : 0;
+  web->sendHeader("Content-Disposition", contentDisposition);
+  if (range == RANGE_OK) {
+    web->sendHeader("Content-Range", "bytes " + String(start) + "-" + String(end) + "/" + String(fileSize));
+  }
+  web->setContentLength(length);
+  SERVER_SEND(range == RANGE_OK ? 206 : 200, contentType, "");
+
+  size_t chunkSize = usingSD ? DOWNLOAD_CHUNK_SD : DOWNLOAD_CHUNK_LITTLEFS;
+  uint8_t* buffer = (uint8_t*)malloc(chunkSize);
+  if (!buffer) {
+    Serial.println("Download error: Out of memory");
+    return;
+  }
+
+  if (start > 0) {
+    source.skip(start);
+  }
+
+  size_t remaining = length;
+  while (remaining > 0) {
+    size_t toRead = remaining < chunkSize ? remaining : chunkSize;
+    size_t bytesRead = source.read(buffer, toRead);
+    if (bytesRead == 0) break;
+
+    web->sendContent((const char*)buffer, bytesRead);
+    remaining -= bytesRead;
+
+    // Client went away; it can resume later with a Range request
+    if (!web->client().connected()) break;
+  }
+
+  free(buffer);
+
+  if (remaining == 0) {
+    Serial.println("File downloaded: " + filename + " (" + String(length) + " bytes)");
+  } else {
+    Serial.println("Download interrupted: " + filename + " (" + String(length - remaining) + "/" + String(length) + " bytes)");
+  }
+}
+
 void handleFileDownload() {
   if (!checkAuthentication()) return;
 
@@ -1129,22 +1755,145 @@ void handleFileDownload() {
     cleanFilename = filename.substring(lastSlash + 1);
   }
 
-  // Set Content-Disposition header for download
-  String contentDisposition = "attachment; filename=\"" + cleanFilename + "\"";
-
-#if ENABLE_HTTPS
-  if (httpsEnabled && secureServer.client()) {
-    secureServer.sendHeader("Content-Disposition", contentDisposition);
-    secureServer.streamFile(file, "application/octet-stream");
+  // LZSS-compressed scripts and snapshots go out as the data they hold, a
+  // .lzs script as .txt; raw=1 asks for the stored bytes
+  bool raw = SERVER_HAS_ARG("raw") && SERVER_ARG("raw") == "1";
+  if (!raw && isCompressedStream(file)) {
+    CompressedFileReader reader(file);
+    if (!reader.ok()) {
+      file.close();
+      SERVER_SEND(500, "text/plain", "Out of memory");
+      return;
+    }
+    DecodedSource source(reader);
+    String etag = fileETag(file);
+    etag = etag.substring(0, etag.length() - 1) + "-text\"";
+    bool script = cleanFilename.endsWith(".lzs");
+    if (script) cleanFilename = cleanFilename.substring(0, cleanFilename.length() - 4) + ".txt";
+    sendDownload(source, reader.remaining(), filename, cleanFilename, etag,
+                 script ? "text/plain" : "application/octet-stream");
   } else {
-    server.sendHeader("Content-Disposition", contentDisposition);
-    server.streamFile(file, "application/octet-stream");
+    PlainSource source(file);
+    sendDownload(source, file.size(), filename, cleanFilename, fileETag(file), "application/octet-stream");
   }
-#else
-  server.sendHeader("Content-Disposition", contentDisposition);
-  server.streamFile(file, "application/octet-stream");
-#endif
-
   file.close();
-  Serial.println("File downloaded: " + filename);
+}
+
+// Status screen screenshot
+
+// Sink for generated responses (PNG, backup); ctx is the WebServer
+static bool sendGeneratedData(const uint8_t* data, size_t len, void* ctx) {
+  WebServer* web = (WebServer*)ctx;
+  if (!web->client().connected()) return false;
+  web->sendContent((const char*)data, len);
+  return true;
+}
+
+void handleDisplayScreenshot() {
+  if (!checkAuthentication()) return;
+
+  if (!canCaptureDisplay()) {
+    SERVER_SEND(404, "application/json", "{\"status\":\"error\",\"message\":\"No frame buffer (display off or no PSRAM)\"}");
+    return;
+  }
+
+  // Copied before the headers go out; the render task may present the
+  // next frame while the PNG is streamed
+  uint16_t* frame = captureDisplayFrame();
+  if (!frame) {
+    Serial.println("Screenshot error: Out of memory");
+    SERVER_SEND(500, "text/plain", "Out of memory");
+    return;
+  }
+
+  WebServer* web = currentRequest.server;
+  web->sendHeader("Cache-Control", "no-store");
+  web->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  SERVER_SEND(200, "image/png", "");
+  writeDisplayPng(frame, sendGeneratedData, web);
+  web->sendContent("");
+  free(frame);
+}
+
+// Configuration backup and restore
+
+void handleBackup() {
+  if (!checkAuthentication()) return;
+
+  // Fall back to a plain tar when there is no PSRAM for the deflate state
+  bool gzip = SERVER_HAS_ARG("gzip") && SERVER_ARG("gzip") != "0" && backupGzipSupported();
+  String filename = gzip ? "wifi-hid-backup.tar.gz" : "wifi-hid-backup.tar";
+
+  WebServer* web = currentRequest.server;
+  web->sendHeader("Content-Disposition", "attachment; filename=\"" + filename + "\"");
+  web->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  SERVER_SEND(200, gzip ? "application/gzip" : "application/x-tar", "");
+
+  bool ok = writeBackup(gzip, sendGeneratedData, web);
+  web->sendContent("");
+  Serial.println(ok ? "Backup sent: " + filename : String("Backup interrupted"));
+}
+
+static bool restoreAuthorized = false;
+
+void handleRestoreUpload() {
+  HTTPUpload& upload = currentRequest.server->upload();
+
+  if (upload.status == UPLOAD_FILE_START) {
+    // Authenticate once per upload instead of on every chunk; the done
+    // handler sends the 401
+    restoreAuthorized = requestAuthenticated();
+    if (!restoreAuthorized) return;
+    Serial.println("Restore start: " + upload.filename);
+    beginRestore();
+  }
+  else if (!restoreAuthorized) {
+    return;
+  }
+  else if (upload.status == UPLOAD_FILE_WRITE) {
+    writeRestore(upload.buf, upload.currentSize);
+  }
+  else if (upload.status == UPLOAD_FILE_END) {
+    endRestore();
+  }
+  else if (upload.status == UPLOAD_FILE_ABORTED) {
+    abortRestore();
+    Serial.println("Restore aborted");
+  }
+}
+
+void handleRestoreDone() {
+  if (!checkAuthentication()) return;
+
+  HTTPUpload& upload = currentRequest.server->upload();
+  const RestoreResult& result = getRestoreResult();
+  bool received = restoreAuthorized && upload.status == UPLOAD_FILE_END;
+  restoreAuthorized = false;
+
+  // Whatever was applied before a failure stays applied
+  if (result.wifi > 0) {
+    publishEvent("wifi", "{\"changed\":\"networks\"}");
+    wifiNetworksChanged();
+  }
+  if (result.customOS > 0) publishEvent("config", "{\"changed\":\"customos\"}");
+  if (result.quickLists > 0) {
+    publishEvent("config", "{\"changed\":\"quickactions\"}");
+    publishEvent("config", "{\"changed\":\"quickscripts\"}");
+  }
+  if (result.scripts > 0) publishEvent("storage", "{\"changed\":\"scripts\"}");
+
+  String counts = "\"wifi\":" + String(result.wifi) + ",";
+  counts += "\"customos\":" + String(result.customOS) + ",";
+  counts += "\"quick_lists\":" + String(result.quickLists) + ",";
+  counts += "\"scripts\":" + String(result.scripts) + ",";
+  counts += "\"skipped\":" + String(result.skipped);
+
+  if (!received || result.error.length() > 0) {
+    String message = result.error.length() > 0 ? result.error : String("Restore failed");
+    SERVER_SEND(400, "application/json", "{\"status\":\"error\",\"message\":\"" + escapeJson(message) + "\"," + counts + "}");
+    return;
+  }
+
+  displayAction("Config restored");
+  SERVER_SEND(200, "application/json", "{\"status\":\"ok\"," + counts + "}");
 }
@@ -8,10 +8,15 @@ void handleWebClients();
 bool checkAuthentication();
 
 // API Handlers
+void handleLogin();
+void handleLogout();
+void handleMetrics();
 void handleCommand();
+void handleCommands();
 void handleScript();
 void handleJiggler();
 void handleStatus();
+void handleEvents();
 void handleGetWiFi();
 void handleSetWiFi();
 void handleDeleteWiFi();
@@ -20,21 +25,36 @@ void handleListScripts();
 void handleSaveScript();
 void handleLoadScript();
 void handleDeleteScript();
+void handleRunScript();
 void handleListQuickActions();
 void handleSaveQuickAction();
 void handleDeleteQuickAction();
 void handleReorderQuickActions();
+void handleExportQuickActions();
+void handleImportQuickActions();
 void handleListCustomOS();
 void handleSaveCustomOS();
 void handleDeleteCustomOS();
 void handleListQuickScripts();
 void handleSaveQuickScript();
 void handleDeleteQuickScript();
+void handleExportQuickScripts();
+void handleImportQuickScripts();
 void handleListFiles();
 void handleFileUpload();
 void handleFileUploadDone();
 void handleFileDelete();
 void handleFileDownload();
 void handleCreateDir();
+void handleChunkedOpen();
+void handleChunkedStatus();
+void handleChunkUpload();
+void handleChunkDone();
+void handleChunkedFinalize();
+void handleChunkedCancel();
+void handleDisplayScreenshot();
+void handleBackup();
+void handleRestoreUpload();
+void handleRestoreDone();
 
 #endif //WEB_SERVER_H
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "wifi_connect.h"
+#include <algorithm>
+#include "config.h"
+
+WiFiConnector::WiFiConnector(WiFiDriver& radio, std::vector<WiFiNetwork>& networks)
+  : _radio(radio), _networks(networks), _state(WIFI_STATE_IDLE), _next(0), _attempting(false),
+    _leased(false), _attemptStart(0), _cycleStart(0), _retryFrom(0), _network(-1), _joinedFast(false),
+    _attempts(0), _elapsedMs(0), _cacheChanged(false) {}
+
+void WiFiConnector::start() {
+  if (_attempting) {
+    _radio.disconnect();
+    _attempting = false;
+  }
+  _cycleStart = _radio.millis();
+  _network = -1;
+  _joinedFast = false;
+  _attempts = 0;
+  if (_state == WIFI_STATE_SCANNING) return;
+
+  _candidates.clear();
+  _next = 0;
+  if (_networks.empty()) {
+    _state = WIFI_STATE_IDLE;
+    return;
+  }
+
+#if WIFI_FAST_CONNECT
+  for (size_t i = 0; i < _networks.size(); i++) {
+    const WiFiFastConnect& fast = _networks[i].fast;
+    if (!fast.valid) continue;
+    Candidate c = { i, true, {}, fast.channel };
+    memcpy(c.bssid, fast.bssid, sizeof(c.bssid));
+    _candidates.push_back(c);
+  }
+#endif
+  _state = WIFI_STATE_FAST;
+  step(_cycleStart);
+}
+
+void WiFiConnector::poll() {
+  uint32_t now = _radio.millis();
+
+  switch (_state) {
+    case WIFI_STATE_IDLE:
+      return;
+
+    case WIFI_STATE_CONNECTED:
+      if (_radio.status() != WIFI_LINK_CONNECTED) {
+        start();  // Link lost
+        return;
+      }
+      // Picks up the address DHCP settles on after a fast join
+      if (_leased) remember(_network);
+      return;
+
+    case WIFI_STATE_RETRY_WAIT:
+      if (now - _retryFrom >= WIFI_RETRY_MS) start();
+      return;
+
+    case WIFI_STATE_SCANNING: {
+      std::vector<WiFiScanResult> found;
+      if (_radio.scanResults(found) == WIFI_SCAN_PENDING) return;
+      scanned(found);
+      step(now);
+      return;
+    }
+
+    case WIFI_STATE_FAST:
+    case WIFI_STATE_JOINING:
+      step(now);
+      return;
+  }
+}
+
+void WiFiConnector::networkRemoved(size_t index) {
+  if (_network == (int)index) {
+    _network = -1;
+    _leased = false;  // Nowhere to cache the address DHCP hands out
+  } else if (_network > (int)index) {
+    _network--;
+  }
+
+  // SIZE_MAX is past any network, so step() skips it
+  for (Candidate& c : _candidates) {
+    if (c.network == index) c.network = SIZE_MAX;
+    else if (c.network > index && c.network != SIZE_MAX) c.network--;
+  }
+
+  if (_attempting && _candidates[_next].network == SIZE_MAX) {
+    _radio.disconnect();
+    _attempting = false;
+    _next++;
+  }
+}
+
+// Turns a finished scan into the list of access points to try
+void WiFiConnector::scanned(std::vector<WiFiScanResult>& found) {
+  std::stable_sort(found.begin(), found.end(),
+                   [](const WiFiScanResult& a, const WiFiScanResult& b) { return a.rssi > b.rssi; });
+  _lastScan = found;
+
+  _candidates.clear();
+  _next = 0;
+  _state = WIFI_STATE_JOINING;
+
+  // Pinning the scanned access point spares the radio its own scan
+  for (const auto& ap : found) {
+    for (size_t i = 0; i < _networks.size(); i++) {
+      if (_networks[i].ssid != ap.ssid) continue;
+      Candidate c = { i, true, {}, ap.channel };
+      memcpy(c.bssid, ap.bssid, sizeof(c.bssid));
+      _candidates.push_back(c);
+    }
+  }
+
+  // Hidden networks never show up in a scan
+  if (_candidates.empty()) {
+    for (size_t i = 0; i < _networks.size(); i++) {
+      _candidates.push_back(Candidate{ i, false, {}, 0 });
+    }
+  }
+}
+
+// Settles the attempt in flight, then starts the next one or moves to the
+// next state
+void WiFiConnector::step(uint32_t now) {
+  bool fast = _state == WIFI_STATE_FAST;
+
+  if (_attempting) {
+    const Candidate& c = _candidates[_next];
+    WiFiLink link = _radio.status();
+    if (link == WIFI_LINK_CONNECTED && c.network < _networks.size()) {
+      remember(c.network);
+      // The cached lease may have run out while the device was off; only
+      // the router can say whether the address is still ours
+      if (_leased) _radio.renewLease();
+      _attempting = false;
+      _network = c.network;
+      _joinedFast = fast;
+      _elapsedMs = now - _cycleStart;
+      _state = WIFI_STATE_CONNECTED;
+      return;
+    }
+
+    uint32_t timeout = fast ? WIFI_FAST_TIMEOUT : WIFI_TIMEOUT;
+    if (link == WIFI_LINK_CONNECTING && now - _attemptStart < timeout) return;
+
+    _radio.disconnect();
+    _attempting = false;
+    // Moved channel, replaced or out of range; a scan finds it again
+    if (fast && c.network < _networks.size() && _networks[c.network].fast.valid) {
+      _networks[c.network].fast.valid = 0;
+      _cacheChanged = true;
+    }
+    _next++;
+  }
+
+  // The networks may have shrunk since the list was made
+  while (_next < _candidates.size() && _candidates[_next].network >= _networks.size()) _next++;
+
+  if (_next < _candidates.size()) {
+    const Candidate& c = _candidates[_next];
+    WiFiNetwork& net = _networks[c.network];
+    const WiFiLease* lease = fast && WIFI_REUSE_LEASE ? &net.fast.lease : nullptr;
+    _radio.begin(net.ssid, net.password, c.pinned ? c.bssid : nullptr, c.channel, lease);
+    _attempting = true;
+    _leased = lease != nullptr;
+    _attemptStart = now;
+    _attempts++;
+    return;
+  }
+
+  if (fast && _radio.startScan()) {
+    _state = WIFI_STATE_SCANNING;
+  } else {
+    _state = WIFI_STATE_RETRY_WAIT;
+    _retryFrom = now;
+  }
+}
+
+// Caches where the network is joined now, once it has an address
+void WiFiConnector::remember(size_t network) {
+  if (network >= _networks.size()) return;
+  WiFiFastConnect joined = {};
+  _radio.current(joined);
+  if (joined.lease.ip == 0) return;
+  joined.valid = 1;
+  WiFiFastConnect& cached = _networks[network].fast;
+  if (memcmp(&cached, &joined, sizeof(joined)) != 0) {
+    cached = joined;
+    _cacheChanged = true;
+  }
+}
+
+bool WiFiConnector::takeCacheChanged() {
+  bool changed = _cacheChanged;
+  _cacheChanged = false;
+  return changed;
+}
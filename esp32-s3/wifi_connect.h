@@ -0,0 +1,146 @@
+#ifndef WIFI_CONNECT_H
+#define WIFI_CONNECT_H
+
+#include <Arduino.h>
+#include <vector>
+
+// How the device picks and joins one of its saved networks. The policy
+// only talks to the radio through WiFiDriver and nothing here depends on
+// WiFi.h, so a host build can run it against a simulated radio with
+// scripted scan results and failures.
+
+// DHCP result, addresses as IPAddress converts them to uint32_t
+struct WiFiLease {
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+// Where a network was last joined. Lets the next boot go straight to that
+// access point on its channel, with the same address, instead of scanning
+// and waiting for DHCP.
+struct WiFiFastConnect {
+  uint8_t valid;
+  uint8_t channel;
+  uint8_t bssid[6];
+  WiFiLease lease;
+};
+
+struct WiFiNetwork {
+  String ssid;
+  String password;
+  WiFiFastConnect fast = {};
+};
+
+struct WiFiScanResult {
+  String ssid;
+  int32_t rssi;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t encryption;
+};
+
+enum WiFiLink {
+  WIFI_LINK_CONNECTING,
+  WIFI_LINK_CONNECTED,
+  WIFI_LINK_FAILED  // The radio gave up: wrong password, access point gone
+};
+
+#define WIFI_SCAN_PENDING (-1)
+
+// Every call returns right away; the connector polls for outcomes
+class WiFiDriver {
+public:
+  virtual ~WiFiDriver() {}
+
+  // Starts joining ssid. bssid and channel pin the access point (null and
+  // 0 for any); lease sets a static address instead of asking DHCP.
+  virtual void begin(const String& ssid, const String& password, const uint8_t* bssid, uint8_t channel,
+                     const WiFiLease* lease) = 0;
+  virtual WiFiLink status() = 0;
+  virtual void disconnect() = 0;
+  virtual bool startScan() = 0;
+  // WIFI_SCAN_PENDING while the scan runs, then the number of networks
+  // found (0 if it failed); results are appended once
+  virtual int scanResults(std::vector<WiFiScanResult>& results) = 0;
+  // Access point, channel and address of the current connection; the
+  // address is 0 while DHCP hasn't answered
+  virtual void current(WiFiFastConnect& fast) = 0;
+  // Goes back to DHCP on a link joined with a static lease, so the router
+  // renews the lease or hands out another address, as for any client
+  virtual void renewLease() = 0;
+  virtual uint32_t millis() = 0;
+};
+
+enum WiFiConnectState {
+  WIFI_STATE_IDLE,        // Not started, or no saved networks
+  WIFI_STATE_FAST,        // Trying each network's cached access point
+  WIFI_STATE_SCANNING,
+  WIFI_STATE_JOINING,     // Trying what the scan found, strongest first
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_RETRY_WAIT   // Nothing worked; starts over after WIFI_RETRY_MS
+};
+
+// Joins one of the saved networks without ever blocking: poll() looks at
+// the attempt in flight and moves on when it succeeds, fails or times out.
+// The cached access points go first and a scan only happens when none of
+// them answers. Cache entries that fail are invalidated and new ones are
+// recorded in networks[i].fast; takeCacheChanged() tells the caller to
+// persist them. A join on a cached lease asks DHCP for a real one right
+// after, and the cache follows the address it gets.
+class WiFiConnector {
+public:
+  WiFiConnector(WiFiDriver& radio, std::vector<WiFiNetwork>& networks);
+
+  // Starts over from the cached access points. A scan in progress is left
+  // to finish and is matched against the networks as they are by then.
+  void start();
+  void poll();
+  // The caller erased networks[index]. Indexes kept here move down with
+  // the networks after it; an attempt on the deleted network is dropped
+  // and the next one follows, an attempt on any other carries on.
+  void networkRemoved(size_t index);
+
+  WiFiConnectState state() const { return _state; }
+  // The radio is scanning or joining and can't be used for anything else
+  bool busy() const { return _state == WIFI_STATE_SCANNING || _attempting; }
+  int network() const { return _network; }  // Once connected; -1 if that network was deleted
+  bool joinedFast() const { return _joinedFast; }
+  uint16_t attempts() const { return _attempts; }
+  uint32_t elapsedMs() const { return _elapsedMs; }  // start() to connected
+  // Strongest first
+  const std::vector<WiFiScanResult>& lastScan() const { return _lastScan; }
+  bool takeCacheChanged();
+
+private:
+  struct Candidate {
+    size_t network;
+    bool pinned;
+    uint8_t bssid[6];
+    uint8_t channel;
+  };
+
+  void step(uint32_t now);
+  void scanned(std::vector<WiFiScanResult>& found);
+  void remember(size_t network);
+
+  WiFiDriver& _radio;
+  std::vector<WiFiNetwork>& _networks;
+  std::vector<Candidate> _candidates;
+  std::vector<WiFiScanResult> _lastScan;
+  WiFiConnectState _state;
+  size_t _next;
+  bool _attempting;
+  bool _leased;  // The attempt in flight, or the connection, uses a cached lease
+  uint32_t _attemptStart;
+  uint32_t _cycleStart;
+  uint32_t _retryFrom;
+  int _network;
+  bool _joinedFast;
+  uint16_t _attempts;
+  uint32_t _elapsedMs;
+  bool _cacheChanged;
+};
+
+#endif //WIFI_CONNECT_H
@@ -2,6 +2,10 @@
 #include <WiFi.h>
 #include <Preferences.h>
 #include "config.h"
+#include "hid_handler.h"
+#include "event_stream.h"
+#include "display_manager.h"
+#include "utils.h"
 #include <vector>
 
 Preferences preferences;
@@ -24,25 +28,49 @@ void loadWiFiNetworks() {
     WiFiNetwork net;
     net.ssid = preferences.getString(ssidKey.c_str(), "");
     net.password = preferences.getString(passKey.c_str(), "");
+    String fastKey = "fast" + String(i);
+    if (preferences.getBytesLength(fastKey.c_str()) == sizeof(net.fast)) {
+      preferences.getBytes(fastKey.c_str(), &net.fast, sizeof(net.fast));
+    }
     if (net.ssid.length() > 0) {
       knownNetworks.push_back(net);
     }
   }
 }
 
+static void connectorNetworkRemoved(int index);
+
+// Writes a network's cached access point, only when it changed
+static void saveFastConnect(int index) {
+  String key = "fast" + String(index);
+  const WiFiFastConnect& fast = knownNetworks[index].fast;
+  WiFiFastConnect stored = {};
+  bool present = preferences.getBytesLength(key.c_str()) == sizeof(stored) &&
+                 preferences.getBytes(key.c_str(), &stored, sizeof(stored)) == sizeof(stored);
+
+  if (!fast.valid) {
+    if (present) preferences.remove(key.c_str());
+  } else if (!present || memcmp(&stored, &fast, sizeof(fast)) != 0) {
+    preferences.putBytes(key.c_str(), &fast, sizeof(fast));
+  }
+}
+
 void deleteWiFiNetwork(int index) {
   if (index >= 0 && index < knownNetworks.size()) {
     knownNetworks.erase(knownNetworks.begin() + index);
+    connectorNetworkRemoved(index);
     
     // Rewrite all networks in preferences
     preferences.putInt("wifi_count", knownNetworks.size());
     for (int i = 0; i < knownNetworks.size(); i++) {
       preferences.putString(("ssid" + String(i)).c_str(), knownNetworks[i].ssid);
       preferences.putString(("pass" + String(i)).c_str(), knownNetworks[i].password);
+      saveFastConnect(i);
     }
     // Remove the last key that's no longer used
     preferences.remove(("ssid" + String(knownNetworks.size())).c_str());
     preferences.remove(("pass" + String(knownNetworks.size())).c_str());
+    preferences.remove(("fast" + String(knownNetworks.size())).c_str());
   }
 }
 
@@ -72,81 +100,224 @@ bool addWifiNetwork(String ssid, String password) {
   }
 }
 
-bool connectToWiFi(String ssid, String password) {
-  Serial.println("\nConnecting to: " + ssid);
+// The ESP32 radio behind the connector
+class EspWiFiDriver : public WiFiDriver {
+public:
+  void begin(const String& ssid, const String& password, const uint8_t* bssid, uint8_t channel,
+             const WiFiLease* lease) override {
+    Serial.println("Connecting to: " + ssid + (bssid ? " on channel " + String(channel) : String("")));
+    if (lease) {
+      WiFi.config(IPAddress(lease->ip), IPAddress(lease->gateway), IPAddress(lease->subnet), IPAddress(lease->dns));
+    } else {
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);  // DHCP
+    }
+    WiFi.begin(ssid.c_str(), password.c_str(), channel, bssid);
+  }
+
+  WiFiLink status() override {
+    switch (WiFi.status()) {
+      case WL_CONNECTED: return WIFI_LINK_CONNECTED;
+      case WL_NO_SSID_AVAIL:
+      case WL_CONNECT_FAILED: return WIFI_LINK_FAILED;
+      default: return WIFI_LINK_CONNECTING;
+    }
+  }
+
+  // Leaves the radio on, the next attempt follows right away
+  void disconnect() override { WiFi.disconnect(); }
+
+  bool startScan() override {
+    Serial.println("Scanning for available networks...");
+    return WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+  }
 
-  // Clean up previous connection attempts
-  WiFi.disconnect(true);
-  delay(100);
+  int scanResults(std::vector<WiFiScanResult>& results) override {
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return WIFI_SCAN_PENDING;
+    Serial.println("Scan done, found " + String(max(n, 0)) + " networks");
+    return collect(n, results);
+  }
 
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid.c_str(), password.c_str());
+  void current(WiFiFastConnect& fast) override {
+    memcpy(fast.bssid, WiFi.BSSID(), sizeof(fast.bssid));
+    fast.channel = WiFi.channel();
+    fast.lease.ip = WiFi.localIP();
+    fast.lease.gateway = WiFi.gatewayIP();
+    fast.lease.subnet = WiFi.subnetMask();
+    fast.lease.dns = WiFi.dnsIP();
+  }
 
-  unsigned long startTime = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - startTime > WIFI_TIMEOUT) {
-      Serial.println("\nConnection timed out");
-      return false;
+  // With no address given the station's DHCP client starts again and,
+  // the link being up, asks for a lease right away
+  void renewLease() override {
+    Serial.println("Renewing the cached lease with DHCP");
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+  }
+
+  uint32_t millis() override { return ::millis(); }
+
+  // Copies and frees the results of a finished scan
+  static int collect(int n, std::vector<WiFiScanResult>& results) {
+    for (int i = 0; i < n; i++) {
+      WiFiScanResult ap;
+      ap.ssid = WiFi.SSID(i);
+      ap.rssi = WiFi.RSSI(i);
+      memcpy(ap.bssid, WiFi.BSSID(i), sizeof(ap.bssid));
+      ap.channel = WiFi.channel(i);
+      ap.encryption = WiFi.encryptionType(i);
+      results.push_back(ap);
     }
-    delay(500);
-    Serial.print(".");
+    WiFi.scanDelete();
+    return max(n, 0);
   }
+};
+
+static EspWiFiDriver radio;
+static WiFiConnector connector(radio, knownNetworks);
+static WiFiConnectState reportedState = WIFI_STATE_IDLE;
+static volatile bool wifiEventPending = false;
+static unsigned long lastWiFiPoll = 0;
 
-  Serial.println("\nConnected to WiFi!");
-  Serial.println("IP: " + WiFi.localIP().toString());
-  isAPMode = false;
-  currentSSID = ssid;
-  currentPassword = password;
+// Keeps the connector's indexes on the same networks; a join in progress
+// on another network carries on
+static void connectorNetworkRemoved(int index) {
+  connector.networkRemoved(index);
+}
+
+// Runs in the WiFi task; handleWiFi() does the work
+static void onWiFiEvent(arduino_event_id_t event) {
+  wifiEventPending = true;
+}
+
+static bool startSetupAP(wifi_mode_t mode) {
+  WiFi.mode(mode);
+  if (!WiFi.softAP(AP_SSID, AP_PASS)) {
+    Serial.println("Failed to start AP Mode!");
+    isAPMode = false;
+    return false;
+  }
+  Serial.println("AP Mode started");
+  Serial.println("SSID: " + String(AP_SSID));
+  Serial.println("Password: " + String(AP_PASS));
+  Serial.print("AP IP Address: ");
+  Serial.println(WiFi.softAPIP());
+  isAPMode = true;
   return true;
 }
 
-bool connectToAnyWiFi() {
+void startWiFi() {
+  WiFi.persistent(false);        // Don't let the SDK write every attempt to flash
+  WiFi.setAutoReconnect(false);  // The connector does the reconnecting
+  WiFi.onEvent(onWiFiEvent);
+
   if (knownNetworks.empty()) {
-    return false;
+    Serial.println("No saved credentials, starting AP mode");
+    startAPMode();
+    return;
   }
 
-  Serial.println("Scanning for available networks...");
-  int n = WiFi.scanNetworks();
-  Serial.println("Scan done, found " + String(n) + " networks");
+  // The setup network is there from the start, whatever the station does
+  Serial.println("Connecting to saved networks in the background");
+  startSetupAP(WIFI_AP_STA);
+  connector.start();
+  publishEvent("status", getStatusJson());
+}
+
+void handleWiFi() {
+  // Events cut the wait short; the interval catches timeouts
+  if (!wifiEventPending && millis() - lastWiFiPoll < WIFI_POLL_MS) return;
+  wifiEventPending = false;
+  lastWiFiPoll = millis();
 
-  if (n <= 0) {
-    Serial.println("No networks found in scan, but trying known networks anyway...");
-    for (const auto& net : knownNetworks) {
-      if (connectToWiFi(net.ssid, net.password)) {
-        return true;
-      }
+  connector.poll();
+  bool cacheChanged = connector.takeCacheChanged();
+  if (cacheChanged) {
+    for (size_t i = 0; i < knownNetworks.size(); i++) {
+      saveFastConnect(i);
     }
-    return false;
   }
 
-  // Iterate through available networks and check if they are in our known list
-  for (int i = 0; i < n; i++) {
-    String foundSSID = WiFi.SSID(i);
-    for (const auto& net : knownNetworks) {
-      if (net.ssid == foundSSID) {
-        Serial.println("Found known network: " + foundSSID);
-        if (connectToWiFi(net.ssid, net.password)) {
-          return true;
-        }
-      }
+  WiFiConnectState state = connector.state();
+  // Also when DHCP replaced a cached lease after a fast join
+  bool changed = cacheChanged && state == WIFI_STATE_CONNECTED;
+  if (state != reportedState) {
+    if (state == WIFI_STATE_CONNECTED) {
+      const WiFiNetwork& net = knownNetworks[connector.network()];
+      Serial.println("Joined " + net.ssid + " in " + String(connector.elapsedMs()) + " ms, " +
+                     String(connector.attempts()) + (connector.joinedFast() ? " attempt(s) from the cached access point" : " attempt(s)"));
+      Serial.println("IP: " + WiFi.localIP().toString());
+      currentSSID = net.ssid;
+      currentPassword = net.password;
+    } else if (reportedState == WIFI_STATE_CONNECTED) {
+      Serial.println("WiFi connection lost, reconnecting");
+    } else if (state == WIFI_STATE_RETRY_WAIT) {
+      Serial.println("None of the known networks could be connected to, retrying in " + String(WIFI_RETRY_MS / 1000) + " s");
+      if (!isAPMode) startSetupAP(WIFI_AP_STA);
     }
+    reportedState = state;
+    changed = true;
   }
 
-  Serial.println("None of the known networks were available or could be connected to.");
-  return false;
+  // The setup network stays up while someone is still on it
+  if (state == WIFI_STATE_CONNECTED && isAPMode && WiFi.softAPgetStationNum() == 0) {
+    WiFi.softAPdisconnect(true);
+    isAPMode = false;
+    Serial.println("Setup AP closed");
+    changed = true;
+  }
+
+  if (changed) {
+    publishEvent("status", getStatusJson());
+    updateDisplayStatus();
+  }
+}
+
+void wifiNetworksChanged() {
+  if (connector.state() == WIFI_STATE_CONNECTED) return;
+  if (!knownNetworks.empty() && WiFi.getMode() == WIFI_AP) {
+    WiFi.mode(WIFI_AP_STA);
+  }
+  connector.start();
+}
+
+int scanWiFiNetworks(std::vector<WiFiScanResult>& results) {
+  // A join in progress owns the radio; answer from the connector's scan
+  if (connector.busy()) {
+    results = connector.lastScan();
+    return results.size();
+  }
+  return EspWiFiDriver::collect(WiFi.scanNetworks(), results);
 }
 
 void startAPMode() {
-  WiFi.mode(WIFI_AP);
-  if (WiFi.softAP(AP_SSID, AP_PASS)) {
-    Serial.println("AP Mode started");
-    Serial.println("SSID: " + String(AP_SSID));
-    Serial.println("Password: " + String(AP_PASS));
-    Serial.print("AP IP Address: ");
-    Serial.println(WiFi.softAPIP());
-    isAPMode = true;
-  } else {
-    Serial.println("Failed to start AP Mode!");
-    isAPMode = false;
+  if (startSetupAP(WIFI_AP)) {
+    publishEvent("status", getStatusJson());
+  }
+}
+
+static const char* wifiStateName(WiFiConnectState state) {
+  switch (state) {
+    case WIFI_STATE_FAST:
+    case WIFI_STATE_SCANNING:
+    case WIFI_STATE_JOINING: return "connecting";
+    case WIFI_STATE_CONNECTED: return "connected";
+    case WIFI_STATE_RETRY_WAIT: return "waiting";
+    default: return "idle";
   }
 }
+
+String getStatusJson() {
+  String json = "{";
+  // Once the station is up its address is the one worth showing, even
+  // while the setup AP is still open
+  bool station = WiFi.status() == WL_CONNECTED;
+  bool showAP = isAPMode && !station;
+  json += "\"wifi_mode\":\"" + String(isAPMode ? (station ? "AP+Station" : "AP") : "Station") + "\",";
+  json += "\"wifi_state\":\"" + String(wifiStateName(connector.state())) + "\",";
+  json += "\"ssid\":\"" + escapeJson(showAP ? String(AP_SSID) : currentSSID) + "\",";
+  json += "\"ip\":\"" + (showAP ? String("192.168.4.1") : WiFi.localIP().toString()) + "\",";
+  json += "\"connected\":" + String(station ? "true" : "false") + ",";
+  json += "\"jiggler\":" + String(isJigglerEnabled() ? "true" : "false");
+  json += "}";
+  return json;
+}
@@ -3,19 +3,23 @@
 
 #include <Arduino.h>
 #include <vector>
-
-struct WiFiNetwork {
-  String ssid;
-  String password;
-};
+#include "wifi_connect.h"
 
 void setupPreferences();
 void loadWiFiNetworks();
 void deleteWiFiNetwork(int index);
 bool addWifiNetwork(String ssid, String password);
-bool connectToWiFi(String ssid, String password);
-bool connectToAnyWiFi();
+// Opens the setup AP and starts joining a saved network in the background;
+// AP only when there are none
+void startWiFi();
+// Drives the connection from loop(): failover, reconnects, closing the AP
+void handleWiFi();
+// Saved networks were added or restored; tries again unless connected
+void wifiNetworksChanged();
+// Scans now, or returns the connector's last scan while it holds the radio
+int scanWiFiNetworks(std::vector<WiFiScanResult>& results);
 void startAPMode();
+String getStatusJson();
 
 extern std::vector<WiFiNetwork> knownNetworks;
 extern String currentSSID;
@@ -0,0 +1,62 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+// Text drawing as Adafruit_GFX does it with the built-in font: 6x8 cells
+// scaled by the text size, wrapping at the right edge, transparent when
+// the background equals the color
+
+#include <Arduino.h>
+#include "glcdfont.h"
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+  void setTextColor(uint16_t color) { _textColor = _textBackground = color; }
+  void setTextColor(uint16_t color, uint16_t background) { _textColor = color; _textBackground = background; }
+  void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+
+  size_t write(uint8_t c) override {
+    if (c == '\r') return 1;
+    if (c == '\n') {
+      _cursorX = 0;
+      _cursorY += 8 * _textSize;
+      return 1;
+    }
+    if (_cursorX + 6 * _textSize > _width) {
+      _cursorX = 0;
+      _cursorY += 8 * _textSize;
+    }
+    for (int col = 0; col < 6; col++) {
+      uint8_t bits = col < 5 ? glcdColumn(c, col) : 0;
+      for (int row = 0; row < 8; row++) {
+        bool on = bits & (1 << row);
+        if (!on && _textBackground == _textColor) continue;
+        for (int j = 0; j < _textSize; j++) {
+          for (int i = 0; i < _textSize; i++) {
+            drawPixel(_cursorX + col * _textSize + i, _cursorY + row * _textSize + j, on ? _textColor : _textBackground);
+          }
+        }
+      }
+    }
+    _cursorX += 6 * _textSize;
+    return 1;
+  }
+  using Print::write;
+
+protected:
+  int16_t _width;
+  int16_t _height;
+  int16_t _cursorX = 0;
+  int16_t _cursorY = 0;
+  uint16_t _textColor = 0xFFFF;
+  uint16_t _textBackground = 0xFFFF;
+  uint8_t _textSize = 1;
+};
+
+#endif //HOST_ADAFRUIT_GFX_H
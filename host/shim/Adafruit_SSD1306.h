@@ -0,0 +1,72 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+// The SSD1306 library's frame buffer and display(), which sends the whole
+// buffer the way the library does: page and column windows as commands,
+// then the data in Wire-buffer-sized transactions
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <vector>
+#include "Adafruit_GFX.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* wire, int8_t resetPin)
+    : Adafruit_GFX(w, h), _wire(wire), _buffer((size_t)w * ((h + 7) / 8), 0) {}
+
+  // Like the library, true whether or not anything answered
+  bool begin(uint8_t vcc = SSD1306_SWITCHCAPVCC, uint8_t address = 0x3C) {
+    _address = address;
+    static const uint8_t init[] = { 0xAE, 0x20, 0x00, 0xAF };  // Off, horizontal addressing, on
+    commands(init, sizeof(init));
+    return true;
+  }
+
+  uint8_t* getBuffer() { return _buffer.data(); }
+  void clearDisplay() { std::fill(_buffer.begin(), _buffer.end(), 0); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t& cell = _buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+    if (color == SSD1306_WHITE) cell |= bit;
+    else if (color == SSD1306_BLACK) cell &= ~bit;
+    else cell ^= bit;
+  }
+
+  void display() {
+    const uint8_t window[] = { 0x22, 0, 0xFF, 0x21, 0 };
+    commands(window, sizeof(window));
+    const uint8_t lastColumn = _width - 1;
+    commands(&lastColumn, 1);
+
+    for (size_t sent = 0; sent < _buffer.size();) {
+      size_t count = std::min(_buffer.size() - sent, (size_t)BUFFER_LENGTH - 1);
+      _wire->beginTransmission(_address);
+      _wire->write((uint8_t)0x40);
+      _wire->write(_buffer.data() + sent, count);
+      _wire->endTransmission();
+      sent += count;
+    }
+  }
+
+private:
+  void commands(const uint8_t* list, size_t count) {
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x00);
+    _wire->write(list, count);
+    _wire->endTransmission();
+  }
+
+  TwoWire* _wire;
+  std::vector<uint8_t> _buffer;
+  uint8_t _address = 0x3C;
+};
+
+#endif //HOST_ADAFRUIT_SSD1306_H
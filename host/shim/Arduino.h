@@ -0,0 +1,246 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino-ESP32 core to build the firmware's storage,
+// display and WiFi logic on a PC. String keeps Arduino's semantics on top
+// of std::string; Serial writes to stdout.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+#include <algorithm>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define HEX 16
+#define DEC 10
+#define F(x) x
+#define PROGMEM
+
+// NodeMCU pin names
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+
+unsigned long millis();
+unsigned long micros();
+// Moves the clock on instead of sleeping, so a test steps through
+// timeouts without waiting for them
+void delay(unsigned long ms);
+inline void yield() {}
+
+class String {
+public:
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& c) : s(c) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = 10) : s(number((long long)v, base)) {}
+  String(unsigned int v, unsigned char base = 10) : s(number((unsigned long long)v, base)) {}
+  String(long v, unsigned char base = 10) : s(number((long long)v, base)) {}
+  String(unsigned long v, unsigned char base = 10) : s(number((unsigned long long)v, base)) {}
+  String(long long v, unsigned char base = 10) : s(number(v, base)) {}
+  String(unsigned long long v, unsigned char base = 10) : s(number(v, base)) {}
+  String(double v, unsigned int decimals = 2) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s = buf;
+  }
+
+  unsigned int length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  const char* c_str() const { return s.c_str(); }
+  char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char& operator[](unsigned int i) { return s[i]; }
+  void setCharAt(unsigned int i, char c) { if (i < s.size()) s[i] = c; }
+
+  int indexOf(char c, unsigned int from = 0) const { return found(s.find(c, from)); }
+  int indexOf(const String& c, unsigned int from = 0) const { return found(s.find(c.s, from)); }
+  int lastIndexOf(char c) const { return found(s.rfind(c)); }
+  int lastIndexOf(const String& c) const { return found(s.rfind(c.s)); }
+  String substring(unsigned int from) const { return from >= s.size() ? String() : String(s.substr(from)); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.size()) return String();
+    return String(s.substr(from, to - from));
+  }
+  bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  bool startsWith(const String& p, unsigned int off) const { return off <= s.size() && s.compare(off, p.s.size(), p.s) == 0; }
+  bool endsWith(const String& p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+  bool equals(const String& o) const { return s == o.s; }
+  bool equalsIgnoreCase(const String& o) const {
+    return s.size() == o.s.size() &&
+           std::equal(s.begin(), s.end(), o.s.begin(), [](char a, char b) { return tolower(a) == tolower(b); });
+  }
+
+  void replace(const String& from, const String& to) {
+    if (from.s.empty()) return;
+    for (size_t p = s.find(from.s); p != std::string::npos; p = s.find(from.s, p + to.s.size())) s.replace(p, from.s.size(), to.s);
+  }
+  void replace(char from, char to) { std::replace(s.begin(), s.end(), from, to); }
+  void trim() {
+    size_t a = 0, b = s.size();
+    while (a < b && isspace((unsigned char)s[a])) a++;
+    while (b > a && isspace((unsigned char)s[b - 1])) b--;
+    s = s.substr(a, b - a);
+  }
+  void toUpperCase() { for (auto& c : s) c = toupper((unsigned char)c); }
+  void toLowerCase() { for (auto& c : s) c = tolower((unsigned char)c); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  bool reserve(unsigned int n) { s.reserve(n); return true; }
+  void remove(unsigned int i) { if (i < s.size()) s.erase(i); }
+  void remove(unsigned int i, unsigned int n) { if (i < s.size()) s.erase(i, n); }
+
+  bool concat(const String& o) { s += o.s; return true; }
+  bool concat(const char* o) { s += o; return true; }
+  bool concat(const char* o, unsigned int n) { s.append(o, n); return true; }
+  bool concat(char c) { s += c; return true; }
+  template <typename T> String& operator+=(const T& v) { s += String(v).s; return *this; }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  bool operator<(const String& o) const { return s < o.s; }
+
+  void getBytes(unsigned char* buf, unsigned int n, unsigned int idx = 0) const { toCharArray((char*)buf, n, idx); }
+  void toCharArray(char* buf, unsigned int n, unsigned int idx = 0) const {
+    if (!n) return;
+    size_t len = idx < s.size() ? std::min<size_t>(n - 1, s.size() - idx) : 0;
+    memcpy(buf, s.data() + idx, len);
+    buf[len] = 0;
+  }
+  char* begin() { return &s[0]; }
+  char* end() { return &s[0] + s.size(); }
+
+  std::string s;
+
+private:
+  static int found(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  static std::string number(unsigned long long v, unsigned char base) {
+    if (base == 10) return std::to_string(v);
+    std::string out;
+    do { out.insert(out.begin(), "0123456789abcdefghijklmnopqrstuvwxyz"[v % base]); v /= base; } while (v);
+    return out;
+  }
+  static std::string number(long long v, unsigned char base) {
+    return v < 0 && base == 10 ? "-" + number((unsigned long long)-v, base) : number((unsigned long long)v, base);
+  }
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(a + b.s); }
+inline String operator+(const String& a, char b) { return String(a.s + b); }
+template <typename T> String operator+(const String& a, T b) { return String(a.s + String(b).s); }
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t done = 0;
+    while (done < n && write(buf[done])) done++;
+    return done;
+  }
+  size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+  size_t write(const char* buf, size_t n) { return write((const uint8_t*)buf, n); }
+  size_t print(const String& v) { return write(v.c_str(), v.length()); }
+  size_t print(const char* v) { return write(v); }
+  size_t print(char v) { return write((uint8_t)v); }
+  template <typename T> size_t print(T v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  template <typename T> size_t println(T v, int base) { return print(v, base) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return n > 0 ? write(buf, std::min<size_t>(n, sizeof(buf) - 1)) : 0;
+  }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  size_t readBytes(uint8_t* buf, size_t n) {
+    size_t done = 0;
+    for (int c; done < n && (c = read()) >= 0;) buf[done++] = c;
+    return done;
+  }
+  size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+  String readStringUntil(char end) {
+    String out;
+    for (int c; (c = read()) >= 0 && c != end;) out += (char)c;
+    return out;
+  }
+  void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buf, size_t n) override { return fwrite(buf, 1, n, stdout); }
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+bool psramFound();
+void* ps_malloc(size_t n);
+
+// FreeRTOS, single threaded: a host test runs the tasks' work inline
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+#define portMAX_DELAY 0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) (ms)
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return (SemaphoreHandle_t)1; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+inline void vTaskDelay(TickType_t) {}
+inline TickType_t xTaskGetTickCount() { return millis(); }
+// Tasks are never started, so callers fall back to doing the work inline
+typedef void (*TaskFunction_t)(void*);
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack, void* arg,
+                                          unsigned priority, TaskHandle_t* handle, BaseType_t core) {
+  if (handle) *handle = nullptr;
+  return pdFAIL;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) { return 0; }
+inline void xTaskNotifyGive(TaskHandle_t task) {}
+
+#endif //HOST_ARDUINO_H
@@ -0,0 +1,7 @@
+#ifndef HOST_ESP8266WIFI_H
+#define HOST_ESP8266WIFI_H
+
+// The NodeMCU sketch only asks for the station address, as the ESP32 does
+#include "WiFi.h"
+
+#endif //HOST_ESP8266WIFI_H
@@ -0,0 +1,87 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// fs::FS over a directory of the host. Every File call is a system call,
+// as every LittleFS call is a trip through the VFS and the flash driver,
+// so the cost of small reads shows up the same way.
+
+#include <Arduino.h>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+  File() {}
+  File(int fd, const String& path, const String& hostPath, bool directory);
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override { return _handle ? (int)(size() - position()) : 0; }
+  int read() override {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int peek() override;
+  size_t read(uint8_t* buf, size_t n);
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close() { _handle.reset(); }
+  operator bool() const { return _handle != nullptr; }
+  time_t getLastWrite();
+  const char* path() const { return _path.c_str(); }
+  const char* name() const;
+  bool isDirectory() const { return _handle && _handle->directory; }
+  File openNextFile(const char* mode = "r");
+
+  // Calls made to the file system since the counter was last reset
+  static uint32_t calls;
+
+private:
+  struct Handle {
+    int fd;
+    bool directory;
+    DIR* dir;
+    String hostPath;
+    ~Handle();
+  };
+  std::shared_ptr<Handle> _handle;
+  String _path;
+};
+
+class FS {
+public:
+  // root: host directory that stands for "/"
+  explicit FS(const String& root) : _root(root) {}
+
+  File open(const String& path, const char* mode = "r", bool create = false);
+  bool exists(const String& path);
+  bool remove(const String& path);
+  bool rename(const String& from, const String& to);
+  bool mkdir(const String& path);
+  bool rmdir(const String& path);
+
+  String hostPath(const String& path) const { return _root + path; }
+
+private:
+  String _root;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif //HOST_FS_H
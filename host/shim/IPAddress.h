@@ -0,0 +1,22 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+  IPAddress() : _address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t address) : _address(address) {}
+
+  operator uint32_t() const { return _address; }
+  uint8_t operator[](int i) const { return (_address >> (i * 8)) & 0xFF; }
+  String toString() const {
+    return String((*this)[0]) + "." + String((*this)[1]) + "." + String((*this)[2]) + "." + String((*this)[3]);
+  }
+
+private:
+  uint32_t _address;  // First octet in the low byte, as on the device
+};
+
+#endif //HOST_IPADDRESS_H
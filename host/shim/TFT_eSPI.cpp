@@ -0,0 +1,99 @@
+#include "TFT_eSPI.h"
+#include "glcdfont.h"
+
+static uint16_t swap16(uint16_t v) {
+  return (v >> 8) | (v << 8);
+}
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _panelWidth(w), _panelHeight(h), _width(0), _height(0) {
+  resize(w, h);
+}
+
+void TFT_eSPI::resize(int16_t w, int16_t h) {
+  _width = w;
+  _height = h;
+  _pixels.assign((size_t)w * h, 0);
+}
+
+// Landscape rotations swap the sides; what was shown is lost, as the
+// panel's memory is read out the other way round
+void TFT_eSPI::setRotation(uint8_t rotation) {
+  if (rotation & 1) resize(_panelHeight, _panelWidth);
+  else resize(_panelWidth, _panelHeight);
+}
+
+bool TFT_eSPI::clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  return w > 0 && h > 0;
+}
+
+void TFT_eSPI::sent(int32_t w, int32_t h) {
+  if (_sprite) return;
+  transfers++;
+  bytes += TFT_WINDOW_BYTES + (uint64_t)w * h * 2;
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!clip(x, y, w, h)) return;
+  for (int32_t j = 0; j < h; j++) {
+    for (int32_t i = 0; i < w; i++) store(x + i, y + j, color);
+  }
+  sent(w, h);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!clip(cx, cy, cw, ch)) return;
+  for (int32_t j = 0; j < ch; j++) {
+    const uint16_t* row = data + (size_t)(cy - y + j) * w + (cx - x);
+    for (int32_t i = 0; i < cw; i++) store(cx + i, cy + j, _swapBytes ? row[i] : swap16(row[i]));
+  }
+  sent(cw, ch);
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+  if (c == '\r') return 1;
+  if (c == '\n') {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+    return 1;
+  }
+  if (_cursorX + 6 * _textSize > _width) {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+  }
+
+  bool opaque = _textColor != _textBackground;
+  for (int col = 0; col < 6; col++) {
+    uint8_t bits = col < 5 ? glcdColumn(c, col) : 0;
+    for (int row = 0; row < 8; row++) {
+      bool on = bits & (1 << row);
+      if (!on && !opaque) continue;
+      int32_t x = _cursorX + col * _textSize, y = _cursorY + row * _textSize, w = _textSize, h = _textSize;
+      if (!clip(x, y, w, h)) continue;
+      for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) store(x + i, y + j, on ? _textColor : _textBackground);
+      }
+    }
+  }
+
+  // One window for the whole character cell
+  int32_t x = _cursorX, y = _cursorY, w = 6 * _textSize, h = 8 * _textSize;
+  if (clip(x, y, w, h)) sent(w, h);
+  _cursorX += 6 * _textSize;
+  return 1;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) const {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  uint16_t v = _pixels[(size_t)y * _width + x];
+  return _sprite ? swap16(v) : v;
+}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+  resize(w, h);
+  return _pixels.data();
+}
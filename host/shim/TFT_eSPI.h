@@ -0,0 +1,110 @@
+#ifndef HOST_TFT_ESPI_H
+#define HOST_TFT_ESPI_H
+
+// TFT_eSPI drawing into memory instead of over SPI: the 80x160 ST7735 of
+// the T-Dongle-S3, and sprites. The panel keeps the colors it was sent
+// and counts what reaching it took on the bus, one address window plus
+// 2 bytes per pixel for each fill, character or image.
+
+#include <Arduino.h>
+#include <vector>
+
+#define TFT_WIDTH 80
+#define TFT_HEIGHT 160
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_BLUE 0x001F
+#define TFT_CYAN 0x07FF
+#define TFT_YELLOW 0xFFE0
+#define TFT_ORANGE 0xFDA0
+
+#define PSRAM_ENABLE 3
+
+#define TFT_WINDOW_BYTES 11  // CASET + RASET + RAMWR and their parameters
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+
+  void init() {}
+  void setRotation(uint8_t rotation);
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+  void drawPixel(int32_t x, int32_t y, uint32_t color) { fillRect(x, y, 1, 1, color); }
+
+  // Font 1 only: 6x8 cells, scaled by the text size. Text wraps at the
+  // right edge; with the background equal to the color it is transparent.
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+  void setTextColor(uint16_t color) { _textColor = _textBackground = color; }
+  void setTextColor(uint16_t color, uint16_t background) { _textColor = color; _textBackground = background; }
+  void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // Image data is RGB565 in the panel's (big-endian) byte order, or in
+  // native order with swapped bytes on
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() const { return _swapBytes; }
+  void startWrite() {}
+  void endWrite() {}
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+
+  // The copy is done by the time pushImageDMA() returns, so a transfer is
+  // never seen running
+  bool initDMA(bool ctrlCS = false) { return true; }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, uint16_t* buffer = nullptr) {
+    pushImage(x, y, w, h, data);
+  }
+  bool dmaBusy() { return false; }
+  void dmaWait() {}
+
+  // Host side: what the panel shows, as native RGB565
+  uint16_t readPixel(int32_t x, int32_t y) const;
+  uint32_t transfers = 0;
+  uint64_t bytes = 0;
+
+protected:
+  void resize(int16_t w, int16_t h);
+  bool clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const;
+  void sent(int32_t w, int32_t h);
+  void store(int32_t x, int32_t y, uint16_t color) {
+    _pixels[(size_t)y * _width + x] = _sprite ? (uint16_t)((color >> 8) | (color << 8)) : color;
+  }
+
+  // A TFT_eSprite keeps its pixels byte-swapped, ready to go out by DMA,
+  // and sends nothing
+  bool _sprite = false;
+  std::vector<uint16_t> _pixels;
+
+private:
+  int16_t _panelWidth;
+  int16_t _panelHeight;
+  int16_t _width;
+  int16_t _height;
+  int32_t _cursorX = 0;
+  int32_t _cursorY = 0;
+  uint16_t _textColor = TFT_WHITE;
+  uint16_t _textBackground = TFT_WHITE;
+  uint8_t _textSize = 1;
+  bool _swapBytes = false;
+};
+
+// An off-screen frame. Nothing drawn into it is counted as sent.
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0) { _sprite = true; }
+
+  void setColorDepth(int8_t depth) {}
+  void setAttribute(uint8_t attribute, uint8_t value) {}
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite() { resize(0, 0); }
+};
+
+#endif //HOST_TFT_ESPI_H
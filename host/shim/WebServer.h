@@ -0,0 +1,7 @@
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+// Only named by headers the host build includes; nothing serves requests
+class WebServer;
+
+#endif //HOST_WEBSERVER_H
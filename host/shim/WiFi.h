@@ -0,0 +1,30 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// The station state the status screens show. A test sets it directly;
+// joining networks goes through WiFiDriver, see wifi_connect.h.
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+  wl_status_t status() { return hostStatus; }
+  IPAddress localIP() { return hostIP; }
+
+  wl_status_t hostStatus = WL_DISCONNECTED;
+  IPAddress hostIP;
+};
+
+extern WiFiClass WiFi;
+
+#endif //HOST_WIFI_H
@@ -0,0 +1,63 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (_length >= sizeof(_buffer)) return 0;
+  _buffer[_length++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t count) {
+  size_t done = 0;
+  while (done < count && write(data[done])) done++;
+  return done;
+}
+
+// The first byte is the SSD1306 control byte: 0x00 for a command
+// stream, 0x40 for data. A command's parameters may follow in a later
+// transaction, as the display library sends them.
+uint8_t TwoWire::endTransmission(bool stop) {
+  if (_address != hostAddress) return 2;
+  transactions++;
+  bytes += 1 + _length;
+  if (_length == 0) return 0;
+  for (size_t i = 1; i < _length; i++) {
+    if (_buffer[0] == 0x40) data(_buffer[i]);
+    else command(_buffer[i]);
+  }
+  return 0;
+}
+
+void TwoWire::command(uint8_t byte) {
+  if (_argCount < _argsWanted) {
+    _args[_argCount++] = byte;
+    if (_argCount < _argsWanted) return;
+    if (_command == 0x21) {
+      _colStart = _col = _args[0] % SSD1306_HOST_COLUMNS;
+      _colEnd = _args[1] % SSD1306_HOST_COLUMNS;
+    } else if (_command == 0x22) {
+      _pageStart = _page = _args[0] % SSD1306_HOST_PAGES;
+      _pageEnd = _args[1] % SSD1306_HOST_PAGES;
+    }
+    _argsWanted = _argCount = 0;
+    return;
+  }
+
+  _command = byte;
+  _argCount = 0;
+  // Memory mode takes one parameter, column and page address two
+  _argsWanted = byte == 0x20 ? 1 : (byte == 0x21 || byte == 0x22) ? 2 : 0;
+}
+
+void TwoWire::data(uint8_t byte) {
+  ram[_page][_col] = byte;
+  if (_col++ < _colEnd) return;
+  _col = _colStart;
+  if (_page++ >= _pageEnd) _page = _pageStart;
+}
@@ -0,0 +1,50 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+// I2C with an SSD1306 on the bus. The emulated controller only knows
+// horizontal addressing and the column/page address commands, which is
+// all the sketch and the display library use to write its memory, so a
+// test can check the panel against the frame it was meant to show and
+// count the bytes it took.
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 128  // ESP8266 core Wire buffer
+
+#define SSD1306_HOST_PAGES 8
+#define SSD1306_HOST_COLUMNS 128
+
+class TwoWire {
+public:
+  void begin(int sda = -1, int scl = -1) {}
+  void setClock(uint32_t frequency) {}
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t count);
+  // 0 when the device acknowledged, 2 for an address nobody answers
+  uint8_t endTransmission(bool stop = true);
+
+  // Host side
+  uint8_t hostAddress = 0x3C;
+  uint8_t ram[SSD1306_HOST_PAGES][SSD1306_HOST_COLUMNS] = {};
+  uint32_t transactions = 0;  // Acknowledged ones
+  uint32_t bytes = 0;         // Address byte included
+
+private:
+  void command(uint8_t byte);
+  void data(uint8_t byte);
+
+  uint8_t _address = 0;
+  uint8_t _buffer[BUFFER_LENGTH];
+  size_t _length = 0;
+  uint8_t _command = 0;
+  uint8_t _args[2];
+  uint8_t _argsWanted = 0;
+  uint8_t _argCount = 0;
+  uint8_t _colStart = 0, _colEnd = SSD1306_HOST_COLUMNS - 1, _col = 0;
+  uint8_t _pageStart = 0, _pageEnd = SSD1306_HOST_PAGES - 1, _page = 0;
+};
+
+extern TwoWire Wire;
+
+#endif //HOST_WIRE_H
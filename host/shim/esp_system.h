@@ -0,0 +1,13 @@
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#include <stdint.h>
+#include <random>
+
+// Hardware RNG on the device; tests only need the values to differ
+inline uint32_t esp_random() {
+  static std::mt19937 rng(std::random_device{}());
+  return rng();
+}
+
+#endif //HOST_ESP_SYSTEM_H
@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <WiFi.h>
+#include <chrono>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+static unsigned long skippedUs = 0;
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count() +
+         skippedUs;
+}
+
+void delay(unsigned long ms) {
+  skippedUs += ms * 1000;
+}
+
+bool psramFound() {
+  return true;
+}
+
+void* ps_malloc(size_t n) {
+  return malloc(n);
+}
+
+namespace fs {
+
+uint32_t File::calls = 0;
+
+File::Handle::~Handle() {
+  if (dir) closedir(dir);
+  if (fd >= 0) ::close(fd);
+}
+
+File::File(int fd, const String& path, const String& hostPath, bool directory) : _path(path) {
+  _handle.reset(new Handle{ fd, directory, directory ? opendir(hostPath.c_str()) : nullptr, hostPath });
+}
+
+size_t File::write(const uint8_t* buf, size_t n) {
+  calls++;
+  if (!_handle || _handle->fd < 0) return 0;
+  ssize_t done = ::write(_handle->fd, buf, n);
+  return done > 0 ? done : 0;
+}
+
+size_t File::read(uint8_t* buf, size_t n) {
+  calls++;
+  if (!_handle || _handle->fd < 0) return 0;
+  ssize_t done = ::read(_handle->fd, buf, n);
+  return done > 0 ? done : 0;
+}
+
+int File::peek() {
+  size_t pos = position();
+  int c = read();
+  seek(pos);
+  return c;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  calls++;
+  static const int whence[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+  return _handle && _handle->fd >= 0 && lseek(_handle->fd, pos, whence[mode]) >= 0;
+}
+
+size_t File::position() const {
+  calls++;
+  return _handle && _handle->fd >= 0 ? lseek(_handle->fd, 0, SEEK_CUR) : 0;
+}
+
+size_t File::size() const {
+  struct stat st;
+  return _handle && _handle->fd >= 0 && fstat(_handle->fd, &st) == 0 ? st.st_size : 0;
+}
+
+time_t File::getLastWrite() {
+  struct stat st;
+  return _handle && stat(_handle->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char* File::name() const {
+  int slash = _path.lastIndexOf('/');
+  return _path.c_str() + slash + 1;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!isDirectory()) return File();
+  for (dirent* entry; (entry = readdir(_handle->dir));) {
+    String name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    String path = _path.endsWith("/") ? _path + name : _path + "/" + name;
+    String host = _handle->hostPath + "/" + name;
+    struct stat st;
+    if (stat(host.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) return File(-1, path, host, true);
+    return File(::open(host.c_str(), O_RDONLY), path, host, false);
+  }
+  return File();
+}
+
+File FS::open(const String& path, const char* mode, bool create) {
+  String host = hostPath(path);
+  struct stat st;
+  if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) return File(-1, path, host, true);
+
+  String m = mode;
+  int flags = O_RDONLY;
+  if (m == "w") flags = O_WRONLY | O_CREAT | O_TRUNC;
+  else if (m == "a") flags = O_WRONLY | O_CREAT | O_APPEND;
+  else if (m == "r+") flags = O_RDWR;
+  else if (m == "w+") flags = O_RDWR | O_CREAT | O_TRUNC;
+  int fd = ::open(host.c_str(), flags, 0644);
+  return fd < 0 ? File() : File(fd, path, host, false);
+}
+
+bool FS::exists(const String& path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const String& path) {
+  return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const String& from, const String& to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const String& path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const String& path) {
+  return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}  // namespace fs
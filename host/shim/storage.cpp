@@ -0,0 +1,41 @@
+#include "storage.h"
+#include <filesystem>
+#include <vector>
+
+bool storageAvailable = false;
+bool usingSD = false;
+fs::FS* storageFS = nullptr;
+
+static fs::FS* hostFS = nullptr;
+static String hostRoot;
+
+static void removeHostStorage() {
+  std::filesystem::remove_all(hostRoot.c_str());
+}
+
+const String& mountHostStorage(const char* name) {
+  std::vector<char> dir(String("/tmp/" + String(name) + "-XXXXXX").length() + 1);
+  String("/tmp/" + String(name) + "-XXXXXX").toCharArray(dir.data(), dir.size());
+  if (!mkdtemp(dir.data())) abort();
+
+  if (hostRoot.isEmpty()) atexit(removeHostStorage);
+  else removeHostStorage();
+  hostRoot = dir.data();
+  delete hostFS;
+  hostFS = new fs::FS(hostRoot);
+  storageFS = hostFS;
+  storageAvailable = true;
+  return hostRoot;
+}
+
+// The host disk is never full and usage isn't tracked
+bool hasAvailableSpace(size_t requiredBytes, size_t freedBytes) {
+  return true;
+}
+
+size_t storedFileSize(const String& path) {
+  File file = storageFS ? storageFS->open(path, "r") : File();
+  return file ? file.size() : 0;
+}
+
+void accountFileChange(size_t oldSize, size_t newSize) {}
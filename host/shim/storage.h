@@ -0,0 +1,10 @@
+#ifndef HOST_STORAGE_H
+#define HOST_STORAGE_H
+
+#include "littlefs_manager.h"
+
+// Points storageFS at a fresh temporary directory and returns its host
+// path. Tests share it for as long as the process runs.
+const String& mountHostStorage(const char* name);
+
+#endif //HOST_STORAGE_H
@@ -0,0 +1,239 @@
+// Draws generated BMPs into the 160x80 memory panel and compares every
+// pixel with a reference decode: 1/4/8-bit palettized, 16-bit (555, 565,
+// 565 in a V5 header), 24 and 32-bit, top-down and bottom-up, clipped on
+// each edge. The second draw of each comes from the RGB565 cache and must
+// be a single push.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <TFT_eSPI.h>
+#include <vector>
+#include "config.h"
+#include "storage.h"
+
+bool drawBmp(const char* filename, int16_t x, int16_t y);
+extern TFT_eSPI display;
+
+// Referenced by the status screen, which this test doesn't draw
+bool isAPMode = false;
+String currentSSID = "";
+void publishEvent(const char* type, const String& data) {}
+
+#define BMP_CENTERED INT16_MIN
+#define BACKGROUND 0x1234
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+struct Rgb {
+  uint8_t r, g, b;
+};
+
+static Rgb pixelColor(int x, int y) {
+  return { (uint8_t)(x * 37), (uint8_t)(y * 53), (uint8_t)((x + y) * 11) };
+}
+
+static Rgb paletteColor(int i) {
+  return { (uint8_t)(i * 97 + 13), (uint8_t)(i * 59 + 101), (uint8_t)(i * 31 + 7) };
+}
+
+static int paletteIndex(int x, int y, int depth) {
+  return (x * 3 + y * 5) % (1 << depth);
+}
+
+static uint16_t to565(Rgb c) {
+  return ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+}
+
+enum Layout { PLAIN, BITFIELDS_565, BITFIELDS_555, V5_565 };
+
+struct BmpCase {
+  const char* name;
+  int width;
+  int height;
+  int depth;
+  bool topDown;
+  Layout layout;
+  int16_t x;
+  int16_t y;
+};
+
+static void put16(std::vector<uint8_t>& out, uint16_t v) {
+  out.push_back(v);
+  out.push_back(v >> 8);
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+  put16(out, v);
+  put16(out, v >> 16);
+}
+
+static void writeBmp(const BmpCase& c) {
+  uint32_t rowBytes = ((c.width * c.depth + 31) / 32) * 4;
+  bool bitfields = c.layout != PLAIN;
+  uint32_t infoSize = c.layout == V5_565 ? 124 : 40;
+  uint32_t masksAfterInfo = bitfields && c.layout != V5_565 ? 12 : 0;
+  uint32_t colors = c.depth <= 8 ? 1u << c.depth : 0;
+  uint32_t offset = 14 + infoSize + masksAfterInfo + colors * 4;
+  bool is565 = c.layout == BITFIELDS_565 || c.layout == V5_565;
+
+  std::vector<uint8_t> out;
+  out.push_back('B');
+  out.push_back('M');
+  put32(out, offset + rowBytes * c.height);
+  put32(out, 0);
+  put32(out, offset);
+  put32(out, infoSize);
+  put32(out, c.width);
+  put32(out, c.topDown ? -c.height : c.height);
+  put16(out, 1);
+  put16(out, c.depth);
+  put32(out, bitfields ? 3 : 0);
+  put32(out, rowBytes * c.height);
+  put32(out, 2835);
+  put32(out, 2835);
+  put32(out, colors);
+  put32(out, 0);
+  if (bitfields) {
+    put32(out, is565 ? 0xF800 : 0x7C00);
+    put32(out, is565 ? 0x07E0 : 0x03E0);
+    put32(out, 0x001F);
+  }
+  if (c.layout == V5_565) out.resize(14 + infoSize, 0);
+  for (uint32_t i = 0; i < colors; i++) {
+    Rgb p = paletteColor(i);
+    out.insert(out.end(), { p.b, p.g, p.r, 0 });
+  }
+
+  for (int fileRow = 0; fileRow < c.height; fileRow++) {
+    int y = c.topDown ? fileRow : c.height - 1 - fileRow;
+    size_t start = out.size();
+    if (c.depth <= 8) {
+      uint32_t bits = 0;
+      int count = 0;
+      for (int x = 0; x < c.width; x++) {
+        bits = (bits << c.depth) | paletteIndex(x, y, c.depth);
+        count += c.depth;
+        if (count == 8) {
+          out.push_back(bits);
+          bits = count = 0;
+        }
+      }
+      if (count) out.push_back(bits << (8 - count));
+    } else {
+      for (int x = 0; x < c.width; x++) {
+        Rgb p = pixelColor(x, y);
+        if (c.depth == 16) {
+          put16(out, is565 ? to565(p) : ((p.r >> 3) << 10) | ((p.g >> 3) << 5) | (p.b >> 3));
+        } else {
+          out.insert(out.end(), { p.b, p.g, p.r });
+          if (c.depth == 32) out.push_back(255);
+        }
+      }
+    }
+    out.resize(start + rowBytes, 0);
+  }
+
+  File file = storageFS->open(String("/") + c.name, "w");
+  file.write(out.data(), out.size());
+}
+
+static uint16_t expectedPixel(const BmpCase& c, int x, int y) {
+  if (c.depth <= 8) return to565(paletteColor(paletteIndex(x, y, c.depth)));
+  Rgb p = pixelColor(x, y);
+  if (c.depth == 16 && c.layout != BITFIELDS_565 && c.layout != V5_565) {
+    // 555 widened to 565, the top green bit repeated below
+    uint16_t g = p.g >> 3;
+    return ((p.r >> 3) << 11) | (g << 6) | ((g >> 4) << 5) | (p.b >> 3);
+  }
+  return to565(p);
+}
+
+static int mismatches(const BmpCase& c) {
+  int16_t x0 = c.x == BMP_CENTERED ? (display.width() - c.width) / 2 : c.x;
+  int16_t y0 = c.y == BMP_CENTERED ? (display.height() - c.height) / 2 : c.y;
+  int bad = 0;
+  for (int y = 0; y < display.height(); y++) {
+    for (int x = 0; x < display.width(); x++) {
+      int ix = x - x0, iy = y - y0;
+      bool inside = ix >= 0 && iy >= 0 && ix < c.width && iy < c.height;
+      if (display.readPixel(x, y) != (inside ? expectedPixel(c, ix, iy) : BACKGROUND)) bad++;
+    }
+  }
+  return bad;
+}
+
+// Draws c onto a cleared panel; returns the transfers it took
+static uint32_t draw(const BmpCase& c, const char* pass) {
+  display.fillScreen(BACKGROUND);
+  uint32_t before = display.transfers;
+  bool drawn = drawBmp((String("/") + c.name).c_str(), c.x, c.y);
+  uint32_t pushes = display.transfers - before;
+  int bad = mismatches(c);
+  printf("%-12s %3dx%-3d %2d-bit at %6d,%-6d %-7s pushes=%3u mismatches=%d\n", c.name, c.width, c.height, c.depth,
+         c.x, c.y, pass, pushes, bad);
+  EXPECT(drawn, c.name);
+  EXPECT(bad == 0, c.name);
+  return pushes;
+}
+
+static const BmpCase cases[] = {
+  { "a24.bmp", 100, 40, 24, false, PLAIN, 5, 10 },
+  { "b32.bmp", 57, 33, 32, true, PLAIN, 0, 0 },
+  { "c565.bmp", 61, 20, 16, false, BITFIELDS_565, 3, 3 },
+  { "c555.bmp", 61, 20, 16, false, BITFIELDS_555, 3, 3 },
+  { "c555rgb.bmp", 61, 20, 16, false, PLAIN, 90, 50 },
+  { "d565v5.bmp", 30, 30, 16, true, V5_565, 100, 50 },
+  { "e8.bmp", 77, 50, 8, false, PLAIN, -10, -5 },
+  { "f4.bmp", 33, 21, 4, false, PLAIN, 1, 1 },
+  { "g1.bmp", 45, 19, 1, true, PLAIN, -3, 70 },
+  { "h4big.bmp", 301, 150, 4, false, PLAIN, -71, -35 },
+  { "i24big.bmp", 400, 300, 24, false, PLAIN, -100, -100 },
+  { "j24right.bmp", 50, 20, 24, false, PLAIN, 130, 30 },
+  { "k8logo.bmp", 64, 48, 8, false, PLAIN, BMP_CENTERED, BMP_CENTERED },
+};
+
+int main() {
+  mountHostStorage("bmp");
+  display.setRotation(DISPLAY_ROTATION);
+
+  for (const BmpCase& c : cases) {
+    writeBmp(c);
+    draw(c, "decode");
+    EXPECT(storageFS->exists(String("/") + c.name + ".565"), "cache written");
+    EXPECT(draw(c, "cached") == 1, "cached draw is one push");
+  }
+
+  // A changed source is decoded again and the cache replaced
+  BmpCase changed = { "a24.bmp", 80, 30, 24, true, PLAIN, 5, 10 };
+  writeBmp(changed);
+  EXPECT(draw(changed, "changed") == (uint32_t)changed.height, "changed source decoded");
+  EXPECT(draw(changed, "cached") == 1, "new cache is one push");
+
+  // Drawn somewhere else, the cache for the old position doesn't apply
+  BmpCase moved = changed;
+  moved.x = 20;
+  EXPECT(draw(moved, "moved") == (uint32_t)moved.height, "moved image decoded");
+
+  // RLE is not supported and must leave the panel alone
+  File rle = storageFS->open("/rle.bmp", "w");
+  std::vector<uint8_t> header = { 'B', 'M', 0, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0, 40, 0, 0, 0, 8, 0, 0, 0,
+                                  8, 0, 0, 0, 1, 0, 8, 0, 1, 0, 0, 0 };
+  header.resize(54, 0);
+  rle.write(header.data(), header.size());
+  rle.close();
+  display.fillScreen(BACKGROUND);
+  uint32_t before = display.transfers;
+  EXPECT(!drawBmp("/rle.bmp", 0, 0), "RLE rejected");
+  EXPECT(display.transfers == before, "nothing drawn for RLE");
+
+  printf("%s\n", failures ? "FAILED" : "ALL OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+// Reads a 1 MB script the way the firmware used to (one File::read() per
+// byte) and through BufferedFileReader, and compares file system calls and
+// time. Fails if the buffered paths return different data or still make
+// more than one call per block.
+
+#include <Arduino.h>
+#include <FS.h>
+#include "buffered_file.h"
+#include "storage.h"
+
+static const size_t SCRIPT_BYTES = 1024 * 1024;
+static const char* SCRIPT_PATH = "/script.txt";
+
+struct Result {
+  const char* name;
+  uint32_t calls;
+  unsigned long us;
+  uint32_t checksum;
+  size_t bytes;
+};
+
+static void writeScript() {
+  static const char* lines[] = { "STRING Hello from the benchmark", "ENTER", "DELAY 100", "GUI r",
+                                 "STRING notepad", "ENTER", "REM a comment line that is a bit longer than the others" };
+  File file = storageFS->open(SCRIPT_PATH, "w");
+  BufferedFileWriter out(file);
+  size_t written = 0;
+  for (size_t i = 0; written < SCRIPT_BYTES; i++) {
+    String line = String(lines[i % 7]) + "\n";
+    written += out.print(line);
+  }
+}
+
+static uint32_t mix(uint32_t sum, uint8_t c) {
+  return sum * 31 + c;
+}
+
+template <typename Fn> static Result measure(const char* name, Fn read) {
+  File file = storageFS->open(SCRIPT_PATH, "r");
+  Result r = { name, 0, 0, 0, 0 };
+  fs::File::calls = 0;
+  unsigned long start = micros();
+  read(file, r);
+  r.us = micros() - start;
+  r.calls = fs::File::calls;
+  return r;
+}
+
+int main() {
+  mountHostStorage("buffered-read-bench");
+  writeScript();
+
+  Result results[] = {
+    measure("File::read() per byte", [](File& file, Result& r) {
+      for (int c; (c = file.read()) >= 0; r.bytes++) r.checksum = mix(r.checksum, c);
+    }),
+    measure("BufferedFileReader::read()", [](File& file, Result& r) {
+      BufferedFileReader in(file);
+      for (int c; (c = in.read()) >= 0; r.bytes++) r.checksum = mix(r.checksum, c);
+    }),
+    measure("BufferedFileReader::readLine()", [](File& file, Result& r) {
+      BufferedFileReader in(file);
+      String line;
+      while (in.readLine(line)) {
+        for (unsigned int i = 0; i < line.length(); i++) r.checksum = mix(r.checksum, line[i]);
+        r.checksum = mix(r.checksum, '\n');
+        r.bytes += line.length() + 1;
+      }
+    }),
+    measure("BufferedFileReader::readAll()", [](File& file, Result& r) {
+      BufferedFileReader in(file);
+      String all = in.readAll();
+      for (unsigned int i = 0; i < all.length(); i++) r.checksum = mix(r.checksum, all[i]);
+      r.bytes = all.length();
+    }),
+  };
+
+  printf("%-32s %10s %10s\n", "1 MB script", "fs calls", "ms");
+  for (const Result& r : results) printf("%-32s %10u %10.1f\n", r.name, r.calls, r.us / 1000.0);
+
+  int failures = 0;
+  const uint32_t maxCalls = SCRIPT_BYTES / FILE_BLOCK_SIZE + 4;
+  for (size_t i = 1; i < sizeof(results) / sizeof(results[0]); i++) {
+    const Result& r = results[i];
+    if (r.bytes != results[0].bytes || r.checksum != results[0].checksum) {
+      printf("FAIL %s: read %zu bytes, expected %zu with the same contents\n", r.name, r.bytes, results[0].bytes);
+      failures++;
+    }
+    if (r.calls > maxCalls) {
+      printf("FAIL %s: %u fs calls, expected at most %u\n", r.name, r.calls, maxCalls);
+      failures++;
+    }
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Resumable uploads into the host storage: chunks out of order, a corrupt
+// chunk, a corrupt resend of a chunk already accepted, and finalize
+// refusing while anything is missing. The finished file must be the one
+// that was sent.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <esp_rom_crc.h>
+#include <vector>
+#include "config.h"
+#include "chunked_upload.h"
+#include "storage.h"
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+#define CHUNK CHUNKED_MIN_CHUNK
+#define PART 1436  // What one multipart callback typically carries
+
+// Feeds one chunk the way handleChunkUpload() does; corrupt flips a byte
+// after the CRC was taken. Returns the error, empty on success.
+static String sendChunk(ChunkedUpload* session, const std::vector<uint8_t>& file, uint32_t index,
+                        bool corrupt = false) {
+  size_t offset = index * CHUNK;
+  size_t len = min((size_t)CHUNK, file.size() - offset);
+  std::vector<uint8_t> data(file.begin() + offset, file.begin() + offset + len);
+  uint32_t crc = esp_rom_crc32_le(0, data.data(), len);
+  if (corrupt) data[len / 2] ^= 0x55;
+
+  String error;
+  if (!beginChunk(session, offset, crc, error)) return error;
+  for (size_t at = 0; at < len; at += PART) {
+    if (!writeChunk(data.data() + at, min((size_t)PART, len - at))) {
+      endChunk(error);
+      return error;
+    }
+  }
+  endChunk(error);
+  return error;
+}
+
+static std::vector<uint8_t> readFile(const char* path) {
+  File file = storageFS->open(path, "r");
+  std::vector<uint8_t> data(file ? file.size() : 0);
+  if (file) file.read(data.data(), data.size());
+  return data;
+}
+
+int main() {
+  mountHostStorage("chunked");
+
+  // Four whole chunks and a short last one
+  std::vector<uint8_t> file(CHUNK * 4 + 1000);
+  for (size_t i = 0; i < file.size(); i++) file[i] = (uint8_t)(i * 7 + i / 251);
+  uint32_t fileCrc = esp_rom_crc32_le(0, file.data(), file.size());
+
+  String error;
+  ChunkedUpload* session = openChunkedUpload("/upload.bin", file.size(), CHUNK, error);
+  EXPECT(session && session->chunks == 5, "session opened");
+  if (!session) return 1;
+
+  EXPECT(sendChunk(session, file, 4) == "", "last chunk first");
+  EXPECT(sendChunk(session, file, 0) == "", "first chunk");
+  EXPECT(sendChunk(session, file, 2) == "", "middle chunk");
+  EXPECT(session->received == 3, "three chunks received");
+
+  // A new chunk that arrives corrupt stays missing
+  EXPECT(sendChunk(session, file, 1, true) == "CRC mismatch", "corrupt chunk rejected");
+  EXPECT(session->received == 3, "corrupt chunk not counted");
+
+  // A corrupt resend overwrites the accepted data, so the chunk is
+  // missing again rather than marked over bad bytes
+  EXPECT(sendChunk(session, file, 2, true) == "CRC mismatch", "corrupt resend rejected");
+  EXPECT(session->received == 2, "overwritten chunk counted as missing");
+  String status = chunkedUploadStatusJson(session);
+  printf("%s\n", status.c_str());
+  EXPECT(status.indexOf("\"missing\":[[4096,16384]]") > 0, "chunks 1 to 3 reported missing");
+
+  EXPECT(!finalizeChunkedUpload(session, fileCrc, error) && error == "Missing chunks", "finalize waits");
+  EXPECT(findChunkedUpload(session->id) == session, "session kept after a refused finalize");
+
+  // Chunk too large for its slot is refused
+  String tooLarge;
+  beginChunk(session, 4 * CHUNK, 0, tooLarge);
+  std::vector<uint8_t> big(CHUNK, 0);
+  EXPECT(!writeChunk(big.data(), big.size()), "chunk past the end refused");
+  endChunk(tooLarge);
+  EXPECT(tooLarge == "Chunk too large", "too large reported");
+  EXPECT(sendChunk(session, file, 4) == "", "last chunk again");
+
+  EXPECT(sendChunk(session, file, 1) == "", "chunk 1 resent");
+  EXPECT(sendChunk(session, file, 2) == "", "chunk 2 resent");
+  EXPECT(sendChunk(session, file, 3) == "", "chunk 3");
+  EXPECT(session->received == session->chunks, "all chunks received");
+  EXPECT(finalizeChunkedUpload(session, fileCrc, error), "finalize");
+  EXPECT(readFile("/upload.bin") == file, "file is what was sent");
+  EXPECT(!storageFS->exists("/upload.bin.part") && !storageFS->exists("/upload.bin.part.map"),
+         "temp files removed");
+
+  printf("%s\n", failures ? "FAILED" : "ALL OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+// LZSS round trips and ratios for the bundled quick action/script lists
+// and a long generated script, and the header checks that keep plain
+// files which happen to start with the magic from being decoded.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include "compressed_file.h"
+#include "storage.h"
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static String readHostFile(const String& path) {
+  String content;
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return content;
+  char buf[512];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) content.concat(buf, n);
+  fclose(f);
+  return content;
+}
+
+static void writeRaw(const String& path, const std::vector<uint8_t>& data) {
+  File file = storageFS->open(path, "w");
+  file.write(data.data(), data.size());
+}
+
+static String readBack(const String& path, bool* compressed = nullptr) {
+  File file = storageFS->open(path, "r");
+  CompressedFileReader reader(file);
+  if (compressed) *compressed = reader.compressed();
+  return reader.readAll();
+}
+
+static String readLines(const String& path) {
+  File file = storageFS->open(path, "r");
+  CompressedFileReader reader(file);
+  String out, line;
+  while (reader.readLine(line)) out += line + "\n";
+  return out;
+}
+
+// Ratio and speed of one input; the stored file must read back the same,
+// whole and a line at a time
+static void roundTrip(const char* name, const String& text) {
+  const uint8_t* data = (const uint8_t*)text.c_str();
+  const int rounds = text.length() < 4096 ? 200 : 20;
+
+  std::vector<uint8_t> packed;
+  unsigned long start = micros();
+  for (int i = 0; i < rounds; i++) {
+    packed.clear();
+    lzssCompress(data, text.length(), packed);
+  }
+  double compressUs = (micros() - start) / (double)rounds;
+
+  writeRaw("/roundtrip.lzs", packed);
+  String decoded;
+  start = micros();
+  for (int i = 0; i < rounds; i++) decoded = readBack("/roundtrip.lzs");
+  double decodeUs = (micros() - start) / (double)rounds;
+
+  printf("%-26s %7u -> %6zu (%5.1f%%)  %7.1f MB/s in  %7.1f MB/s out\n", name, text.length(), packed.size(),
+         100.0 * packed.size() / text.length(), text.length() / compressUs, text.length() / decodeUs);
+  EXPECT(decoded == text, name);
+
+  size_t stored = writeStoredFile("/stored.lzs", data, text.length(), true);
+  bool compressed = false;
+  EXPECT(readBack("/stored.lzs", &compressed) == text, name);
+  EXPECT(compressed == (stored < text.length()), name);
+  if (text.endsWith("\n")) EXPECT(readLines("/stored.lzs") == text, name);
+
+  // What the download handler looks at before it picks raw or decoded
+  File file = storageFS->open("/stored.lzs", "r");
+  EXPECT(isCompressedStream(file) == compressed && file.position() == 0, name);
+}
+
+// Plain files that start like a stream must come back unchanged
+static void plainLookalikes() {
+  std::vector<String> plain = {
+    "LZS2 is not a header, just text that starts with it\n",
+    "LZS1",
+    std::string("LZS1\xe8\x03\x00\x00" "abc", 11),  // 1000 bytes can't come from 3
+    std::string("LZS2\x05\x00\x00\x00\x05\x00\x00\x00" "zzzz" "abcde", 21),  // Bad checksum
+  };
+  for (const auto& text : plain) {
+    writeRaw("/plain.txt", std::vector<uint8_t>(text.c_str(), text.c_str() + text.length()));
+    bool compressed = true;
+    EXPECT(readBack("/plain.txt", &compressed) == text, "plain file with a magic prefix");
+    EXPECT(!compressed, "plain file with a magic prefix");
+    File file = storageFS->open("/plain.txt", "r");
+    EXPECT(!isCompressedStream(file), "plain file with a magic prefix");
+  }
+
+  // A stream cut short no longer matches its packed size
+  String text = "STRING hello\nENTER\nSTRING hello\nENTER\nSTRING hello\nENTER\n";
+  std::vector<uint8_t> packed;
+  lzssCompress((const uint8_t*)text.c_str(), text.length(), packed);
+  packed.pop_back();
+  writeRaw("/truncated.lzs", packed);
+  bool compressed = true;
+  readBack("/truncated.lzs", &compressed);
+  EXPECT(!compressed, "truncated stream");
+}
+
+// Files written before the header carried a length and checksum
+static void version1Streams() {
+  String text = "DELAY 500\nGUI r\nDELAY 200\nSTRING notepad\nENTER\nDELAY 500\nSTRING notepad\n";
+  std::vector<uint8_t> packed;
+  lzssCompress((const uint8_t*)text.c_str(), text.length(), packed);
+  std::vector<uint8_t> v1(packed.begin(), packed.begin() + 8);
+  memcpy(v1.data(), "LZS1", 4);
+  v1.insert(v1.end(), packed.begin() + 16, packed.end());
+  writeRaw("/v1.lzs", v1);
+
+  bool compressed = false;
+  EXPECT(readBack("/v1.lzs", &compressed) == text, "LZS1 stream");
+  EXPECT(compressed, "LZS1 stream");
+}
+
+int main() {
+  mountHostStorage("compressed-file-test");
+
+  const char* lists[] = { "quickactions_Linux.txt", "quickactions_MacOS.txt", "quickactions_Windows.txt",
+                          "quickscripts_Linux.txt", "quickscripts_MacOS.txt", "quickscripts_Windows.txt" };
+  String all;
+  for (const char* name : lists) {
+    String text = readHostFile(String(FIRMWARE_DATA_DIR) + "/" + name);
+    EXPECT(text.length() > 0, name);
+    roundTrip(name, text);
+    all += text;
+  }
+  roundTrip("all six concatenated", all);
+
+  static const char* lines[] = { "REM open a terminal", "GUI r", "DELAY 300", "STRING cmd", "ENTER",
+                                 "DELAY 500", "STRING echo step ", "ENTER" };
+  String script;
+  for (int i = 0; i < 5000; i++) {
+    script += lines[i % 8];
+    if (i % 8 == 6) script += String(i);
+    script += "\n";
+  }
+  roundTrip("5000-line generated script", script);
+
+  plainLookalikes();
+  version1Streams();
+
+  return failures ? 1 : 0;
+}
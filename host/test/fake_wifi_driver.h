@@ -0,0 +1,156 @@
+#ifndef HOST_FAKE_WIFI_DRIVER_H
+#define HOST_FAKE_WIFI_DRIVER_H
+
+// A radio for WiFiConnector tests: access points with a channel, signal
+// and password, and a router handing out addresses. Joins and scans take
+// about as long as on the air; time only moves when the test advances it.
+
+#include <Arduino.h>
+#include <vector>
+#include "wifi_connect.h"
+
+struct FakeAccessPoint {
+  String ssid;
+  String password;
+  uint8_t bssid[6];
+  uint8_t channel;
+  int32_t rssi;
+  bool hidden;
+};
+
+// What a join or scan costs, in ms
+#define FAKE_PINNED_JOIN 150    // Straight to a known channel
+#define FAKE_SEARCH_JOIN 2000   // The radio scans for the SSID itself
+#define FAKE_AUTH 250
+#define FAKE_DHCP 1500
+#define FAKE_NOT_FOUND 1000     // Until the radio gives up on a missing AP
+#define FAKE_BAD_PASSWORD 800
+#define FAKE_SCAN 2200
+
+class FakeWiFiDriver : public WiFiDriver {
+public:
+  std::vector<FakeAccessPoint> aps;
+  uint32_t now = 1000;
+  uint32_t routerAddress = 0x3201A8C0;  // 192.168.1.50, as IPAddress stores it
+
+  // What the connector asked for
+  std::vector<String> joins;  // "ssid@channel", "ssid@any" when not pinned
+  uint32_t scans = 0;
+  uint32_t dhcpRequests = 0;  // Joins and renewals that went through DHCP
+  uint32_t staticJoins = 0;
+
+  void begin(const String& ssid, const String& password, const uint8_t* bssid, uint8_t channel,
+             const WiFiLease* lease) override {
+    if (_scanning) _misuse = true;  // The radio can't scan and join at once
+    joins.push_back(ssid + "@" + (bssid ? String(channel) : String("any")));
+    _joined = -1;
+    _lease = lease ? *lease : WiFiLease{};
+    _static = lease != nullptr;
+    _renewing = false;
+
+    uint32_t search = bssid ? FAKE_PINNED_JOIN : FAKE_SEARCH_JOIN;
+    int found = -1;
+    for (size_t i = 0; i < aps.size() && found < 0; i++) {
+      bool there = aps[i].ssid == ssid && (!bssid || (memcmp(bssid, aps[i].bssid, 6) == 0 && channel == aps[i].channel));
+      if (there) found = i;
+    }
+    if (found < 0) {
+      fail(search + FAKE_NOT_FOUND);
+    } else if (aps[found].password != password) {
+      fail(search + FAKE_BAD_PASSWORD);
+    } else {
+      _joined = found;
+      _outcome = WIFI_LINK_CONNECTED;
+      _readyAt = now + search + FAKE_AUTH + (lease ? 0 : FAKE_DHCP);
+      if (lease) staticJoins++;
+      else dhcpRequests++;
+    }
+  }
+
+  WiFiLink status() override {
+    if (now < _readyAt) return WIFI_LINK_CONNECTING;
+    return _outcome;
+  }
+
+  void disconnect() override {
+    _joined = -1;
+    _outcome = WIFI_LINK_FAILED;
+    _readyAt = 0;
+  }
+
+  bool startScan() override {
+    if (_scanning || _joined >= 0) _misuse = true;
+    scans++;
+    _scanning = true;
+    _scanDoneAt = now + FAKE_SCAN;
+    return true;
+  }
+
+  // Reports the access points as they are when the scan finishes
+  int scanResults(std::vector<WiFiScanResult>& results) override {
+    if (!_scanning || now < _scanDoneAt) return WIFI_SCAN_PENDING;
+    _scanning = false;
+    int n = 0;
+    for (const FakeAccessPoint& ap : aps) {
+      if (ap.hidden) continue;
+      WiFiScanResult found;
+      found.ssid = ap.ssid;
+      found.rssi = ap.rssi;
+      memcpy(found.bssid, ap.bssid, 6);
+      found.channel = ap.channel;
+      found.encryption = 3;
+      results.push_back(found);
+      n++;
+    }
+    return n;
+  }
+
+  void current(WiFiFastConnect& fast) override {
+    if (_joined < 0) return;
+    memcpy(fast.bssid, aps[_joined].bssid, 6);
+    fast.channel = aps[_joined].channel;
+    if (_renewing && now < _renewedAt) return;  // No address while DHCP runs
+    fast.lease = _static && !_renewing ? _lease : WiFiLease{ routerAddress, 0x0101A8C0, 0x00FFFFFF, 0x0101A8C0 };
+  }
+
+  void renewLease() override {
+    if (!_static || _renewing) _misuse = true;
+    dhcpRequests++;
+    _renewing = true;
+    _renewedAt = now + FAKE_DHCP;
+  }
+
+  uint32_t millis() override { return now; }
+
+  // The access point went away or kicked the station off
+  void dropLink() { disconnect(); }
+  // The device rebooted: no link, no scan, nothing pending
+  void reboot() {
+    disconnect();
+    _scanning = false;
+    _renewing = false;
+  }
+  // A call the real radio would not take: a join during a scan, a scan
+  // during a join, a renewal without a static lease
+  bool misused() const { return _misuse; }
+  bool renewing() const { return _renewing && now < _renewedAt; }
+
+private:
+  void fail(uint32_t after) {
+    _outcome = WIFI_LINK_FAILED;
+    _readyAt = now + after;
+  }
+
+  int _joined = -1;
+  WiFiLink _outcome = WIFI_LINK_FAILED;
+  uint32_t _readyAt = 0;
+  WiFiLease _lease = {};
+  bool _static = false;
+  bool _renewing = false;
+  uint32_t _renewedAt = 0;
+  bool _scanning = false;
+  uint32_t _scanDoneAt = 0;
+  bool _misuse = false;
+};
+
+#endif //HOST_FAKE_WIFI_DRIVER_H
@@ -0,0 +1,55 @@
+#ifndef HOST_GOLDEN_H
+#define HOST_GOLDEN_H
+
+// Golden images for the status screens. A frame is encoded with the
+// firmware's own PNG writer and compared byte for byte with
+// host/test/golden/<name>. With HOST_UPDATE_GOLDEN=1 in the environment
+// the file is rewritten instead; on a mismatch the new image is left in
+// the working directory for a look.
+
+#include <Arduino.h>
+#include <vector>
+#include "png_writer.h"
+
+static bool collectPng(const uint8_t* data, size_t len, void* ctx) {
+  std::vector<uint8_t>* png = (std::vector<uint8_t>*)ctx;
+  png->insert(png->end(), data, data + len);
+  return true;
+}
+
+// frame is RGB565 in panel (big-endian) byte order
+static bool matchesGolden(const char* name, const uint16_t* frame, uint16_t width, uint16_t height) {
+  std::vector<uint8_t> png;
+  if (!writeRgb565Png(frame, width, height, true, collectPng, &png)) return false;
+
+  String path = String(GOLDEN_DIR) + "/" + name;
+  const char* update = getenv("HOST_UPDATE_GOLDEN");
+  if (update && strcmp(update, "1") == 0) {
+    FILE* out = fopen(path.c_str(), "wb");
+    bool written = out && fwrite(png.data(), 1, png.size(), out) == png.size();
+    if (out) fclose(out);
+    printf("updated %s\n", path.c_str());
+    return written;
+  }
+
+  std::vector<uint8_t> golden;
+  FILE* in = fopen(path.c_str(), "rb");
+  if (in) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) golden.insert(golden.end(), buf, buf + n);
+    fclose(in);
+  }
+  if (golden == png) return true;
+
+  FILE* out = fopen(name, "wb");
+  if (out) {
+    fwrite(png.data(), 1, png.size(), out);
+    fclose(out);
+  }
+  printf("%s differs from %s (%zu vs %zu bytes), new image written to ./%s\n", name, path.c_str(), png.size(),
+         golden.size(), name);
+  return false;
+}
+
+#endif //HOST_GOLDEN_H
@@ -0,0 +1,114 @@
+// The NodeMCU status screen on an emulated SSD1306. After every update
+// the panel's memory, as written over the fake Wire, must equal the frame
+// buffer, the bytes on the wire must be what the column diff is expected
+// to cost, and the key screens must match their golden PNGs.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <ESP8266WiFi.h>
+#include <Adafruit_SSD1306.h>
+#include "display_manager.h"
+#include "config.h"
+#include "golden.h"
+
+extern Adafruit_SSD1306 display;
+
+bool isAPMode = false;
+String currentSSID = "HomeNet";
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static bool panelMatches() {
+  return memcmp(Wire.ram, display.getBuffer(), sizeof(Wire.ram)) == 0;
+}
+
+// The panel's memory as an image, lit pixels white
+static bool panelMatchesGolden(const char* name) {
+  static uint16_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+      frame[y * SCREEN_WIDTH + x] = (Wire.ram[y / 8][x] >> (y & 7)) & 1 ? 0xFFFF : 0x0000;
+    }
+  }
+  return matchesGolden(name, frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+// Lets the batching window pass, sends what is pending and checks the
+// bytes it took; golden names the image the panel must then show
+static uint32_t step(const char* what, uint32_t expected, const char* golden = nullptr,
+                     unsigned long wait = DISPLAY_UPDATE_MS) {
+  uint32_t transactions = Wire.transactions, bytes = Wire.bytes;
+  delay(wait);
+  handleDisplay();
+  bool same = panelMatches();
+  printf("%-32s transactions=%3u bytes=%5u panel %s\n", what, Wire.transactions - transactions, Wire.bytes - bytes,
+         same ? "matches" : "DIFFERS");
+  EXPECT(same, what);
+  EXPECT(Wire.bytes - bytes == expected, what);
+  if (golden) EXPECT(panelMatchesGolden(golden), golden);
+  return Wire.bytes - bytes;
+}
+
+int main() {
+  WiFi.hostStatus = WL_CONNECTED;
+  WiFi.hostIP = IPAddress(192, 168, 1, 50);
+
+  setupDisplay();
+  EXPECT(displayAvailable, "display found at 0x3C");
+  EXPECT(panelMatches(), "logo sent");
+
+  // What the library's display() costs for any change
+  uint32_t before = Wire.bytes;
+  display.display();
+  uint32_t fullFrame = Wire.bytes - before;
+  printf("%-32s bytes=%5u\n", "full display()", fullFrame);
+
+  updateDisplayStatus();
+  uint32_t first = step("first status after logo", 797, "status_oled.png");
+  EXPECT(first < fullFrame, "first status cheaper than a full frame");
+
+  displayAction("Typed: hello");
+  uint32_t action = step("new action", 87, "status_oled_action.png");
+  displayAction("Typed: hellp");
+  uint32_t oneChar = step("one changed character", 15);
+  EXPECT(oneChar < action, "one character costs less than the action line");
+  displayAction("K");
+  step("shorter action", 82);
+
+  step("action expiry", 20, "status_oled.png", 3000);
+  step("nothing changed", 0);
+
+  currentSSID = "Other network name";
+  updateDisplayStatus();
+  step("ssid changed", 372);
+
+  // Updates within DISPLAY_UPDATE_MS of the last one wait for the window
+  displayAction("Waiting");
+  step("inside the batching window", 0, nullptr, 0);
+  step("window passed", 56);
+
+  for (int i = 0; i < 50; i++) displayAction("Burst " + String(i));
+  step("50 actions batched", 57);
+
+  isAPMode = true;
+  updateDisplayStatus();
+  step("switched to AP mode", 288, "status_oled_ap.png");
+
+  // A handler about to restart can't wait for loop()
+  displayAction("WiFi saved");
+  before = Wire.bytes;
+  flushDisplayNow();
+  EXPECT(Wire.bytes > before && panelMatches(), "flushed without waiting for the window");
+  step("nothing left after a flush", 0);
+
+  printf("%s\n", failures ? "FAILED" : "ALL OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+// The ESP32-S3 status screen as the firmware draws it: the sprite
+// compositor and its DMA panel over the 160x80 memory panel. After each
+// update the bytes the compositor reports must be what reached the
+// panel, the screenshot copy must be what the panel shows, and the key
+// screens must match their golden PNGs.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <WiFi.h>
+#include "config.h"
+#include "display_manager.h"
+#include "display_compositor.h"
+#include "storage.h"
+#include "golden.h"
+
+extern TFT_eSPI display;
+
+bool isAPMode = false;
+String currentSSID = "HomeNet";
+void publishEvent(const char* type, const String& data) {}
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+// Status screen rows, as laid out by display_manager.cpp
+#define ADDRESS_Y 18
+#define NETWORK_Y 28
+#define ACTION_Y 62     // Separator
+#define ACTION_TEXT_Y 66
+#define TEXT_HEIGHT 8
+
+// One DMA transfer of full-width rows [top, bottom)
+static uint32_t rowBytes(int16_t top, int16_t bottom) {
+  return SPI_WINDOW_BYTES + (uint32_t)(bottom - top) * display.width() * 2;
+}
+
+static uint64_t panelMark = 0;
+static uint32_t updatesMark = 0;
+
+// Checks the update the last request drew
+static void check(const char* what, uint32_t expected, const char* golden = nullptr) {
+  const DisplayStats& stats = getDisplayStats();
+  uint64_t panel = display.bytes - panelMark;
+  printf("%-28s bytes=%5u panel=%5llu\n", what, stats.lastBytes, (unsigned long long)panel);
+  EXPECT(stats.updates == updatesMark + 1, what);
+  EXPECT(stats.lastBytes == expected, what);
+  EXPECT(panel == stats.lastBytes, "reported bytes are what reached the panel");
+  panelMark = display.bytes;
+  updatesMark = stats.updates;
+
+  uint16_t* frame = captureDisplayFrame();
+  EXPECT(frame != nullptr, "frame captured");
+  if (!frame) return;
+  int differ = 0;
+  for (int y = 0; y < display.height(); y++) {
+    for (int x = 0; x < display.width(); x++) {
+      uint16_t shown = frame[y * display.width() + x];
+      if ((uint16_t)((shown >> 8) | (shown << 8)) != display.readPixel(x, y)) differ++;
+    }
+  }
+  EXPECT(differ == 0, "screenshot is what the panel shows");
+  if (golden) EXPECT(matchesGolden(golden, frame, display.width(), display.height()), golden);
+  free(frame);
+}
+
+int main() {
+  mountHostStorage("screen");
+  WiFi.hostStatus = WL_CONNECTED;
+  WiFi.hostIP = IPAddress(192, 168, 1, 50);
+
+  setupDisplay();
+  const DisplayStats& stats = getDisplayStats();
+  EXPECT(stats.sprite, "sprite compositor with a DMA panel");
+  EXPECT(stats.fullFrameBytes == rowBytes(0, display.height()), "full frame cost");
+  // The boot logo went straight to the panel, not through the frame
+  EXPECT(!canCaptureDisplay() && captureDisplayFrame() == nullptr, "nothing to capture before the first status");
+  panelMark = display.bytes;
+
+  updateDisplayStatus();
+  check("first status", stats.fullFrameBytes, "status_tft.png");
+  updateDisplayStatus();
+  check("nothing changed", 0);
+
+  displayAction("Typed: hello");
+  check("new action", rowBytes(ACTION_Y, ACTION_TEXT_Y + TEXT_HEIGHT), "status_tft_action.png");
+  displayAction("Typed: hellp");
+  check("one changed character", rowBytes(ACTION_TEXT_Y, ACTION_TEXT_Y + TEXT_HEIGHT));
+  displayAction("K");
+  check("shorter action", rowBytes(ACTION_TEXT_Y, ACTION_TEXT_Y + TEXT_HEIGHT));
+
+  delay(DISPLAY_ACTION_MS);
+  updateDisplayStatus();
+  check("action expiry", rowBytes(ACTION_Y, ACTION_TEXT_Y + TEXT_HEIGHT), "status_tft.png");
+
+  currentSSID = "A network name much too long for the screen";
+  updateDisplayStatus();
+  check("long ssid", rowBytes(NETWORK_Y, NETWORK_Y + TEXT_HEIGHT), "status_tft_long_ssid.png");
+
+  isAPMode = true;
+  WiFi.hostStatus = WL_DISCONNECTED;
+  updateDisplayStatus();
+  check("setup AP", rowBytes(ADDRESS_Y, NETWORK_Y + TEXT_HEIGHT), "status_tft_ap.png");
+
+  printf("%s\n", failures ? "FAILED" : "ALL OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,300 @@
+// WiFiConnector against a simulated radio: how a boot finds its network
+// with and without the cached access point, what happens when the access
+// point moved, vanished, hides its SSID or changed its password, how a
+// cached lease is handed back to DHCP after a fast join, and what happens
+// when networks are saved or deleted while the connector is busy.
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "wifi_connect.h"
+#include "fake_wifi_driver.h"
+
+static int failures = 0;
+
+#define EXPECT(cond, what)                        \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s (%s)\n", what, #cond);      \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+// Polls as handleWiFi() would until the connector reaches state, or
+// limit ms have passed; returns the time it took
+static uint32_t runUntil(FakeWiFiDriver& radio, WiFiConnector& connector, WiFiConnectState state,
+                         uint32_t limit = 120000) {
+  uint32_t start = radio.now;
+  while (connector.state() != state && radio.now - start < limit) {
+    radio.now += WIFI_POLL_MS;
+    connector.poll();
+  }
+  return radio.now - start;
+}
+
+static void report(const char* what, FakeWiFiDriver& radio, WiFiConnector& connector, uint32_t ms) {
+  printf("%-34s net=%2d fast=%d attempts=%u scans=%u dhcp=%u %6u ms  joins:", what, connector.network(),
+         connector.joinedFast(), connector.attempts(), radio.scans, radio.dhcpRequests, ms);
+  for (const String& join : radio.joins) printf(" %s", join.c_str());
+  printf("\n");
+  EXPECT(!radio.misused(), what);
+  radio.joins.clear();
+  radio.scans = radio.dhcpRequests = radio.staticJoins = 0;
+}
+
+// A reboot: a new connector over the saved networks, cache included
+static uint32_t boot(FakeWiFiDriver& radio, std::vector<WiFiNetwork>& networks, WiFiConnectState until,
+                     const char* what) {
+  radio.reboot();
+  WiFiConnector connector(radio, networks);
+  connector.start();
+  uint32_t ms = runUntil(radio, connector, until);
+  report(what, radio, connector, ms);
+  return ms;
+}
+
+static FakeWiFiDriver homeAndOffice() {
+  FakeWiFiDriver radio;
+  radio.aps = {
+    { "home", "pw", { 0, 0, 0, 0, 0, 1 }, 6, -50, false },
+    { "office", "pw2", { 0, 0, 0, 0, 0, 2 }, 1, -70, false },
+  };
+  return radio;
+}
+
+static void bootScenarios() {
+  FakeWiFiDriver radio = homeAndOffice();
+  std::vector<WiFiNetwork> networks = { { "home", "pw" }, { "office", "pw2" } };
+
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    EXPECT(connector.state() == WIFI_STATE_SCANNING, "cold boot scans right away");
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && !connector.joinedFast(), "cold boot joins the strongest");
+    EXPECT(radio.scans == 1 && radio.dhcpRequests == 1, "cold boot scans and asks DHCP");
+    EXPECT(connector.takeCacheChanged() && networks[0].fast.valid && networks[0].fast.channel == 6,
+           "cold boot caches the access point");
+    EXPECT(networks[0].fast.lease.ip == radio.routerAddress, "cold boot caches the lease");
+    report("cold boot", radio, connector, ms);
+  }
+
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && connector.joinedFast(), "warm boot joins the cached access point");
+    EXPECT(radio.scans == 0 && radio.staticJoins == WIFI_REUSE_LEASE, "warm boot neither scans nor waits");
+    EXPECT(ms < WIFI_FAST_TIMEOUT, "warm boot is quick");
+    report("warm boot", radio, connector, ms);
+  }
+
+  radio.aps[0].channel = 11;
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && !connector.joinedFast(), "moved AP found by the scan");
+    EXPECT(networks[0].fast.channel == 11, "cache follows the new channel");
+    report("AP moved to channel 11", radio, connector, ms);
+  }
+  boot(radio, networks, WIFI_STATE_CONNECTED, "warm boot after the move");
+
+  radio.aps.erase(radio.aps.begin());
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 1 && !networks[0].fast.valid, "cached AP gone, the other network joined");
+    report("cached AP gone", radio, connector, ms);
+  }
+
+  radio.aps[0].hidden = true;
+  networks[1].fast.valid = 0;
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 1 && !connector.joinedFast(), "hidden SSID joined without the scan");
+    report("hidden SSID, nothing cached", radio, connector, ms);
+  }
+
+  radio.aps[0].password = "changed";
+  {
+    radio.reboot();
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_RETRY_WAIT);
+    EXPECT(connector.network() == -1, "bad password joins nothing");
+    EXPECT(!networks[1].fast.valid, "bad password leaves no cache behind");
+    report("password changed on the router", radio, connector, ms);
+
+    // The saved password is fixed while the connector waits to retry
+    networks[1].password = "changed";
+    ms = runUntil(radio, connector, WIFI_STATE_CONNECTED, WIFI_RETRY_MS + 60000);
+    EXPECT(connector.network() == 1, "retry joins with the new password");
+    EXPECT(ms >= WIFI_RETRY_MS, "retry waits WIFI_RETRY_MS");
+    report("retry after WIFI_RETRY_MS", radio, connector, ms);
+
+    radio.dropLink();
+    connector.poll();
+    EXPECT(connector.state() == WIFI_STATE_FAST, "lost link goes to the cached access point");
+    ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.joinedFast(), "lost link rejoined from the cache");
+    report("link lost", radio, connector, ms);
+  }
+}
+
+// A fast join starts on the cached address and hands it to DHCP at once
+static void leaseScenarios() {
+#if WIFI_REUSE_LEASE
+  FakeWiFiDriver radio = homeAndOffice();
+  std::vector<WiFiNetwork> networks = { { "home", "pw" } };
+  boot(radio, networks, WIFI_STATE_CONNECTED, "cold boot");
+
+  radio.reboot();
+  WiFiConnector connector(radio, networks);
+  connector.start();
+  uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+  connector.takeCacheChanged();
+  EXPECT(connector.joinedFast() && radio.staticJoins == 1, "joined on the cached lease");
+  EXPECT(radio.renewing() && radio.dhcpRequests == 1, "DHCP asked right after the fast join");
+  report("fast join renews the lease", radio, connector, ms);
+
+  // The router kept the address: nothing to store
+  radio.now += FAKE_DHCP;
+  connector.poll();
+  EXPECT(!connector.takeCacheChanged(), "same address, cache untouched");
+
+  // The lease ran out while the device was off and the address went to
+  // someone else
+  uint32_t stale = networks[0].fast.lease.ip;
+  radio.routerAddress = 0x3301A8C0;
+  radio.dropLink();
+  connector.poll();
+  ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+  EXPECT(connector.joinedFast() && networks[0].fast.lease.ip == stale, "joined on the stale lease");
+  radio.now += FAKE_DHCP;
+  connector.poll();
+  EXPECT(connector.takeCacheChanged() && networks[0].fast.lease.ip == radio.routerAddress,
+         "cache takes the address DHCP handed out");
+  report("stale lease replaced", radio, connector, ms);
+#endif
+}
+
+// What wifi_manager.cpp does when a network is saved: appended, then
+// wifiNetworksChanged() restarts the connector unless it is connected
+static void addNetwork(std::vector<WiFiNetwork>& networks, WiFiConnector& connector, const char* ssid,
+                       const char* password) {
+  networks.push_back({ ssid, password });
+  if (connector.state() != WIFI_STATE_CONNECTED) connector.start();
+}
+
+// What deleteWiFiNetwork() does: the networks after it move down one
+static void deleteNetwork(std::vector<WiFiNetwork>& networks, WiFiConnector& connector, size_t index) {
+  networks.erase(networks.begin() + index);
+  connector.networkRemoved(index);
+}
+
+static void editScenarios() {
+  {
+    // Saved through the setup AP while the boot scan runs
+    FakeWiFiDriver radio = homeAndOffice();
+    std::vector<WiFiNetwork> networks = { { "cafe", "pw3" } };
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    radio.now += FAKE_SCAN / 2;
+    connector.poll();
+    EXPECT(connector.state() == WIFI_STATE_SCANNING, "scan still running");
+    addNetwork(networks, connector, "office", "pw2");
+    EXPECT(connector.state() == WIFI_STATE_SCANNING, "the scan is kept");
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 1 && radio.scans == 1, "the scan finds the network added during it");
+    EXPECT(networks[1].fast.valid && networks[1].fast.channel == 1, "added network cached");
+    report("network added mid-scan", radio, connector, ms);
+  }
+
+  {
+    // An earlier network deleted while a later one is being joined
+    FakeWiFiDriver radio = homeAndOffice();
+    std::vector<WiFiNetwork> networks = { { "cafe", "pw3" }, { "home", "pw" }, { "office", "pw2" } };
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_JOINING);
+    EXPECT(connector.busy() && radio.joins.size() == 1 && radio.joins[0] == "home@6", "joining home");
+    deleteNetwork(networks, connector, 0);
+    ms += runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && networks[0].ssid == "home", "joined network follows the shift");
+    EXPECT(radio.joins.size() == 1 && radio.scans == 1, "the join in flight carries on");
+    EXPECT(networks[0].fast.valid && networks[0].fast.channel == 6, "home cached under its new index");
+    EXPECT(!networks[1].fast.valid, "nothing cached for office");
+    report("earlier network deleted mid-join", radio, connector, ms);
+  }
+
+  {
+    // The network being joined is the one deleted
+    FakeWiFiDriver radio = homeAndOffice();
+    std::vector<WiFiNetwork> networks = { { "home", "pw" }, { "office", "pw2" } };
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_JOINING);
+    deleteNetwork(networks, connector, 0);
+    ms += runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && networks[0].ssid == "office", "the next network joined");
+    EXPECT(networks[0].fast.valid && networks[0].fast.channel == 1, "office cached with its own access point");
+    report("network deleted mid-join", radio, connector, ms);
+  }
+
+#if WIFI_REUSE_LEASE
+  {
+    // Deleted while DHCP renews the cached lease of a later network
+    FakeWiFiDriver radio = homeAndOffice();
+    std::vector<WiFiNetwork> networks = { { "cafe", "pw3" }, { "home", "pw" }, { "office", "pw2" } };
+    boot(radio, networks, WIFI_STATE_CONNECTED, "cold boot");
+    radio.reboot();
+    radio.routerAddress = 0x3301A8C0;
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(radio.renewing() && connector.network() == 1, "renewing home's lease");
+    deleteNetwork(networks, connector, 0);
+    radio.now += FAKE_DHCP;
+    connector.poll();
+    EXPECT(connector.network() == 0, "connected network follows the shift");
+    EXPECT(networks[0].fast.lease.ip == radio.routerAddress, "home takes the renewed address");
+    EXPECT(!networks[1].fast.valid, "office's cache untouched");
+    report("network deleted during renewal", radio, connector, ms);
+  }
+#endif
+
+  {
+    // The joined network deleted: the link stays until it drops
+    FakeWiFiDriver radio = homeAndOffice();
+    std::vector<WiFiNetwork> networks = { { "home", "pw" }, { "office", "pw2" } };
+    WiFiConnector connector(radio, networks);
+    connector.start();
+    uint32_t ms = runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    deleteNetwork(networks, connector, 0);
+    connector.poll();
+    EXPECT(connector.state() == WIFI_STATE_CONNECTED && connector.network() == -1, "still connected, unsaved");
+    EXPECT(!networks[0].fast.valid, "office's cache untouched");
+    radio.dropLink();
+    connector.poll();
+    ms += runUntil(radio, connector, WIFI_STATE_CONNECTED);
+    EXPECT(connector.network() == 0 && networks[0].ssid == "office", "rejoined to what is left");
+    report("joined network deleted", radio, connector, ms);
+  }
+}
+
+int main() {
+  bootScenarios();
+  leaseScenarios();
+  editScenarios();
+  printf("%s\n", failures ? "FAILED" : "ALL OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+#include "buffered_file.h"
+
+BufferedFileReader::BufferedFileReader(fs::File& file, size_t blockSize)
+  : _file(file), _blockSize(blockSize), _pos(0), _len(0), _filePos(file.position()) {
+  _buffer = (uint8_t*)malloc(blockSize);
+}
+
+BufferedFileReader::~BufferedFileReader() {
+  // Leave the file where the caller thinks it is
+  if (_buffer && _pos < _len) {
+    _file.seek(_filePos + _pos);
+  }
+  free(_buffer);
+}
+
+bool BufferedFileReader::fill() {
+  _filePos += _len;
+  _pos = 0;
+  _len = _file.read(_buffer, _blockSize);
+  return _len > 0;
+}
+
+int BufferedFileReader::read() {
+  if (!_buffer) return _file.read();
+  if (_pos >= _len && !fill()) return -1;
+  return _buffer[_pos++];
+}
+
+size_t BufferedFileReader::readBytes(uint8_t* dst, size_t len) {
+  if (!_buffer) return _file.read(dst, len);
+
+  size_t total = 0;
+  while (total < len) {
+    if (_pos >= _len) {
+      // Nothing buffered and a big request: read straight into the caller's memory
+      if (len - total >= _blockSize) {
+        _filePos += _len;
+        _pos = _len = 0;
+        size_t n = _file.read(dst + total, len - total);
+        _filePos += n;
+        total += n;
+        break;
+      }
+      if (!fill()) break;
+    }
+    size_t n = min(len - total, _len - _pos);
+    memcpy(dst + total, _buffer + _pos, n);
+    _pos += n;
+    total += n;
+  }
+  return total;
+}
+
+bool BufferedFileReader::readLine(String& line) {
+  line = "";
+  int c = read();
+  if (c < 0) return false;
+
+  while (c >= 0 && c != '\n') {
+    // Copy the run up to the next newline in one go
+    size_t start = _buffer ? _pos - 1 : 0;
+    if (_buffer) {
+      size_t end = start;
+      while (end < _len && _buffer[end] != '\n') end++;
+      line.concat((const char*)(_buffer + start), end - start);
+      _pos = end;
+    } else {
+      line += (char)c;
+    }
+    c = read();
+  }
+
+  if (line.endsWith("\r")) line.remove(line.length() - 1);
+  return true;
+}
+
+String BufferedFileReader::readAll() {
+  String content;
+  size_t remaining = _file.size() > position() ? _file.size() - position() : 0;
+  if (remaining == 0 || !content.reserve(remaining)) return content;
+
+  uint8_t chunk[128];
+  size_t n;
+  while ((n = readBytes(chunk, sizeof(chunk))) > 0) {
+    content.concat((const char*)chunk, n);
+  }
+  return content;
+}
+
+bool BufferedFileReader::seek(size_t pos) {
+  // Stay inside the buffer when we can
+  if (_buffer && pos >= _filePos && pos < _filePos + _len) {
+    _pos = pos - _filePos;
+    return true;
+  }
+  _pos = _len = 0;
+  _filePos = pos;
+  return _file.seek(pos);
+}
+
+bool BufferedFileReader::skip(size_t count) {
+  return seek(position() + count);
+}
+
+size_t BufferedFileReader::position() const {
+  return _buffer ? _filePos + _pos : _file.position();
+}
+
+bool BufferedFileReader::available() {
+  if (!_buffer) return _file.available();
+  return _pos < _len || fill();
+}
+
+BufferedFileWriter::BufferedFileWriter(fs::File& file, size_t blockSize)
+  : _file(file), _blockSize(blockSize), _used(0), _failed(false) {
+  _buffer = (uint8_t*)malloc(blockSize);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+  flush();
+  free(_buffer);
+}
+
+bool BufferedFileWriter::flush() {
+  if (!_buffer || _used == 0) return !_failed;
+  if (_file.write(_buffer, _used) != _used) _failed = true;
+  _used = 0;
+  return !_failed;
+}
+
+size_t BufferedFileWriter::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t BufferedFileWriter::write(const uint8_t* data, size_t len) {
+  if (!_buffer) {
+    size_t n = _file.write(data, len);
+    if (n != len) _failed = true;
+    return n;
+  }
+
+  // Too big to be worth copying: flush and write it directly
+  if (len >= _blockSize) {
+    if (!flush()) return 0;
+    size_t n = _file.write(data, len);
+    if (n != len) _failed = true;
+    return n;
+  }
+
+  if (_used + len > _blockSize && !flush()) return 0;
+  memcpy(_buffer + _used, data, len);
+  _used += len;
+  return len;
+}
+
+size_t BufferedFileWriter::print(const String& text) {
+  return write((const uint8_t*)text.c_str(), text.length());
+}
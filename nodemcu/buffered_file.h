@@ -0,0 +1,64 @@
+#ifndef BUFFERED_FILE_H
+#define BUFFERED_FILE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "config.h"
+
+// Block-buffered access to an open fs::File. Every File::read()/write()
+// call goes through the LittleFS stack, so small reads and writes are
+// served from one block-sized buffer instead.
+// If the buffer can't be allocated both classes fall back to direct calls.
+
+class BufferedFileReader {
+public:
+  explicit BufferedFileReader(fs::File& file, size_t blockSize = FILE_BLOCK_SIZE);
+  ~BufferedFileReader();
+
+  // Next byte, or -1 at end of file
+  int read();
+  // Copies up to len bytes; large reads bypass the buffer
+  size_t readBytes(uint8_t* dst, size_t len);
+  // Next line without the trailing "\n" / "\r\n"; false at end of file
+  bool readLine(String& line);
+  // Rest of the file as a String
+  String readAll();
+
+  bool seek(size_t pos);
+  bool skip(size_t count);
+  size_t position() const;
+  bool available();
+
+private:
+  bool fill();
+
+  fs::File& _file;
+  uint8_t* _buffer;
+  size_t _blockSize;
+  size_t _pos;       // Read position inside the buffer
+  size_t _len;       // Valid bytes in the buffer
+  size_t _filePos;   // File offset of _buffer[0]
+};
+
+class BufferedFileWriter {
+public:
+  explicit BufferedFileWriter(fs::File& file, size_t blockSize = FILE_BLOCK_SIZE);
+  // Flushes whatever is still buffered
+  ~BufferedFileWriter();
+
+  size_t write(uint8_t value);
+  size_t write(const uint8_t* data, size_t len);
+  size_t print(const String& text);
+  bool flush();
+  // False once any write to the file came up short
+  bool ok() const { return !_failed; }
+
+private:
+  fs::File& _file;
+  uint8_t* _buffer;
+  size_t _blockSize;
+  size_t _used;
+  bool _failed;
+};
+
+#endif //BUFFERED_FILE_H
@@ -9,6 +9,9 @@
 // LittleFS settings for script storage
 #define MAX_SCRIPT_NAME_LEN 32
 
+// Block size of BufferedFileReader/Writer. Kept small: the ESP8266 has ~40 KB of heap
+#define FILE_BLOCK_SIZE 512
+
 // WiFi AP settings
 #define AP_SSID "USB-HID-Setup"
 #define AP_PASS "HID_M4ster"
@@ -31,6 +34,7 @@
 #define SCREEN_HEIGHT 64
 #define OLED_RESET -1  // Reset pin (or -1 if sharing Arduino reset pin)
 #define SCREEN_ADDRESS 0x3C  // I2C address for 128x64 OLED
+#define DISPLAY_UPDATE_MS 100  // Status changes are batched and sent at most this often
 
 // Standard I2C pins for ESP8266 (recommended)
 // Note: GPIO16 (D0) does NOT support I2C! Use D1/D2 instead
@@ -16,6 +16,27 @@ unsigned long lastActionTime = 0;
 extern bool isAPMode;
 extern String currentSSID;
 
+#define OLED_PAGES (SCREEN_HEIGHT / 8)  // Each page is 8 rows, one byte per column
+
+// Bytes per I2C transaction, the same limit the SSD1306 library uses
+#if defined(BUFFER_LENGTH)
+#define OLED_WIRE_MAX BUFFER_LENGTH
+#else
+#define OLED_WIRE_MAX 32
+#endif
+
+// Unchanged columns cheaper to resend than to skip with a new address
+// window (address, control byte and 6 command bytes)
+#define OLED_SPAN_GAP 8
+
+// What the panel shows now; each frame is diffed against it
+static uint8_t panelShadow[SCREEN_WIDTH * OLED_PAGES];
+static bool shadowValid = false;
+static uint8_t oledAddress = SCREEN_ADDRESS;
+static bool statusPending = false;
+static bool actionShown = false;
+static unsigned long lastFlush = 0;
+
 // Internal function to show startup logo
 void showStartupLogo() {
   display.clearDisplay();
@@ -40,6 +61,8 @@ void showStartupLogo() {
   display.println("Starting...");
 
   display.display();
+  memcpy(panelShadow, display.getBuffer(), sizeof(panelShadow));
+  shadowValid = true;
   delay(1500);
 }
 
@@ -100,6 +123,7 @@ void setupDisplay() {
       // Try alternative address 0x3D
       Serial.println("Trying alternative address 0x3D...");
       if (display.begin(SSD1306_SWITCHCAPVCC, 0x3D)) {
+        oledAddress = 0x3D;
         Serial.println("Display library initialized at 0x3D - showing startup logo...");
 
         displayAvailable = true;
@@ -128,10 +152,65 @@ void setupDisplay() {
   }
 }
 
-// OLED Display Functions
-void updateDisplayStatus() {
-  if (!displayAvailable) return;
+static void sendCommands(const uint8_t* commands, size_t count) {
+  Wire.beginTransmission(oledAddress);
+  Wire.write((uint8_t)0x00);  // Control byte: command stream
+  Wire.write(commands, count);
+  Wire.endTransmission();
+}
+
+// Sends columns [first, last] of one page. The address window is set
+// first, so in horizontal addressing mode the data lands right there.
+static void sendPageSpan(uint8_t page, uint8_t first, uint8_t last, const uint8_t* data) {
+  const uint8_t window[] = { 0x21, first, last, 0x22, page, page };
+  sendCommands(window, sizeof(window));
+
+  size_t remaining = last - first + 1;
+  while (remaining > 0) {
+    size_t count = min(remaining, (size_t)OLED_WIRE_MAX - 1);
+    Wire.beginTransmission(oledAddress);
+    Wire.write((uint8_t)0x40);  // Control byte: data stream
+    Wire.write(data, count);
+    Wire.endTransmission();
+    data += count;
+    remaining -= count;
+  }
+}
 
+// Sends only what changed since the last frame instead of all 1 KB:
+// unchanged pages are skipped and each changed page gets one transfer per
+// run of changed columns. Runs separated by a short gap are merged.
+static void flushDisplay() {
+  const uint8_t* frame = display.getBuffer();
+  Wire.setClock(400000);
+
+  for (uint8_t page = 0; page < OLED_PAGES; page++) {
+    const uint8_t* row = frame + page * SCREEN_WIDTH;
+    uint8_t* shown = panelShadow + page * SCREEN_WIDTH;
+
+    int col = 0;
+    while (col < SCREEN_WIDTH) {
+      if (shadowValid && row[col] == shown[col]) {
+        col++;
+        continue;
+      }
+
+      int first = col;
+      int last = col;
+      for (int next = col + 1; next < SCREEN_WIDTH && next - last <= OLED_SPAN_GAP; next++) {
+        if (!shadowValid || row[next] != shown[next]) last = next;
+      }
+
+      sendPageSpan(page, first, last, row + first);
+      memcpy(shown + first, row + first, last - first + 1);
+      col = last + 1;
+    }
+  }
+  shadowValid = true;
+}
+
+// Draws the status screen into the display buffer
+static void renderStatus() {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
@@ -169,15 +248,39 @@ void updateDisplayStatus() {
   display.println();
 
   // Last action (if any) - now has dedicated space
+  actionShown = false;
   if (lastAction.length() > 0) {
     unsigned long timeSinceAction = millis() - lastActionTime;
     if (timeSinceAction < 3000) { // Show for 3 seconds
       display.print(">");
       display.println(lastAction);
+      actionShown = true;
     }
   }
+}
 
-  display.display();
+// OLED Display Functions
+void updateDisplayStatus() {
+  statusPending = true;
+}
+
+void handleDisplay() {
+  if (!displayAvailable) return;
+
+  // Clear the last action once its 3 seconds are up
+  if (actionShown && millis() - lastActionTime >= 3000) statusPending = true;
+  if (!statusPending || millis() - lastFlush < DISPLAY_UPDATE_MS) return;
+
+  flushDisplayNow();
+}
+
+void flushDisplayNow() {
+  if (!displayAvailable) return;
+
+  statusPending = false;
+  lastFlush = millis();
+  renderStatus();
+  flushDisplay();
 }
 
 void displayAction(String action) {
@@ -3,7 +3,14 @@
 
 #include <Arduino.h>
 
+// Marks the status screen for redraw; handleDisplay() sends it
 void updateDisplayStatus();
+// Call from loop(): sends pending changes, batched to one update per
+// DISPLAY_UPDATE_MS
+void handleDisplay();
+// Draws and sends the status screen right away, for handlers that block or
+// restart before loop() runs again
+void flushDisplayNow();
 void displayAction(String action);
 void setupDisplay();
 
@@ -1,6 +1,7 @@
 #include "littlefs_manager.h"
 #include <LittleFS.h>
 #include "config.h"
+#include "buffered_file.h"
 
 bool littlefsAvailable = false;
 
@@ -81,10 +82,7 @@ String loadScriptFromFile(String name) {
     return "";
   }
 
-  String script = "";
-  while (file.available()) {
-    script += (char)file.read();
-  }
+  String script = BufferedFileReader(file).readAll();
   file.close();
 
   return script;
@@ -142,9 +140,7 @@ bool saveQuickAction(String os, String cmd, String label, String desc, String bt
   if (LittleFS.exists(filename)) {
     File file = LittleFS.open(filename, "r");
     if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
+      content = BufferedFileReader(file).readAll();
       file.close();
     }
   }
@@ -210,10 +206,7 @@ String loadQuickActions(String os) {
     return "";
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   return content;
@@ -237,10 +230,7 @@ bool deleteQuickAction(String os, String cmd) {
     return false;
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   // Remove the action
@@ -324,9 +314,7 @@ bool addCustomOS(String osName) {
   if (LittleFS.exists(filename)) {
     File file = LittleFS.open(filename, "r");
     if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
+      content = BufferedFileReader(file).readAll();
       file.close();
     }
   }
@@ -384,10 +372,7 @@ bool deleteCustomOS(String osName) {
     return false;
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   // Remove the OS
@@ -451,10 +436,7 @@ String loadCustomOSList() {
     return "";
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   return content;
@@ -484,9 +466,7 @@ bool saveQuickScript(String os, String id, String label, String script, String b
   if (LittleFS.exists(filename)) {
     File file = LittleFS.open(filename, "r");
     if (file) {
-      while (file.available()) {
-        content += (char)file.read();
-      }
+      content = BufferedFileReader(file).readAll();
       file.close();
     }
   }
@@ -556,10 +536,7 @@ String loadQuickScripts(String os) {
     return "";
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   return content;
@@ -583,10 +560,7 @@ bool deleteQuickScript(String os, String id) {
     return false;
   }
 
-  String content = "";
-  while (file.available()) {
-    content += (char)file.read();
-  }
+  String content = BufferedFileReader(file).readAll();
   file.close();
 
   // Remove the script
@@ -50,4 +50,7 @@ void setup() {
 
 void loop() {
   handleWebClients();
+
+  // Send batched status screen changes
+  handleDisplay();
 }
\ No newline at end of file
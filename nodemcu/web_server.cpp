@@ -293,6 +293,7 @@ void handleSetWiFi() {
 
     saveWiFiCredentials(ssid, password);
     displayAction("WiFi saved");
+    flushDisplayNow();
 
     String json = "{\"status\":\"ok\",\"message\":\"WiFi credentials saved. Restarting...\"}";
     SERVER_SEND(200, "application/json", json);